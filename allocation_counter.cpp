@@ -0,0 +1,223 @@
+#include "allocation_counter.hpp"
+#include <algorithm>
+#include <atomic>
+
+#if GAME_TEMPLATE_COUNT_ALLOCATIONS
+
+#include <cstdlib>
+#include <new>
+#include <flecs.h>
+
+namespace {
+    // trivially destructible so counting keeps working while a thread shuts down
+    thread_local uint64_t t_allocations = 0;
+    std::atomic<uint64_t> s_total_allocations{ 0 };
+
+    void count_allocation() {
+        t_allocations++;
+        s_total_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void* allocate(size_t p_size) {
+        count_allocation();
+        void* pointer = std::malloc(p_size == 0 ? 1 : p_size);
+        if(pointer == nullptr) {
+            throw std::bad_alloc();
+        }
+        return pointer;
+    }
+
+    void* allocate_aligned(size_t p_size, std::align_val_t p_alignment) {
+        count_allocation();
+        auto alignment = static_cast<size_t>(p_alignment);
+#ifdef _WIN32
+        void* pointer = _aligned_malloc(p_size == 0 ? 1 : p_size, alignment);
+#else
+        // aligned_alloc wants the size to be a multiple of the alignment
+        void* pointer = std::aligned_alloc(alignment, std::max(alignment, (p_size + alignment - 1) & ~(alignment - 1)));
+#endif
+        if(pointer == nullptr) {
+            throw std::bad_alloc();
+        }
+        return pointer;
+    }
+
+    void free_aligned(void* p_pointer) {
+#ifdef _WIN32
+        _aligned_free(p_pointer);
+#else
+        std::free(p_pointer);
+#endif
+    }
+
+    // flecs allocates its own memory through ecs_os_api, the originals are wrapped rather than replaced
+    ecs_os_api_malloc_t s_flecs_malloc = nullptr;
+    ecs_os_api_calloc_t s_flecs_calloc = nullptr;
+    ecs_os_api_realloc_t s_flecs_realloc = nullptr;
+
+    void* counting_flecs_malloc(ecs_size_t p_size) {
+        count_allocation();
+        return s_flecs_malloc(p_size);
+    }
+
+    void* counting_flecs_calloc(ecs_size_t p_size) {
+        count_allocation();
+        return s_flecs_calloc(p_size);
+    }
+
+    void* counting_flecs_realloc(void* p_pointer, ecs_size_t p_size) {
+        count_allocation();
+        return s_flecs_realloc(p_pointer, p_size);
+    }
+
+    // runs before any world exists, ecs_os_set_api is ignored once flecs initialized its OS layer
+    [[maybe_unused]] const bool s_flecs_hooked = []() {
+        ecs_os_set_api_defaults();
+        ecs_os_api_t api = ecs_os_api;
+        s_flecs_malloc = api.malloc_;
+        s_flecs_calloc = api.calloc_;
+        s_flecs_realloc = api.realloc_;
+        api.malloc_ = counting_flecs_malloc;
+        api.calloc_ = counting_flecs_calloc;
+        api.realloc_ = counting_flecs_realloc;
+        ecs_os_set_api(&api);
+        return true;
+    }();
+}
+
+void* operator new(size_t p_size) {
+    return allocate(p_size);
+}
+
+void* operator new[](size_t p_size) {
+    return allocate(p_size);
+}
+
+void* operator new(size_t p_size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(p_size);
+    }
+    catch(const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t p_size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(p_size);
+    }
+    catch(const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new(size_t p_size, std::align_val_t p_alignment) {
+    return allocate_aligned(p_size, p_alignment);
+}
+
+void* operator new[](size_t p_size, std::align_val_t p_alignment) {
+    return allocate_aligned(p_size, p_alignment);
+}
+
+void* operator new(size_t p_size, std::align_val_t p_alignment, const std::nothrow_t&) noexcept {
+    try {
+        return allocate_aligned(p_size, p_alignment);
+    }
+    catch(const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t p_size, std::align_val_t p_alignment, const std::nothrow_t&) noexcept {
+    try {
+        return allocate_aligned(p_size, p_alignment);
+    }
+    catch(const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* p_pointer) noexcept {
+    std::free(p_pointer);
+}
+
+void operator delete[](void* p_pointer) noexcept {
+    std::free(p_pointer);
+}
+
+void operator delete(void* p_pointer, size_t) noexcept {
+    std::free(p_pointer);
+}
+
+void operator delete[](void* p_pointer, size_t) noexcept {
+    std::free(p_pointer);
+}
+
+void operator delete(void* p_pointer, const std::nothrow_t&) noexcept {
+    std::free(p_pointer);
+}
+
+void operator delete[](void* p_pointer, const std::nothrow_t&) noexcept {
+    std::free(p_pointer);
+}
+
+void operator delete(void* p_pointer, std::align_val_t) noexcept {
+    free_aligned(p_pointer);
+}
+
+void operator delete[](void* p_pointer, std::align_val_t) noexcept {
+    free_aligned(p_pointer);
+}
+
+void operator delete(void* p_pointer, size_t, std::align_val_t) noexcept {
+    free_aligned(p_pointer);
+}
+
+void operator delete[](void* p_pointer, size_t, std::align_val_t) noexcept {
+    free_aligned(p_pointer);
+}
+
+void operator delete(void* p_pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+    free_aligned(p_pointer);
+}
+
+void operator delete[](void* p_pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+    free_aligned(p_pointer);
+}
+
+namespace allocation_counter {
+    uint64_t thread_allocations() {
+        return t_allocations;
+    }
+
+    uint64_t total_allocations() {
+        return s_total_allocations.load(std::memory_order_relaxed);
+    }
+}
+
+#else
+
+namespace allocation_counter {
+    uint64_t thread_allocations() {
+        return 0;
+    }
+
+    uint64_t total_allocations() {
+        return 0;
+    }
+}
+
+#endif
+
+namespace allocation_counter {
+    void frame_meter::frame_mark() {
+        uint64_t now = thread_allocations();
+        // the first mark only starts the count, there is no complete frame before it
+        if(m_started) {
+            m_last_frame = now - m_mark;
+            m_peak = std::max(m_peak, m_last_frame);
+        }
+        m_mark = now;
+        m_started = true;
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * @brief Debug count of heap allocations
+ *
+ * With GAME_TEMPLATE_COUNT_ALLOCATIONS the global operator new and flecs'
+ * OS allocation hooks count every call, per thread and for the whole
+ * process. Allocations made through malloc directly (Jolt, miniaudio,
+ * stb) are not seen. Without the flag nothing is replaced and every count
+ * stays 0.
+ */
+namespace allocation_counter {
+    [[nodiscard]] constexpr bool enabled() {
+#if GAME_TEMPLATE_COUNT_ALLOCATIONS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    //! @brief Allocations made by the calling thread since it started
+    [[nodiscard]] uint64_t thread_allocations();
+
+    //! @brief Allocations made by every thread since the process started
+    [[nodiscard]] uint64_t total_allocations();
+
+    /**
+     * @name frame_meter
+     * @brief Turns the calling thread's running count into a per frame count
+     *
+     * Call frame_mark() once per frame from the same thread.
+     */
+    class frame_meter {
+    public:
+        void frame_mark();
+
+        //! @brief Allocations between the last two marks
+        [[nodiscard]] uint64_t last_frame() const { return m_last_frame; }
+
+        [[nodiscard]] uint64_t peak() const { return m_peak; }
+
+    private:
+        uint64_t m_mark=0;
+        uint64_t m_last_frame=0;
+        uint64_t m_peak=0;
+        bool m_started=false;
+    };
+}
@@ -0,0 +1,338 @@
+#include "audio_system.hpp"
+#include "profiler.hpp"
+#include <chrono>
+#include <cstring>
+#include <core/engine_logger.hpp>
+
+const ma_data_source_vtable audio_system::s_voice_vtable = {
+    audio_system::on_voice_read,
+    audio_system::on_voice_seek,
+    audio_system::on_voice_get_data_format,
+    audio_system::on_voice_get_cursor,
+    audio_system::on_voice_get_length,
+    nullptr,
+    0,
+};
+
+audio_system::~audio_system() {
+    shutdown();
+}
+
+bool audio_system::initialize(const audio_settings& p_settings) {
+    if(m_initialized.load(std::memory_order_acquire)) {
+        return true;
+    }
+
+    ma_engine_config config = ma_engine_config_init();
+    if(p_settings.headless) {
+        config.noDevice = MA_TRUE;
+        config.channels = p_settings.channels;
+        config.sampleRate = p_settings.sample_rate;
+    }
+
+    if(ma_engine_init(&config, &m_engine) != MA_SUCCESS) {
+        console_log_error("Could not initialize ma_engine!!!");
+        return false;
+    }
+
+    // streams raise this from the device thread when their ring buffer runs low
+    m_bank.initialize(m_engine, p_settings.max_sounds, [this]() { wake(); });
+
+    uint32_t channels = ma_engine_get_channels(&m_engine);
+    m_voice_count = p_settings.max_voices;
+    m_voices = std::make_unique<voice[]>(m_voice_count);
+    for(uint32_t i = 0; i < m_voice_count; i++) {
+        voice& target = m_voices[i];
+        if(ma_audio_buffer_ref_init(ma_format_f32, channels, nullptr, 0, &target.buffer) != MA_SUCCESS) {
+            continue;
+        }
+
+        ma_data_source_config source_config = ma_data_source_config_init();
+        source_config.vtable = &s_voice_vtable;
+        if(ma_data_source_init(&source_config, &target.reader.base) != MA_SUCCESS) {
+            ma_audio_buffer_ref_uninit(&target.buffer);
+            continue;
+        }
+        target.reader.owner = &target;
+
+        if(ma_sound_init_from_data_source(&m_engine, &target.reader.base, 0, nullptr, &target.sound) != MA_SUCCESS) {
+            ma_data_source_uninit(&target.reader.base);
+            ma_audio_buffer_ref_uninit(&target.buffer);
+            continue;
+        }
+        target.initialized = true;
+    }
+
+    m_worker = std::thread([this]() { worker_loop(); });
+    // published last, a thread that sees it set sees the voices and the worker
+    m_initialized.store(true, std::memory_order_release);
+    return true;
+}
+
+void audio_system::shutdown() {
+    if(!m_initialized.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    // the quit command has to get through, wait for room if the queue is full
+    while(!push({ command_type::quit, invalid_sound, 0.f })) {
+        std::this_thread::yield();
+    }
+    m_worker.join();
+
+    for(uint32_t i = 0; i < m_voice_count; i++) {
+        voice& target = m_voices[i];
+        if(target.initialized) {
+            ma_sound_uninit(&target.sound);
+            ma_data_source_uninit(&target.reader.base);
+            ma_audio_buffer_ref_uninit(&target.buffer);
+            target.initialized = false;
+            target.source = invalid_sound;
+        }
+    }
+
+    // streams own sounds attached to the engine, they go before it
+    m_bank.clear();
+    ma_engine_uninit(&m_engine);
+    m_initialized.store(false, std::memory_order_release);
+}
+
+sound_id audio_system::load(std::string_view p_path, const sound_load_desc& p_desc) {
+    if(!m_initialized.load(std::memory_order_acquire)) {
+        return invalid_sound;
+    }
+    return m_bank.load(p_path, p_desc);
+}
+
+bool audio_system::play(sound_id p_sound, float p_volume) {
+    return push({ command_type::play, p_sound, p_volume });
+}
+
+bool audio_system::stop(sound_id p_sound) {
+    return push({ command_type::stop, p_sound, 0.f });
+}
+
+bool audio_system::stop_all() {
+    return push({ command_type::stop_all, invalid_sound, 0.f });
+}
+
+audio_stats audio_system::stats() const {
+    audio_stats result;
+    result.commands_executed = m_commands_executed.load(std::memory_order_relaxed);
+    result.execute_nanoseconds = m_execute_nanoseconds.load(std::memory_order_relaxed);
+    return result;
+}
+
+uint64_t audio_system::read_frames(float* p_output, uint64_t p_frame_count) {
+    if(!m_initialized.load(std::memory_order_acquire)) {
+        return 0;
+    }
+
+    ma_uint64 frames_read = 0;
+    ma_engine_read_pcm_frames(&m_engine, p_output, p_frame_count, &frames_read);
+    return frames_read;
+}
+
+bool audio_system::push(const command& p_command) {
+    if(!m_initialized.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    if(!m_commands.try_push(p_command)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    wake();
+    return true;
+}
+
+void audio_system::wake() {
+    m_signal.fetch_add(1, std::memory_order_release);
+    m_signal.notify_one();
+}
+
+void audio_system::worker_loop() {
+    PROFILE_THREAD_NAME("audio");
+    using clock = std::chrono::steady_clock;
+    uint32_t observed = 0;
+    while(true) {
+        command next;
+        while(m_commands.try_pop(next)) {
+            if(next.type == command_type::quit) {
+                return;
+            }
+
+            PROFILE_ZONE("audio command");
+            auto start = clock::now();
+            execute(next);
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start);
+            m_execute_nanoseconds.fetch_add(static_cast<uint64_t>(elapsed.count()), std::memory_order_relaxed);
+            m_commands_executed.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        m_bank.for_each_stream([](streamed_sound& p_stream) {
+            if(p_stream.needs_refill()) {
+                p_stream.refill();
+            }
+        });
+
+        // sleeps until a producer or a draining stream bumps the signal past what we last saw
+        m_signal.wait(observed, std::memory_order_acquire);
+        observed = m_signal.load(std::memory_order_acquire);
+    }
+}
+
+void audio_system::execute(const command& p_command) {
+    if(p_command.type == command_type::stop_all) {
+        for(uint32_t i = 0; i < m_voice_count; i++) {
+            if(m_voices[i].initialized) {
+                ma_sound_stop(&m_voices[i].sound);
+            }
+        }
+        m_bank.for_each_stream([](streamed_sound& p_stream) { ma_sound_stop(p_stream.sound()); });
+        return;
+    }
+
+    const sound_bank::entry* source = m_bank.find(p_command.sound);
+    if(source == nullptr) {
+        return;
+    }
+
+    if(p_command.type == command_type::stop) {
+        if(source->streamed) {
+            ma_sound_stop(source->streamed->sound());
+            return;
+        }
+        for(uint32_t i = 0; i < m_voice_count; i++) {
+            if(m_voices[i].initialized and m_voices[i].source == p_command.sound) {
+                ma_sound_stop(&m_voices[i].sound);
+            }
+        }
+        return;
+    }
+
+    if(source->streamed) {
+        // a stream has a single cursor, playing it again restarts it
+        streamed_sound& stream = *source->streamed;
+        ma_sound_stop(stream.sound());
+        stream.rewind();
+        ma_sound_set_volume(stream.sound(), p_command.volume);
+        ma_sound_start(stream.sound());
+        return;
+    }
+
+    play_decoded(p_command.sound, *source->decoded, p_command.volume);
+}
+
+void audio_system::play_decoded(sound_id p_sound, const decoded_sound& p_decoded, float p_volume) {
+    uint32_t instances = 0;
+    for(uint32_t i = 0; i < m_voice_count; i++) {
+        const voice& active = m_voices[i];
+        if(active.initialized and active.source == p_sound and ma_sound_is_playing(&active.sound)) {
+            instances++;
+        }
+    }
+
+    if(instances >= p_decoded.max_instances) {
+        return;
+    }
+
+    voice* target = acquire_voice();
+    if(target == nullptr) {
+        return;
+    }
+
+    // the voice only references the bank's PCM, nothing is copied or decoded here. A stolen or
+    // just stopped voice can still be read by the device thread, so it is fenced off first
+    if(target->source != p_sound) {
+        target->fence.close();
+        ma_audio_buffer_ref_set_data(&target->buffer, p_decoded.pcm.data(), p_decoded.frame_count);
+        target->fence.open();
+        target->source = p_sound;
+    }
+
+    ma_sound_set_volume(&target->sound, p_volume);
+    ma_sound_seek_to_pcm_frame(&target->sound, 0);
+    ma_sound_start(&target->sound);
+    target->started = ++m_play_counter;
+}
+
+audio_system::voice* audio_system::acquire_voice() {
+    voice* oldest = nullptr;
+    for(uint32_t i = 0; i < m_voice_count; i++) {
+        voice& candidate = m_voices[i];
+        if(!candidate.initialized) {
+            continue;
+        }
+        if(!ma_sound_is_playing(&candidate.sound)) {
+            return &candidate;
+        }
+        if(oldest == nullptr or candidate.started < oldest->started) {
+            oldest = &candidate;
+        }
+    }
+
+    // every voice is busy, steal the one that has been playing the longest
+    if(oldest != nullptr) {
+        ma_sound_stop(&oldest->sound);
+    }
+    return oldest;
+}
+
+ma_result audio_system::on_voice_read(ma_data_source* p_source, void* p_frames_out, ma_uint64 p_frame_count, ma_uint64* p_frames_read) {
+    voice& self = *reinterpret_cast<voice_source*>(p_source)->owner;
+    if(!self.fence.try_enter()) {
+        // the worker is repointing the buffer, the sound is stopped so nobody hears this
+        ma_uint32 channels = 0;
+        ma_data_source_get_data_format(&self.buffer, nullptr, &channels, nullptr, nullptr, 0);
+        std::memset(p_frames_out, 0, static_cast<size_t>(p_frame_count) * channels * sizeof(float));
+        if(p_frames_read != nullptr) {
+            *p_frames_read = p_frame_count;
+        }
+        return MA_SUCCESS;
+    }
+
+    ma_result result = ma_data_source_read_pcm_frames(&self.buffer, p_frames_out, p_frame_count, p_frames_read);
+    self.fence.leave();
+    return result;
+}
+
+ma_result audio_system::on_voice_seek(ma_data_source* p_source, ma_uint64 p_frame_index) {
+    voice& self = *reinterpret_cast<voice_source*>(p_source)->owner;
+    if(!self.fence.try_enter()) {
+        return MA_BUSY;
+    }
+    ma_result result = ma_data_source_seek_to_pcm_frame(&self.buffer, p_frame_index);
+    self.fence.leave();
+    return result;
+}
+
+ma_result audio_system::on_voice_get_data_format(ma_data_source* p_source, ma_format* p_format, ma_uint32* p_channels, ma_uint32* p_sample_rate,
+                                                 ma_channel* p_channel_map, size_t p_channel_map_capacity) {
+    // the format is fixed at init, set_data only swaps the frames
+    voice& self = *reinterpret_cast<voice_source*>(p_source)->owner;
+    return ma_data_source_get_data_format(&self.buffer, p_format, p_channels, p_sample_rate, p_channel_map, p_channel_map_capacity);
+}
+
+ma_result audio_system::on_voice_get_cursor(ma_data_source* p_source, ma_uint64* p_cursor) {
+    voice& self = *reinterpret_cast<voice_source*>(p_source)->owner;
+    if(!self.fence.try_enter()) {
+        *p_cursor = 0;
+        return MA_SUCCESS;
+    }
+    ma_result result = ma_data_source_get_cursor_in_pcm_frames(&self.buffer, p_cursor);
+    self.fence.leave();
+    return result;
+}
+
+ma_result audio_system::on_voice_get_length(ma_data_source* p_source, ma_uint64* p_length) {
+    voice& self = *reinterpret_cast<voice_source*>(p_source)->owner;
+    if(!self.fence.try_enter()) {
+        *p_length = 0;
+        return MA_SUCCESS;
+    }
+    ma_result result = ma_data_source_get_length_in_pcm_frames(&self.buffer, p_length);
+    self.fence.leave();
+    return result;
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <miniaudio/miniaudio.h>
+#include "mpsc_queue.hpp"
+#include "sound_bank.hpp"
+
+struct audio_settings {
+    //! voices allocated up front, playing more than this steals the oldest voice
+    uint32_t max_voices = 32;
+    //! sound sources that can be loaded over the lifetime of the system
+    uint32_t max_sounds = 128;
+    //! runs the engine without a device, output is pulled through read_frames()
+    bool headless = false;
+    //! output format used when headless, otherwise the device decides
+    uint32_t channels = 2;
+    uint32_t sample_rate = 48000;
+};
+
+struct audio_stats {
+    uint64_t commands_executed=0;
+    //! time the worker spent executing commands, not waiting for them
+    uint64_t execute_nanoseconds=0;
+};
+
+/**
+ * @name audio_system
+ * @brief Owns the ma_engine and plays sounds from a single audio worker
+ *
+ * Sounds are loaded once through load() into a sound_bank. After that play()
+ * and stop() only push a small command into a lock-free queue, they never
+ * allocate, lock or create threads so they are safe to call from physics
+ * callbacks. The worker thread drains the queue, points a preallocated voice
+ * at the shared PCM of the sound and keeps streamed tracks topped up.
+ */
+class audio_system {
+public:
+    audio_system() = default;
+    ~audio_system();
+
+    audio_system(const audio_system&) = delete;
+    audio_system& operator=(const audio_system&) = delete;
+
+    bool initialize(const audio_settings& p_settings = {});
+
+    void shutdown();
+
+    /**
+     * @brief Decodes (or opens a stream for) a sound file, must be called
+     * before the sound is played
+     *
+     * @return make_sound_id(p_path) on success, invalid_sound otherwise
+     */
+    sound_id load(std::string_view p_path, const sound_load_desc& p_desc = {});
+
+    bool play(sound_id p_sound, float p_volume = 1.f);
+
+    bool stop(sound_id p_sound);
+
+    bool stop_all();
+
+    [[nodiscard]] bool is_initialized() const { return m_initialized.load(std::memory_order_acquire); }
+
+    //! @brief Commands dropped because the queue was full
+    [[nodiscard]] uint32_t dropped_commands() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    [[nodiscard]] audio_stats stats() const;
+
+    /**
+     * @brief Mixes p_frame_count frames into p_output, only valid for headless
+     * systems where no device pulls the audio
+     */
+    uint64_t read_frames(float* p_output, uint64_t p_frame_count);
+
+private:
+    enum class command_type : uint8_t { play, stop, stop_all, quit };
+
+    struct command {
+        command_type type;
+        sound_id sound;
+        float volume;
+    };
+
+    struct voice;
+
+    // miniaudio hands the callbacks a pointer to base, which has to be the first member
+    struct voice_source {
+        ma_data_source_base base;
+        voice* owner;
+    };
+
+    /**
+     * Reads straight from a decoded_sound's PCM, switching sounds never
+     * allocates. The sound plays through reader, which forwards to buffer
+     * behind a fence so buffer can be repointed while the device thread runs.
+     */
+    struct voice {
+        voice_source reader;
+        ma_audio_buffer_ref buffer;
+        ma_sound sound;
+        device_read_fence fence;
+        sound_id source=invalid_sound;
+        uint64_t started=0;
+        bool initialized=false;
+    };
+
+    static ma_result on_voice_read(ma_data_source* p_source, void* p_frames_out, ma_uint64 p_frame_count, ma_uint64* p_frames_read);
+    static ma_result on_voice_seek(ma_data_source* p_source, ma_uint64 p_frame_index);
+    static ma_result on_voice_get_data_format(ma_data_source* p_source, ma_format* p_format, ma_uint32* p_channels, ma_uint32* p_sample_rate,
+                                              ma_channel* p_channel_map, size_t p_channel_map_capacity);
+    static ma_result on_voice_get_cursor(ma_data_source* p_source, ma_uint64* p_cursor);
+    static ma_result on_voice_get_length(ma_data_source* p_source, ma_uint64* p_length);
+
+    static const ma_data_source_vtable s_voice_vtable;
+
+    bool push(const command& p_command);
+    void wake();
+    void worker_loop();
+    void execute(const command& p_command);
+    void play_decoded(sound_id p_sound, const decoded_sound& p_decoded, float p_volume);
+    voice* acquire_voice();
+
+private:
+    //! written by initialize() and shutdown(), which may run on a pool thread, read from any thread
+    std::atomic<bool> m_initialized{ false };
+    ma_engine m_engine;
+
+    // loaded on the main thread, looked up by the worker
+    sound_bank m_bank;
+
+    // owned by the worker thread
+    std::unique_ptr<voice[]> m_voices;
+    uint32_t m_voice_count=0;
+    uint64_t m_play_counter=0;
+
+    mpsc_queue<command, 256> m_commands;
+    std::atomic<uint32_t> m_signal{ 0 };
+    std::atomic<uint32_t> m_dropped{ 0 };
+    std::atomic<uint64_t> m_commands_executed{ 0 };
+    std::atomic<uint64_t> m_execute_nanoseconds{ 0 };
+    std::thread m_worker;
+};
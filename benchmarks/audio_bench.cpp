@@ -0,0 +1,149 @@
+#include "benchmark.hpp"
+#include <audio_system.hpp>
+#include <algorithm>
+#include <array>
+#include <vector>
+
+/**
+ * Runs the audio system headless (no device, miniaudio mixes on demand) and
+ * measures how long a trigger takes to become audible in the mixed output
+ * next to the cost of decoding the effect on every trigger. Run from the
+ * repository root so the Resources directory is found.
+ */
+
+namespace {
+    constexpr const char* effect_path = "Resources/rolling_ball_on_wood.mp3";
+    constexpr const char* track_path = "Resources/BabyElephantWalk60.wav";
+    constexpr uint64_t block_frames = 64;
+    // gives up after a second of silence at 48kHz
+    constexpr uint64_t max_wait_frames = 48'000;
+
+    //! pulls blocks until something non-silent comes out, returns the frames mixed
+    uint64_t mix_until_audible(audio_system& p_audio, std::vector<float>& p_block) {
+        uint64_t mixed = 0;
+        while(mixed < max_wait_frames) {
+            uint64_t frames = p_audio.read_frames(p_block.data(), block_frames);
+            mixed += frames;
+            if(std::any_of(p_block.begin(), p_block.end(), [](float p_sample) { return p_sample != 0.f; })) {
+                break;
+            }
+        }
+        return mixed;
+    }
+
+    void mix_until_silent(audio_system& p_audio, std::vector<float>& p_block) {
+        for(uint64_t mixed = 0; mixed < max_wait_frames; mixed += block_frames) {
+            p_audio.read_frames(p_block.data(), block_frames);
+            if(std::all_of(p_block.begin(), p_block.end(), [](float p_sample) { return p_sample == 0.f; })) {
+                break;
+            }
+        }
+    }
+
+    double worker_microseconds_per_command(const audio_stats& p_before, const audio_stats& p_after) {
+        uint64_t commands = p_after.commands_executed - p_before.commands_executed;
+        if(commands == 0) {
+            return 0.0;
+        }
+        return static_cast<double>(p_after.execute_nanoseconds - p_before.execute_nanoseconds) / static_cast<double>(commands) / 1000.0;
+    }
+
+    audio_settings headless_settings() {
+        audio_settings settings;
+        settings.headless = true;
+        return settings;
+    }
+
+    bench::registrar s_decode_per_trigger("audio/decode_per_trigger", [](bench::state& p_state) {
+        // what the old per-file ma_decoder path paid every time a sound fired
+        std::array<float, 4096 * 2> scratch;
+        p_state.measure([&]() {
+            ma_decoder decoder;
+            ma_decoder_config config = ma_decoder_config_init(ma_format_f32, 2, 48000);
+            if(ma_decoder_init_file(effect_path, &config, &decoder) != MA_SUCCESS) {
+                return;
+            }
+            ma_uint64 decoded = 0;
+            do {
+                ma_decoder_read_pcm_frames(&decoder, scratch.data(), scratch.size() / 2, &decoded);
+            } while(decoded != 0);
+            ma_decoder_uninit(&decoder);
+            bench::do_not_optimize(scratch[0]);
+        });
+    });
+
+    bench::registrar s_trigger_latency("audio/trigger_latency", [](bench::state& p_state) {
+        audio_system audio;
+        if(!audio.initialize(headless_settings())) {
+            return;
+        }
+
+        sound_id effect = audio.load(effect_path, { .mode = sound_load_desc::load_mode::decoded });
+        if(effect == invalid_sound) {
+            return;
+        }
+
+        std::vector<float> block(block_frames * 2);
+        audio_stats before = audio.stats();
+        p_state.measure(
+          [&]() {
+              audio.stop(effect);
+              mix_until_silent(audio, block);
+          },
+          [&]() {
+              audio.play(effect);
+              bench::do_not_optimize(mix_until_audible(audio, block));
+          });
+        p_state.set_counter("worker_us_per_command", worker_microseconds_per_command(before, audio.stats()));
+    }, 50);
+
+    bench::registrar s_play_burst("audio/play_burst_200", [](bench::state& p_state) {
+        // producer side cost of a physics step firing many contact sounds
+        audio_system audio;
+        if(!audio.initialize(headless_settings())) {
+            return;
+        }
+
+        sound_id effect = audio.load(effect_path, { .mode = sound_load_desc::load_mode::decoded, .max_instances = 8 });
+        if(effect == invalid_sound) {
+            return;
+        }
+
+        std::vector<float> block(block_frames * 2);
+        audio_stats before = audio.stats();
+        p_state.measure(
+                        [&]() {
+                            audio.stop(effect);
+                            mix_until_silent(audio, block);
+                        },
+                        [&]() {
+                            for(uint32_t i = 0; i < 200; i++) {
+                                audio.play(effect);
+                            }
+                        });
+        p_state.set_counter("worker_us_per_command", worker_microseconds_per_command(before, audio.stats()));
+    });
+
+    bench::registrar s_stream_start("audio/stream_start", [](bench::state& p_state) {
+        audio_system audio;
+        if(!audio.initialize(headless_settings())) {
+            return;
+        }
+
+        sound_id track = audio.load(track_path, { .mode = sound_load_desc::load_mode::streamed });
+        if(track == invalid_sound) {
+            return;
+        }
+
+        std::vector<float> block(block_frames * 2);
+        p_state.measure(
+          [&]() {
+              audio.stop(track);
+              mix_until_silent(audio, block);
+          },
+          [&]() {
+              audio.play(track);
+              bench::do_not_optimize(mix_until_audible(audio, block));
+          });
+    });
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Minimal harness used by the game-template-benchmarks executable
+ *
+ * Each benchmark case registers itself through a static bench::registrar and
+ * receives a bench::state, which times the body of the case for a fixed
+ * number of iterations. Setup work passed to state::measure is not timed.
+ * A case that checks its own results reports a wrong one with state::fail,
+ * which makes the executable exit nonzero.
+ */
+namespace bench {
+    struct result {
+        std::string name;
+        uint32_t iterations=0;
+        double mean_ms=0.0;
+        double median_ms=0.0;
+        double min_ms=0.0;
+        double max_ms=0.0;
+        //! optional user counters by name, e.g. "items per ms"
+        std::map<std::string, double> counters;
+        //! messages passed to state::fail, empty when the case passed
+        std::vector<std::string> failures;
+    };
+
+    class state {
+    public:
+        state(uint32_t p_iterations) : m_iterations(p_iterations) {}
+
+        template<typename Body>
+        void measure(Body&& p_body) {
+            measure([]() {}, p_body);
+        }
+
+        template<typename Setup, typename Body>
+        void measure(Setup&& p_setup, Body&& p_body) {
+            using clock = std::chrono::steady_clock;
+            m_samples.reserve(m_iterations);
+            for(uint32_t i = 0; i < m_iterations; i++) {
+                p_setup();
+                auto start = clock::now();
+                p_body();
+                auto end = clock::now();
+                m_samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            }
+        }
+
+        //! @brief Sets the counter called p_name, a case can report several
+        void set_counter(const std::string& p_name, double p_value) { m_counters[p_name] = p_value; }
+
+        //! @brief Marks the case as failed, the remaining cases still run
+        void fail(const std::string& p_message) { m_failures.push_back(p_message); }
+
+        [[nodiscard]] result summarize(const std::string& p_name) const;
+
+    private:
+        uint32_t m_iterations;
+        std::vector<double> m_samples;
+        std::map<std::string, double> m_counters;
+        std::vector<std::string> m_failures;
+    };
+
+    struct entry {
+        std::string name;
+        std::function<void(state&)> run;
+        uint32_t iterations;
+    };
+
+    std::vector<entry>& registry();
+
+    struct registrar {
+        registrar(const std::string& p_name, std::function<void(state&)> p_run, uint32_t p_iterations = 10) {
+            registry().push_back({ p_name, std::move(p_run), p_iterations });
+        }
+    };
+
+    //! keeps the optimizer from discarding a computed value
+    template<typename T>
+    inline void do_not_optimize(const T& p_value) {
+        asm volatile("" : : "r,m"(p_value) : "memory");
+    }
+}
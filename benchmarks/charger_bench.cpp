@@ -0,0 +1,61 @@
+#include "benchmark.hpp"
+#include <charger.hpp>
+#include <random>
+#include <string>
+
+/**
+ * Steps charger_system with a growing number of chasers spread over the
+ * platform and 16 targets. ns_per_charger should stay roughly constant from
+ * 1k to 100k chasers if the per-step cost is linear.
+ */
+
+namespace {
+    constexpr uint32_t s_target_count = 16;
+
+    void populate(flecs::world& p_registry, uint32_t p_charger_count) {
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> across(-15.f, 15.f);
+        std::uniform_real_distribution<float> deep(-10.f, 10.f);
+
+        for(uint32_t i = 0; i < s_target_count; i++) {
+            p_registry.entity()
+              .set<atlas::transform>({ .position = { across(random), 1.f, deep(random) } })
+              .add<charge_target>();
+        }
+
+        for(uint32_t i = 0; i < p_charger_count; i++) {
+            p_registry.entity()
+              .set<atlas::transform>({ .position = { across(random), 1.f, deep(random) } })
+              // rearming keeps chasers cycling through every state during the run
+              .set<charger>({ .charge_once = false });
+        }
+        charger_system::arm(p_registry);
+    }
+
+    void register_charger_case(uint32_t p_charger_count) {
+        bench::registrar("charger/step/" + std::to_string(p_charger_count), [p_charger_count](bench::state& p_state) {
+            flecs::world registry;
+            populate(registry, p_charger_count);
+
+            charger_system chargers;
+            size_t events = 0;
+            // warm up so the buffers are sized and chasers are spread over the states
+            for(uint32_t i = 0; i < 30; i++) {
+                events += chargers.update(registry, 1.f / 60.f).size();
+            }
+
+            p_state.measure([&]() { events += chargers.update(registry, 1.f / 60.f).size(); });
+            bench::do_not_optimize(events);
+
+            double mean_ms = p_state.summarize({}).mean_ms;
+            p_state.set_counter("ns_per_charger", mean_ms * 1e6 / static_cast<double>(p_charger_count));
+        }, 30);
+    }
+
+    [[maybe_unused]] const bool s_registered = []() {
+        register_charger_case(1'000);
+        register_charger_case(10'000);
+        register_charger_case(100'000);
+        return true;
+    }();
+}
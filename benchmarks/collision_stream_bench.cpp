@@ -0,0 +1,104 @@
+#include "benchmark.hpp"
+#include <collision_stream.hpp>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+/**
+ * Compares handing every resting contact to a handler one event at a time
+ * (what the event bus does) against pushing the frame into a
+ * collision_stream and handling it as one batch, serially and on the shared
+ * thread pool.
+ */
+
+namespace {
+    //! most contacts are balls resting on the platform, one in a hundred involves the tracked entity
+    std::vector<atlas::event::collision_persisted> make_contacts(uint32_t p_count) {
+        std::vector<atlas::event::collision_persisted> contacts(p_count);
+        for(uint32_t i = 0; i < p_count; i++) {
+            contacts[i].entity1 = 1000 + i;
+            contacts[i].entity2 = (i % 100 == 0) ? 1 : 2;
+        }
+        return contacts;
+    }
+
+    //! stands in for per-contact gameplay work such as damage or sound selection
+    uint64_t contact_response(flecs::entity_t p_entity1, flecs::entity_t p_entity2) {
+        uint64_t value = p_entity1 * 0x9e3779b97f4a7c15ull ^ p_entity2;
+        for(uint32_t i = 0; i < 16; i++) {
+            value ^= value >> 29;
+            value *= 0xbf58476d1ce4e5b9ull;
+        }
+        return (p_entity1 == 1 or p_entity2 == 1) ? value & 1 : 0;
+    }
+
+    void register_collision_cases(uint32_t p_count) {
+        std::string suffix = "/" + std::to_string(p_count);
+
+        bench::registrar("collision_events/per_event" + suffix, [p_count](bench::state& p_state) {
+            auto contacts = make_contacts(p_count);
+            uint64_t matches = 0;
+            // type-erased like a bus listener, one indirect call per contact
+            std::function<void(atlas::event::collision_persisted&)> handler = [&](atlas::event::collision_persisted& p_event) {
+                matches += contact_response(p_event.entity1, p_event.entity2);
+            };
+
+            p_state.measure([&]() {
+                for(atlas::event::collision_persisted& contact : contacts) {
+                    handler(contact);
+                }
+            });
+            bench::do_not_optimize(matches);
+        });
+
+        bench::registrar("collision_events/batched" + suffix, [p_count](bench::state& p_state) {
+            auto contacts = make_contacts(p_count);
+            collision_stream stream(p_count);
+            uint64_t matches = 0;
+            stream.subscribe([&](const collision_batch& p_batch) {
+                for(size_t i = 0; i < p_batch.size(); i++) {
+                    matches += contact_response(p_batch.entity1[i], p_batch.entity2[i]);
+                }
+            });
+
+            // pushing is part of the cost, the physics step would do it in place of dispatching
+            p_state.measure([&]() {
+                for(const atlas::event::collision_persisted& contact : contacts) {
+                    stream.push(contact);
+                }
+                stream.publish();
+            });
+            bench::do_not_optimize(matches);
+        });
+
+        bench::registrar("collision_events/batched_parallel" + suffix, [p_count](bench::state& p_state) {
+            auto contacts = make_contacts(p_count);
+            collision_stream stream(p_count);
+            std::atomic<uint64_t> matches{ 0 };
+            stream.subscribe([&](const collision_batch& p_batch) {
+                p_batch.parallel_for(shared_thread_pool(), 4096, [&](size_t p_begin, size_t p_end) {
+                    uint64_t local = 0;
+                    for(size_t i = p_begin; i < p_end; i++) {
+                        local += contact_response(p_batch.entity1[i], p_batch.entity2[i]);
+                    }
+                    matches.fetch_add(local, std::memory_order_relaxed);
+                });
+            });
+
+            p_state.measure([&]() {
+                for(const atlas::event::collision_persisted& contact : contacts) {
+                    stream.push(contact);
+                }
+                stream.publish();
+            });
+            bench::do_not_optimize(matches.load());
+        });
+    }
+
+    [[maybe_unused]] const bool s_registered = []() {
+        register_collision_cases(1'000);
+        register_collision_cases(10'000);
+        register_collision_cases(100'000);
+        return true;
+    }();
+}
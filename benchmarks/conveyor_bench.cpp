@@ -0,0 +1,61 @@
+#include "benchmark.hpp"
+#include <conveyor_item.hpp>
+#include <string>
+
+/**
+ * Advances belts loaded with items, the layout of a factory level: 64 belts
+ * of 40 units each with the items spread evenly over them. Reports items
+ * moved per millisecond for a single thread and for the shared pool.
+ */
+
+namespace {
+    constexpr uint32_t s_belt_count = 64;
+
+    void populate(flecs::world& p_registry, uint32_t p_item_count) {
+        std::vector<flecs::entity> belts;
+        belts.reserve(s_belt_count);
+        for(uint32_t i = 0; i < s_belt_count; i++) {
+            float lane = static_cast<float>(i) * 2.f;
+            belts.push_back(p_registry.entity().set<conveyor_belt>({
+              .start = { lane, 0.f, 0.f },
+              .end = { lane, 0.f, -40.f },
+              .speed = 2.5f,
+            }));
+        }
+
+        for(uint32_t i = 0; i < p_item_count; i++) {
+            flecs::entity item = p_registry.entity().set<atlas::transform>({});
+            float distance = 40.f * static_cast<float>(i / s_belt_count) / static_cast<float>(p_item_count / s_belt_count + 1);
+            conveyor_system::attach(item, belts[i % s_belt_count], distance);
+        }
+    }
+
+    void register_conveyor_cases(uint32_t p_item_count) {
+        std::string suffix = "/" + std::to_string(p_item_count);
+
+        for(bool parallel : { false, true }) {
+            std::string name = std::string(parallel ? "conveyor/parallel" : "conveyor/serial") + suffix;
+            bench::registrar(name, [p_item_count, parallel](bench::state& p_state) {
+                flecs::world registry;
+                populate(registry, p_item_count);
+
+                conveyor_system conveyors;
+                thread_pool* pool = parallel ? &shared_thread_pool() : nullptr;
+                // first update builds the query and sizes the span list
+                conveyors.update(registry, 1.f / 60.f, pool);
+
+                p_state.measure([&]() { conveyors.update(registry, 1.f / 60.f, pool); });
+
+                double mean_ms = p_state.summarize({}).mean_ms;
+                p_state.set_counter("items_per_ms", mean_ms > 0.0 ? static_cast<double>(conveyors.item_count()) / mean_ms : 0.0);
+            });
+        }
+    }
+
+    [[maybe_unused]] const bool s_registered = []() {
+        register_conveyor_cases(10'000);
+        register_conveyor_cases(100'000);
+        register_conveyor_cases(1'000'000);
+        return true;
+    }();
+}
@@ -0,0 +1,91 @@
+#include "benchmark.hpp"
+#include "scene_generator.hpp"
+#include <collision_router.hpp>
+#include <functional>
+#include <vector>
+#include <physics/components.hpp>
+
+/**
+ * Dispatches a frame of 10k persisted contacts from a generated 10k entity
+ * scene through collision_router, the scene's fan-out behind the event bus
+ * listeners, with 1 and 8 filtered handlers. The direct case is a single
+ * type-erased listener doing its own id check, what a bus subscriber that
+ * does not use the router pays.
+ */
+
+namespace {
+    constexpr uint32_t s_entity_count = 10'000;
+    constexpr uint32_t s_contact_count = 10'000;
+
+    struct dispatch_world {
+        flecs::world registry;
+        std::vector<flecs::entity> entities;
+        std::vector<atlas::event::collision_persisted> contacts;
+
+        dispatch_world() {
+            entities = bench::spawn_scene(registry, { .entity_count = s_entity_count });
+
+            // every contact touches the first entity (the "platform"), one in a hundred also the second
+            contacts.resize(s_contact_count);
+            for(uint32_t i = 0; i < s_contact_count; i++) {
+                flecs::entity other = i % 100 == 0 ? entities[1] : entities[2 + i % (s_entity_count - 2)];
+                contacts[i].entity1 = other.id();
+                contacts[i].entity2 = entities[0].id();
+            }
+        }
+    };
+
+    void register_router_case(uint32_t p_handler_count) {
+        std::string name = "event_dispatch/router/" + std::to_string(p_handler_count) + "_handlers";
+        bench::registrar(name, [p_handler_count](bench::state& p_state) {
+            dispatch_world world;
+            collision_router router;
+            uint64_t calls = 0;
+
+            // half of the handlers filter on an entity, half on components of both sides
+            for(uint32_t i = 0; i < p_handler_count; i++) {
+                collision_filter filter;
+                if(i % 2 == 0) {
+                    filter.entity(world.entities[1].id());
+                }
+                else {
+                    filter.with(world.registry.component<atlas::sphere_collider>()).other_with(world.registry.component<atlas::box_collider>());
+                }
+                router.on<atlas::event::collision_persisted>(filter, [&](atlas::event::collision_persisted&, const collision_match&) { calls++; });
+            }
+
+            p_state.measure([&]() {
+                for(atlas::event::collision_persisted& contact : world.contacts) {
+                    router.dispatch(world.registry, contact);
+                }
+            });
+            bench::do_not_optimize(calls);
+            p_state.set_counter("events_per_ms", static_cast<double>(s_contact_count) / p_state.summarize({}).mean_ms);
+        });
+    }
+
+    [[maybe_unused]] const bool s_registered = []() {
+        bench::registrar("event_dispatch/direct", [](bench::state& p_state) {
+            dispatch_world world;
+            flecs::entity_t target = world.entities[1].id();
+            uint64_t calls = 0;
+            std::function<void(atlas::event::collision_persisted&)> listener = [&](atlas::event::collision_persisted& p_event) {
+                if(p_event.entity1 == target or p_event.entity2 == target) {
+                    calls++;
+                }
+            };
+
+            p_state.measure([&]() {
+                for(atlas::event::collision_persisted& contact : world.contacts) {
+                    listener(contact);
+                }
+            });
+            bench::do_not_optimize(calls);
+            p_state.set_counter("events_per_ms", static_cast<double>(s_contact_count) / p_state.summarize({}).mean_ms);
+        });
+
+        register_router_case(1);
+        register_router_case(8);
+        return true;
+    }();
+}
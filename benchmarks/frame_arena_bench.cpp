@@ -0,0 +1,49 @@
+#include "benchmark.hpp"
+#include <frame_arena.hpp>
+#include <string>
+#include <vector>
+
+/**
+ * A frame's worth of transient data: 10k short strings and a vector per
+ * hundred of them, the shape of per-frame name copies and scratch lists.
+ * Compares the global heap against the frame arena, reset once per frame.
+ */
+
+namespace {
+    constexpr uint32_t s_string_count = 10'000;
+
+    template<typename String, typename Vector>
+    uint64_t build_frame(std::pmr::memory_resource* p_resource) {
+        uint64_t total = 0;
+        Vector batch(p_resource);
+        for(uint32_t i = 0; i < s_string_count; i++) {
+            // longer than the small string buffer so every string allocates
+            String name("transient entity name number ", p_resource);
+            name += std::to_string(i);
+            total += name.size();
+            batch.push_back(i);
+            if(batch.size() == 100) {
+                batch = Vector(p_resource);
+            }
+        }
+        return total;
+    }
+
+    [[maybe_unused]] const bool s_registered = []() {
+        bench::registrar("frame_arena/heap/10000", [](bench::state& p_state) {
+            p_state.measure([]() {
+                bench::do_not_optimize(build_frame<frame_string, frame_vector<uint32_t>>(std::pmr::new_delete_resource()));
+            });
+        }, 50);
+
+        bench::registrar("frame_arena/arena/10000", [](bench::state& p_state) {
+            frame_arena arena;
+            p_state.measure([&]() {
+                bench::do_not_optimize(build_frame<frame_string, frame_vector<uint32_t>>(&arena));
+                arena.reset();
+            });
+            p_state.set_counter("peak_kb", static_cast<double>(arena.peak()) / 1024.0);
+        }, 50);
+        return true;
+    }();
+}
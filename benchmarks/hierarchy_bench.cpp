@@ -0,0 +1,90 @@
+#include "benchmark.hpp"
+#include "scene_generator.hpp"
+#include <scene_hierarchy.hpp>
+#include <string>
+#include <core/scene/components.hpp>
+
+/**
+ * Editor hierarchy model over a generated 10k entity scene parented in
+ * groups of 100. Times attaching to the world, then per iteration renaming,
+ * reparenting or spawning and destroying 1k entities through flecs and
+ * rebuilding the visible rows, which is what the hierarchy panel pays the
+ * frame after an edit. Nothing is drawn.
+ */
+
+namespace {
+    constexpr uint32_t s_entity_count = 10'000;
+    constexpr uint32_t s_edit_count = 1'000;
+    constexpr uint32_t s_group_size = 100;
+
+    struct hierarchy_world {
+        flecs::world registry;
+        std::vector<flecs::entity> entities;
+        // declared after the world so it detaches while the world is alive
+        scene_hierarchy hierarchy;
+
+        hierarchy_world() { entities = bench::spawn_scene(registry, { .entity_count = s_entity_count, .group_size = s_group_size }); }
+    };
+
+    [[maybe_unused]] const bool s_registered = []() {
+        bench::registrar("hierarchy/attach/10000", [](bench::state& p_state) {
+            hierarchy_world world;
+            p_state.measure([&]() {
+                world.hierarchy.attach(world.registry);
+                world.hierarchy.update_rows();
+                bench::do_not_optimize(world.hierarchy.node_count());
+            });
+        });
+
+        bench::registrar("hierarchy/rename/10000", [](bench::state& p_state) {
+            hierarchy_world world;
+            world.hierarchy.attach(world.registry);
+            world.hierarchy.update_rows();
+
+            uint32_t pass = 0;
+            p_state.measure([&]() {
+                const char* prefix = pass++ % 2 == 0 ? "Renamed " : "Entity ";
+                for(uint32_t i = 0; i < s_edit_count; i++) {
+                    world.entities[i].set_name((prefix + std::to_string(i)).c_str());
+                }
+                world.hierarchy.update_rows();
+            });
+        });
+
+        bench::registrar("hierarchy/reparent/10000", [](bench::state& p_state) {
+            hierarchy_world world;
+            world.hierarchy.attach(world.registry);
+            world.hierarchy.update_rows();
+            flecs::entity first_group = world.registry.lookup("Group 0");
+            flecs::entity last_group = world.registry.lookup(("Group " + std::to_string(s_entity_count / s_group_size - 1)).c_str());
+
+            uint32_t pass = 0;
+            p_state.measure([&]() {
+                flecs::entity target = pass++ % 2 == 0 ? last_group : first_group;
+                for(uint32_t i = 0; i < s_edit_count; i++) {
+                    world.entities[i].child_of(target);
+                }
+                world.hierarchy.update_rows();
+            });
+        });
+
+        bench::registrar("hierarchy/spawn_destroy/10000", [](bench::state& p_state) {
+            hierarchy_world world;
+            world.hierarchy.attach(world.registry);
+            world.hierarchy.update_rows();
+
+            std::vector<flecs::entity> spawned(s_edit_count);
+            p_state.measure([&]() {
+                for(uint32_t i = 0; i < s_edit_count; i++) {
+                    spawned[i] = world.registry.entity(("Spawned " + std::to_string(i)).c_str()).set<atlas::transform>({});
+                }
+                world.hierarchy.update_rows();
+                for(flecs::entity entity : spawned) {
+                    entity.destruct();
+                }
+                world.hierarchy.update_rows();
+            });
+        });
+        return true;
+    }();
+}
@@ -0,0 +1,227 @@
+#include "benchmark.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <numeric>
+#include <thread>
+#include <unordered_map>
+#include <yaml-cpp/yaml.h>
+
+#ifndef GAME_TEMPLATE_REVISION
+#define GAME_TEMPLATE_REVISION "unknown"
+#endif
+
+namespace bench {
+    std::vector<entry>& registry() {
+        static std::vector<entry> s_entries;
+        return s_entries;
+    }
+
+    result state::summarize(const std::string& p_name) const {
+        result summary;
+        summary.name = p_name;
+        summary.iterations = static_cast<uint32_t>(m_samples.size());
+        if(!m_samples.empty()) {
+            summary.mean_ms = std::accumulate(m_samples.begin(), m_samples.end(), 0.0) / m_samples.size();
+            summary.min_ms = *std::min_element(m_samples.begin(), m_samples.end());
+            summary.max_ms = *std::max_element(m_samples.begin(), m_samples.end());
+
+            std::vector<double> sorted = m_samples;
+            std::sort(sorted.begin(), sorted.end());
+            size_t middle = sorted.size() / 2;
+            summary.median_ms = sorted.size() % 2 == 1 ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) * 0.5;
+        }
+        summary.counters = m_counters;
+        summary.failures = m_failures;
+        return summary;
+    }
+}
+
+namespace {
+    std::string json_escape(const std::string& p_text) {
+        std::string escaped;
+        escaped.reserve(p_text.size());
+        for(char c : p_text) {
+            if(c == '"' or c == '\\') {
+                escaped += '\\';
+                escaped += c;
+            }
+            else if(static_cast<unsigned char>(c) < 0x20) {
+                char code[8];
+                std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(c));
+                escaped += code;
+            }
+            else {
+                escaped += c;
+            }
+        }
+        return escaped;
+    }
+
+    std::string compiler_name() {
+#if defined(__clang__)
+        return "clang " __clang_version__;
+#elif defined(__GNUC__)
+        return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+        return "msvc " + std::to_string(_MSC_VER);
+#else
+        return "unknown";
+#endif
+    }
+
+    /**
+     * One object per run: where it ran and on which revision, then one entry
+     * per case. Field names stay stable so runs from different commits can be
+     * compared with --baseline or any JSON tool.
+     */
+    bool write_json(const char* p_path, const std::vector<bench::result>& p_results) {
+        std::FILE* file = std::fopen(p_path, "w");
+        if(file == nullptr) {
+            return false;
+        }
+
+        std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        char timestamp[32];
+        std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+        std::fprintf(file, "{\n");
+        std::fprintf(file, "  \"revision\": \"%s\",\n", json_escape(GAME_TEMPLATE_REVISION).c_str());
+        std::fprintf(file, "  \"timestamp\": \"%s\",\n", timestamp);
+        std::fprintf(file, "  \"compiler\": \"%s\",\n", json_escape(compiler_name()).c_str());
+        std::fprintf(file, "  \"hardware_threads\": %u,\n", std::thread::hardware_concurrency());
+        std::fprintf(file, "  \"benchmarks\": [");
+        for(size_t i = 0; i < p_results.size(); i++) {
+            const bench::result& result = p_results[i];
+            std::fprintf(file, "%s\n    {\"name\": \"%s\", \"iterations\": %u, \"mean_ms\": %.6f, \"median_ms\": %.6f, \"min_ms\": %.6f, \"max_ms\": %.6f",
+                         i == 0 ? "" : ",", json_escape(result.name).c_str(), result.iterations, result.mean_ms, result.median_ms, result.min_ms,
+                         result.max_ms);
+            if(!result.counters.empty()) {
+                std::fprintf(file, ", \"counters\": {");
+                const char* separator = "";
+                for(const auto& [name, value] : result.counters) {
+                    std::fprintf(file, "%s\"%s\": %.6f", separator, json_escape(name).c_str(), value);
+                    separator = ", ";
+                }
+                std::fprintf(file, "}");
+            }
+            if(!result.failures.empty()) {
+                std::fprintf(file, ", \"failures\": [");
+                const char* separator = "";
+                for(const std::string& failure : result.failures) {
+                    std::fprintf(file, "%s\"%s\"", separator, json_escape(failure).c_str());
+                    separator = ", ";
+                }
+                std::fprintf(file, "]");
+            }
+            std::fprintf(file, "}");
+        }
+        std::fprintf(file, "\n  ]\n}\n");
+        return std::fclose(file) == 0;
+    }
+
+    //! median times by case name from a file written by --json, JSON is read as YAML
+    bool read_baseline(const char* p_path, std::unordered_map<std::string, double>& p_medians) {
+        try {
+            YAML::Node root = YAML::LoadFile(p_path);
+            for(const YAML::Node& entry : root["benchmarks"]) {
+                p_medians[entry["name"].as<std::string>()] = entry["median_ms"].as<double>();
+            }
+        }
+        catch(const YAML::Exception& p_error) {
+            std::fprintf(stderr, "could not read baseline %s: %s\n", p_path, p_error.what());
+            return false;
+        }
+        return true;
+    }
+}
+
+/**
+ * usage: game-template-benchmarks [--filter <substring>] [--iterations <n>] [--json <path>] [--baseline <path>]
+ *
+ * --json writes every result to a JSON file, --baseline reads one written by
+ * an earlier run and prints the change in median time per case. The exit
+ * code is 2 when a case failed its own checks.
+ */
+int main(int argc, char** argv) {
+    const char* filter = nullptr;
+    uint32_t iterations_override = 0;
+    const char* json_path = nullptr;
+    const char* baseline_path = nullptr;
+
+    for(int i = 1; i < argc; i++) {
+        if(std::strcmp(argv[i], "--filter") == 0 and i + 1 < argc) {
+            filter = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--iterations") == 0 and i + 1 < argc) {
+            iterations_override = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if(std::strcmp(argv[i], "--json") == 0 and i + 1 < argc) {
+            json_path = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--baseline") == 0 and i + 1 < argc) {
+            baseline_path = argv[++i];
+        }
+        else {
+            std::fprintf(stderr, "usage: %s [--filter <substring>] [--iterations <n>] [--json <path>] [--baseline <path>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::unordered_map<std::string, double> baseline;
+    if(baseline_path != nullptr and !read_baseline(baseline_path, baseline)) {
+        return 1;
+    }
+
+    std::vector<bench::result> results;
+    size_t failed = 0;
+    std::printf("%-48s %8s %12s %12s %12s %12s", "benchmark", "iters", "mean (ms)", "median (ms)", "min (ms)", "max (ms)");
+    std::printf(baseline_path != nullptr ? " %10s\n" : "\n", "vs base");
+    for(const bench::entry& entry : bench::registry()) {
+        if(filter != nullptr and entry.name.find(filter) == std::string::npos) {
+            continue;
+        }
+
+        bench::state state(iterations_override != 0 ? iterations_override : entry.iterations);
+        entry.run(state);
+
+        bench::result result = state.summarize(entry.name);
+        std::printf("%-48s %8u %12.4f %12.4f %12.4f %12.4f", result.name.c_str(), result.iterations, result.mean_ms, result.median_ms, result.min_ms,
+                    result.max_ms);
+        if(baseline_path != nullptr) {
+            auto base = baseline.find(result.name);
+            if(base != baseline.end() and base->second > 0.0) {
+                std::printf(" %+9.1f%%", (result.median_ms / base->second - 1.0) * 100.0);
+            }
+            else {
+                std::printf(" %10s", "new");
+            }
+        }
+        for(const auto& [name, value] : result.counters) {
+            std::printf("  %s=%.2f", name.c_str(), value);
+        }
+        std::printf("\n");
+        for(const std::string& failure : result.failures) {
+            std::fprintf(stderr, "%s FAILED: %s\n", result.name.c_str(), failure.c_str());
+        }
+        failed += result.failures.empty() ? 0 : 1;
+        results.push_back(std::move(result));
+    }
+
+    if(json_path != nullptr) {
+        if(!write_json(json_path, results)) {
+            std::fprintf(stderr, "could not write %s\n", json_path);
+            return 1;
+        }
+        std::printf("%zu results written to %s\n", results.size(), json_path);
+    }
+
+    if(failed > 0) {
+        std::fprintf(stderr, "%zu of %zu cases failed\n", failed, results.size());
+        return 2;
+    }
+    return 0;
+}
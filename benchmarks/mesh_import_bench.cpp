@@ -0,0 +1,88 @@
+#include "benchmark.hpp"
+#include <mesh_cache.hpp>
+#include <mesh_optimizer.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+/**
+ * Imports every OBJ under assets/models with tinyobjloader and welds it
+ * (mesh_cache::import_obj, what a cache miss pays), then maps the cache
+ * file written from the same geometry (what a cache hit pays). The
+ * optimize case is the welding, LOD generation and reordering a miss runs
+ * before writing the cache, its counters are the triangles and ACMR of
+ * every level. Paths are relative, run from the repository root.
+ */
+
+namespace {
+    std::vector<std::filesystem::path> find_models() {
+        std::vector<std::filesystem::path> models;
+        std::error_code error;
+        for(const auto& item : std::filesystem::directory_iterator("assets/models", error)) {
+            if(item.is_regular_file() and item.path().extension() == ".obj") {
+                models.push_back(item.path());
+            }
+        }
+        // directory order is unspecified, keep case names stable between runs
+        std::sort(models.begin(), models.end());
+        return models;
+    }
+
+    void register_model_cases(const std::filesystem::path& p_model) {
+        std::string suffix = "/" + p_model.filename().string();
+
+        bench::registrar("mesh_import/obj" + suffix, [p_model](bench::state& p_state) {
+            mesh_geometry geometry;
+            p_state.measure([&]() { bench::do_not_optimize(mesh_cache::import_obj(p_model, geometry)); });
+            p_state.set_counter("triangles", static_cast<double>(geometry.indices.size() / 3));
+        }, 3);
+
+        bench::registrar("mesh_import/optimize" + suffix, [p_model](bench::state& p_state) {
+            mesh_geometry imported;
+            if(!mesh_cache::import_obj(p_model, imported)) {
+                return;
+            }
+
+            mesh_geometry geometry;
+            mesh_optimize_report report;
+            p_state.measure([&]() { geometry = imported; }, [&]() { report = optimize_mesh(geometry); });
+            p_state.set_counter("vertices", report.vertices_after);
+            for(size_t level = 0; level < report.lods.size(); level++) {
+                const mesh_lod_report& lod = report.lods[level];
+                std::string prefix = "lod " + std::to_string(level);
+                p_state.set_counter(prefix + " triangles", lod.triangles);
+                p_state.set_counter(prefix + " acmr before", lod.acmr_before);
+                p_state.set_counter(prefix + " acmr after", lod.acmr_after);
+            }
+        }, 3);
+
+        bench::registrar("mesh_import/cache_hit" + suffix, [p_model](bench::state& p_state) {
+            mesh_geometry geometry;
+            if(!mesh_cache::import_obj(p_model, geometry)) {
+                return;
+            }
+
+            auto directory = std::filesystem::temp_directory_path() / "game-template-bench";
+            std::filesystem::create_directories(directory);
+            auto cache_path = directory / (p_model.stem().string() + ".mesh");
+            if(!mesh_cache::write_mesh_file(cache_path, geometry, 0, 0, 0)) {
+                return;
+            }
+
+            p_state.measure([&]() {
+                mesh_data mesh(cache_path);
+                bench::do_not_optimize(mesh.indices().size());
+            });
+            p_state.set_counter("triangles", static_cast<double>(geometry.indices.size() / 3));
+        }, 10);
+    }
+
+    [[maybe_unused]] const bool s_registered = []() {
+        for(const std::filesystem::path& model : find_models()) {
+            register_model_cases(model);
+        }
+        return true;
+    }();
+}
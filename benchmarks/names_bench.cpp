@@ -0,0 +1,108 @@
+#include "benchmark.hpp"
+#include <names.hpp>
+#include <cstring>
+#include <random>
+#include <string>
+
+/**
+ * 50k named entities. Looks up 10k random names through flecs' own lookup
+ * and through name_index by string and by interned id, then checks 100k
+ * contacts against one name the way collision handlers used to, comparing
+ * name strings against comparing interned ids.
+ */
+
+namespace {
+    constexpr uint32_t s_entity_count = 50'000;
+    constexpr uint32_t s_lookup_count = 10'000;
+    constexpr uint32_t s_contact_count = 100'000;
+
+    struct named_world {
+        flecs::world registry;
+        name_table names;
+        name_index index;
+        std::vector<flecs::entity> entities;
+        std::vector<std::string> lookups;
+
+        named_world() {
+            entities.reserve(s_entity_count);
+            for(uint32_t i = 0; i < s_entity_count; i++) {
+                entities.push_back(registry.entity(("Entity " + std::to_string(i)).c_str()));
+            }
+            index.attach(registry, names);
+
+            std::mt19937 random(5);
+            std::uniform_int_distribution<uint32_t> pick(0, s_entity_count - 1);
+            lookups.reserve(s_lookup_count);
+            for(uint32_t i = 0; i < s_lookup_count; i++) {
+                lookups.push_back("Entity " + std::to_string(pick(random)));
+            }
+        }
+
+        ~named_world() { index.detach(); }
+    };
+
+    [[maybe_unused]] const bool s_registered = []() {
+        bench::registrar("names/flecs_lookup/50000", [](bench::state& p_state) {
+            named_world world;
+            uint64_t found = 0;
+            p_state.measure([&]() {
+                for(const std::string& name : world.lookups) {
+                    found += world.registry.lookup(name.c_str()).id();
+                }
+            });
+            bench::do_not_optimize(found);
+        });
+
+        bench::registrar("names/index_find_string/50000", [](bench::state& p_state) {
+            named_world world;
+            uint64_t found = 0;
+            p_state.measure([&]() {
+                for(const std::string& name : world.lookups) {
+                    found += world.index.find(std::string_view(name));
+                }
+            });
+            bench::do_not_optimize(found);
+        });
+
+        bench::registrar("names/index_find_id/50000", [](bench::state& p_state) {
+            named_world world;
+            std::vector<name_id> ids;
+            for(const std::string& name : world.lookups) {
+                ids.push_back(world.names.find(name));
+            }
+            uint64_t found = 0;
+            p_state.measure([&]() {
+                for(name_id id : ids) {
+                    found += world.index.find(id);
+                }
+            });
+            bench::do_not_optimize(found);
+        });
+
+        bench::registrar("names/compare_string/100000", [](bench::state& p_state) {
+            named_world world;
+            uint64_t matches = 0;
+            p_state.measure([&]() {
+                for(uint32_t i = 0; i < s_contact_count; i++) {
+                    const flecs::entity& entity = world.entities[i % s_entity_count];
+                    matches += std::strcmp(entity.name().c_str(), "Entity 42") == 0;
+                }
+            });
+            bench::do_not_optimize(matches);
+        });
+
+        bench::registrar("names/compare_id/100000", [](bench::state& p_state) {
+            named_world world;
+            name_id wanted = world.names.find("Entity 42");
+            uint64_t matches = 0;
+            p_state.measure([&]() {
+                for(uint32_t i = 0; i < s_contact_count; i++) {
+                    matches += world.index.name_of(world.entities[i % s_entity_count].id()) == wanted;
+                }
+            });
+            bench::do_not_optimize(matches);
+        });
+
+        return true;
+    }();
+}
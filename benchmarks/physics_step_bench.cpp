@@ -0,0 +1,159 @@
+#include "benchmark.hpp"
+#include <physics_job_system.hpp>
+#include <Jolt/Core/Factory.h>
+#include <Jolt/Core/JobSystemSingleThreaded.h>
+#include <Jolt/Core/TempAllocator.h>
+#include <Jolt/Physics/Body/BodyCreationSettings.h>
+#include <Jolt/Physics/Collision/Shape/BoxShape.h>
+#include <Jolt/Physics/Collision/Shape/SphereShape.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/RegisterTypes.h>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Steps a Jolt world holding the main scene's Platform and a grid of dynamic
+ * spheres dropped onto it, once per thread count. Jolt is used directly
+ * because atlas::physics::physics_engine owns its job system; the
+ * multi-threaded cases run on physics_job_system over a pool of threads - 1
+ * workers, the single-threaded case on JPH::JobSystemSingleThreaded.
+ */
+
+namespace {
+    namespace layers {
+        constexpr JPH::ObjectLayer non_moving = 0;
+        constexpr JPH::ObjectLayer moving = 1;
+    }
+
+    const JPH::BroadPhaseLayer s_non_moving_broad_phase(0);
+    const JPH::BroadPhaseLayer s_moving_broad_phase(1);
+
+    class bench_broad_phase_layers final : public JPH::BroadPhaseLayerInterface {
+    public:
+        JPH::uint GetNumBroadPhaseLayers() const override { return 2; }
+
+        JPH::BroadPhaseLayer GetBroadPhaseLayer(JPH::ObjectLayer p_layer) const override {
+            return p_layer == layers::non_moving ? s_non_moving_broad_phase : s_moving_broad_phase;
+        }
+
+#if defined(JPH_EXTERNAL_PROFILE) || defined(JPH_PROFILE_ENABLED)
+        const char* GetBroadPhaseLayerName(JPH::BroadPhaseLayer p_layer) const override {
+            return p_layer == s_non_moving_broad_phase ? "non_moving" : "moving";
+        }
+#endif
+    };
+
+    class bench_object_vs_broad_phase final : public JPH::ObjectVsBroadPhaseLayerFilter {
+    public:
+        bool ShouldCollide(JPH::ObjectLayer p_layer, JPH::BroadPhaseLayer p_broad_phase) const override {
+            return p_layer == layers::moving or p_broad_phase == s_moving_broad_phase;
+        }
+    };
+
+    class bench_object_pairs final : public JPH::ObjectLayerPairFilter {
+    public:
+        bool ShouldCollide(JPH::ObjectLayer p_a, JPH::ObjectLayer p_b) const override {
+            return p_a == layers::moving or p_b == layers::moving;
+        }
+    };
+
+    constexpr float s_step = 1.f / 60.f;
+    //! lets the spheres land and settle into contact so the measured steps include resting contacts
+    constexpr uint32_t s_warmup_steps = 60;
+
+    void register_jolt_types() {
+        static std::once_flag s_once;
+        std::call_once(s_once, []() {
+            JPH::RegisterDefaultAllocator();
+            JPH::Factory::sInstance = new JPH::Factory();
+            JPH::RegisterTypes();
+        });
+    }
+
+    /**
+     * Platform from main_scene (30 x 0.6 x 20 box at the origin) with spheres of
+     * radius 0.5 in layers of a 28 x 18 grid above it, which is roughly a 50 / 50
+     * split between spheres resting on the platform and spheres in free fall
+     * once the stack spills over the edges at the larger counts.
+     */
+    struct sphere_world {
+        bench_broad_phase_layers broad_phase_layers;
+        bench_object_vs_broad_phase object_vs_broad_phase;
+        bench_object_pairs object_pairs;
+        JPH::TempAllocatorImpl temp_allocator{ 64 * 1024 * 1024 };
+        JPH::PhysicsSystem system;
+
+        sphere_world(uint32_t p_sphere_count) {
+            uint32_t capacity = p_sphere_count + 1;
+            system.Init(capacity, 0, capacity * 4, capacity * 4, broad_phase_layers, object_vs_broad_phase, object_pairs);
+
+            JPH::BodyInterface& bodies = system.GetBodyInterface();
+            JPH::BodyCreationSettings platform(new JPH::BoxShape(JPH::Vec3(15.f, 0.30f, 10.f)), JPH::RVec3::sZero(),
+                                               JPH::Quat::sIdentity(), JPH::EMotionType::Static, layers::non_moving);
+            bodies.CreateAndAddBody(platform, JPH::EActivation::DontActivate);
+
+            constexpr uint32_t columns = 28;
+            constexpr uint32_t rows = 18;
+            JPH::RefConst<JPH::Shape> sphere = new JPH::SphereShape(0.5f);
+            for(uint32_t i = 0; i < p_sphere_count; i++) {
+                uint32_t layer = i / (columns * rows);
+                uint32_t cell = i % (columns * rows);
+                JPH::RVec3 position(static_cast<float>(cell % columns) - 13.5f, 1.f + 1.1f * static_cast<float>(layer),
+                                    static_cast<float>(cell / columns) - 8.5f);
+                JPH::BodyCreationSettings settings(sphere, position, JPH::Quat::sIdentity(), JPH::EMotionType::Dynamic, layers::moving);
+                bodies.CreateAndAddBody(settings, JPH::EActivation::Activate);
+            }
+            system.OptimizeBroadPhase();
+        }
+
+        void step(JPH::JobSystem& p_jobs) { system.Update(s_step, 1, &temp_allocator, &p_jobs); }
+    };
+
+    std::vector<uint32_t> thread_counts() {
+        uint32_t hardware = std::max(std::thread::hardware_concurrency(), 1u);
+        std::vector<uint32_t> counts;
+        for(uint32_t count = 1; count < hardware; count *= 2) {
+            counts.push_back(count);
+        }
+        counts.push_back(hardware);
+        return counts;
+    }
+
+    void register_step_cases(uint32_t p_sphere_count) {
+        for(uint32_t threads : thread_counts()) {
+            std::string name = "physics_step/" + std::to_string(p_sphere_count) + "/threads_" + std::to_string(threads);
+            bench::registrar(name, [p_sphere_count, threads](bench::state& p_state) {
+                register_jolt_types();
+
+                std::unique_ptr<thread_pool> pool;
+                std::unique_ptr<JPH::JobSystem> jobs;
+                if(threads == 1) {
+                    jobs = std::make_unique<JPH::JobSystemSingleThreaded>(JPH::cMaxPhysicsJobs);
+                }
+                else {
+                    pool = std::make_unique<thread_pool>(threads - 1);
+                    jobs = std::make_unique<physics_job_system>(*pool);
+                }
+
+                sphere_world world(p_sphere_count);
+                for(uint32_t i = 0; i < s_warmup_steps; i++) {
+                    world.step(*jobs);
+                }
+
+                p_state.measure([&]() { world.step(*jobs); });
+                p_state.set_counter("active_bodies", static_cast<double>(world.system.GetNumActiveBodies(JPH::EBodyType::RigidBody)));
+            });
+        }
+    }
+
+    [[maybe_unused]] const bool s_registered = []() {
+        register_step_cases(1'000);
+        register_step_cases(10'000);
+        register_step_cases(50'000);
+        return true;
+    }();
+}
@@ -0,0 +1,97 @@
+#include "benchmark.hpp"
+#include "scene_generator.hpp"
+#include <render_batches.hpp>
+#include <core/math/utilities.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Builds instanced draw batches for generated scenes, whose entities pick
+ * one of four (model, texture) pairs. build_all batches every entity,
+ * build_visible batches what visibility_system kept from the middle of the
+ * grid, split by LOD, and counts the draws it needs. per_entity is the
+ * current path for comparison: one MaterialSource matrix and color written
+ * per entity, each its own draw. build_all and per_entity count instances
+ * packed per millisecond.
+ */
+
+namespace {
+    constexpr uint32_t s_iterations = 10;
+
+    struct batch_fixture {
+        std::unique_ptr<flecs::world> registry;
+        render_batcher batcher;
+        visibility_system visibility;
+    };
+
+    std::unique_ptr<batch_fixture> make_fixture(uint32_t p_entity_count) {
+        auto fixture = std::make_unique<batch_fixture>();
+        fixture->registry = std::make_unique<flecs::world>();
+        bench::spawn_scene(*fixture->registry, { .entity_count = p_entity_count });
+        fixture->batcher.attach(*fixture->registry);
+        // the first build assigns the batch keys, later ones measure the steady state
+        fixture->batcher.build(*fixture->registry);
+        return fixture;
+    }
+
+    void register_cases(uint32_t p_entity_count) {
+        std::string suffix = "/" + std::to_string(p_entity_count);
+
+        bench::registrar("render_batch/build_all" + suffix, [p_entity_count](bench::state& p_state) {
+            auto fixture = make_fixture(p_entity_count);
+            auto start = std::chrono::steady_clock::now();
+            p_state.measure([&]() { fixture->batcher.build(*fixture->registry); });
+            double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            p_state.set_counter("instances_per_ms", fixture->batcher.stats().instances * s_iterations / elapsed);
+        }, s_iterations);
+
+        bench::registrar("render_batch/build_visible" + suffix, [p_entity_count](bench::state& p_state) {
+            auto fixture = make_fixture(p_entity_count);
+            fixture->visibility.attach(*fixture->registry);
+            fixture->visibility.sync(*fixture->registry);
+
+            // middle of the grid looking along +x, as in the visibility cases
+            atlas::transform camera_transform;
+            float half_extent = std::ceil(std::sqrt(static_cast<float>(p_entity_count))) * 2.f * 0.5f;
+            camera_transform.position = { half_extent, 20.f, half_extent };
+            float yaw = glm::radians(-90.f);
+            camera_transform.quaternion = { 0.f, std::sin(yaw * 0.5f), 0.f, std::cos(yaw * 0.5f) };
+            atlas::perspective_camera camera;
+            camera.plane = { 0.1f, 5000.f };
+            camera.field_of_view = 45.f;
+            auto visible = fixture->visibility.cull(camera_transform, camera, 16.f / 9.f);
+
+            p_state.measure([&]() { fixture->batcher.build(*fixture->registry, visible); });
+            p_state.set_counter("draws", fixture->batcher.stats().batches);
+        });
+
+        bench::registrar("render_batch/per_entity" + suffix, [p_entity_count](bench::state& p_state) {
+            auto fixture = make_fixture(p_entity_count);
+            auto query = fixture->registry->query_builder<const atlas::transform, const atlas::material>().build();
+            std::vector<instance_data> uniforms;
+            auto start = std::chrono::steady_clock::now();
+            p_state.measure([&]() {
+                uniforms.clear();
+                query.each([&](flecs::entity, const atlas::transform& p_transform, const atlas::material& p_material) {
+                    glm::mat4 model = glm::translate(glm::mat4(1.f), p_transform.position) * glm::mat4_cast(atlas::to_quat(p_transform.quaternion)) *
+                                      glm::scale(glm::mat4(1.f), p_transform.scale);
+                    uniforms.push_back({ model, p_material.color });
+                });
+            });
+            double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            p_state.set_counter("instances_per_ms", uniforms.size() * s_iterations / elapsed);
+        }, s_iterations);
+    }
+
+    [[maybe_unused]] const bool s_registered = []() {
+        for(uint32_t count : { 10'000u, 100'000u }) {
+            register_cases(count);
+        }
+        return true;
+    }();
+}
@@ -0,0 +1,94 @@
+#include "benchmark.hpp"
+#include "scene_generator.hpp"
+#include <binary_scene.hpp>
+#include <scene_document.hpp>
+#include <filesystem>
+#include <memory>
+#include <unordered_map>
+
+/**
+ * Compares loading and saving generated LevelScene-style scenes as YAML
+ * against the memory-mapped binary scene format at 100, 10k and 100k
+ * entities.
+ */
+
+namespace {
+    struct scene_files {
+        std::filesystem::path yaml;
+        std::filesystem::path binary;
+    };
+
+    //! scenes are generated once per size and reused by every case
+    const scene_files& get_scene_files(uint32_t p_entity_count) {
+        static std::unordered_map<uint32_t, scene_files> s_files;
+        auto it = s_files.find(p_entity_count);
+        if(it != s_files.end()) {
+            return it->second;
+        }
+
+        auto directory = std::filesystem::temp_directory_path() / "game-template-bench";
+        std::filesystem::create_directories(directory);
+
+        scene_files files{
+            .yaml = directory / ("scene_" + std::to_string(p_entity_count) + ".yaml"),
+            .binary = directory / ("scene_" + std::to_string(p_entity_count) + ".bin"),
+        };
+
+        scene_document document = bench::generate_scene({ .entity_count = p_entity_count });
+        write_yaml_scene(files.yaml, document);
+        write_binary_scene(files.binary, document);
+        return s_files.emplace(p_entity_count, files).first->second;
+    }
+
+    void register_scene_cases(uint32_t p_entity_count, uint32_t p_iterations) {
+        std::string suffix = "/" + std::to_string(p_entity_count);
+
+        bench::registrar("scene_format/yaml_parse" + suffix, [p_entity_count](bench::state& p_state) {
+            const scene_files& files = get_scene_files(p_entity_count);
+            p_state.measure([&]() {
+                scene_document document;
+                read_yaml_scene(files.yaml, document);
+                bench::do_not_optimize(document.entities.size());
+            });
+        }, p_iterations);
+
+        bench::registrar("scene_format/binary_map" + suffix, [p_entity_count](bench::state& p_state) {
+            const scene_files& files = get_scene_files(p_entity_count);
+            p_state.measure([&]() {
+                binary_scene scene(files.binary);
+                bench::do_not_optimize(scene.entity_count());
+            });
+        }, p_iterations);
+
+        bench::registrar("scene_format/binary_load" + suffix, [p_entity_count](bench::state& p_state) {
+            const scene_files& files = get_scene_files(p_entity_count);
+            std::unique_ptr<flecs::world> registry;
+            p_state.measure([&]() { registry = std::make_unique<flecs::world>(); },
+                            [&]() {
+                                binary_scene scene(files.binary);
+                                bench::do_not_optimize(scene.apply(*registry).size());
+                            });
+        }, p_iterations);
+
+        bench::registrar("scene_format/yaml_write" + suffix, [p_entity_count](bench::state& p_state) {
+            scene_document document = bench::generate_scene({ .entity_count = p_entity_count });
+            auto path = get_scene_files(p_entity_count).yaml;
+            path.replace_extension(".write.yaml");
+            p_state.measure([&]() { bench::do_not_optimize(write_yaml_scene(path, document)); });
+        }, p_iterations);
+
+        bench::registrar("scene_format/binary_write" + suffix, [p_entity_count](bench::state& p_state) {
+            scene_document document = bench::generate_scene({ .entity_count = p_entity_count });
+            auto path = get_scene_files(p_entity_count).binary;
+            path.replace_extension(".write.bin");
+            p_state.measure([&]() { bench::do_not_optimize(write_binary_scene(path, document)); });
+        }, p_iterations);
+    }
+
+    [[maybe_unused]] const bool s_registered = []() {
+        register_scene_cases(100, 20);
+        register_scene_cases(10'000, 5);
+        register_scene_cases(100'000, 3);
+        return true;
+    }();
+}
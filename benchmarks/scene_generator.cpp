@@ -0,0 +1,145 @@
+#include "scene_generator.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <string>
+#include <core/scene/components.hpp>
+#include <physics/components.hpp>
+
+namespace bench {
+    namespace {
+        struct model_choice {
+            const char* model_path;
+            const char* texture_path;
+        };
+
+        constexpr std::array<model_choice, 4> s_models = { {
+          { "assets/models/cube.obj", "assets/models/wood.png" },
+          { "assets/models/sphere.obj", "assets/models/wall.jpg" },
+          { "assets/models/colored_cube.obj", "" },
+          { "assets/models/smooth_vase.obj", "assets/models/container_diffuse.png" },
+        } };
+
+        //! body_movement_type values as the scene files store them
+        constexpr uint32_t s_static_body = 0;
+        constexpr uint32_t s_dynamic_body = 2;
+    }
+
+    scene_document generate_scene(const scene_generator_settings& p_settings) {
+        scene_document document;
+        document.name = "BenchScene";
+        document.entities.reserve(p_settings.entity_count);
+
+        std::mt19937 random(p_settings.seed);
+        auto dynamic_threshold = static_cast<uint32_t>(std::clamp(p_settings.dynamic_fraction, 0.f, 1.f) * 1000.f);
+        auto columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(std::max(p_settings.entity_count, 1u)))));
+
+        for(uint32_t i = 0; i < p_settings.entity_count; i++) {
+            bool dynamic = random() % 1000 < dynamic_threshold;
+            bool sphere = dynamic and random() % 2 == 0;
+            const model_choice& model = s_models[random() % s_models.size()];
+            glm::vec3 position{ static_cast<float>(i % columns) * p_settings.spacing, dynamic ? 4.f : 0.5f,
+                                static_cast<float>(i / columns) * p_settings.spacing };
+
+            scene_entity_desc entity;
+            entity.name = "Entity " + std::to_string(i);
+            entity.transform = scene_format::transform_record{
+                .position = position,
+                .rotation = glm::vec3(0.f),
+                .scale = glm::vec3(1.f),
+                .quaternion = { 0.f, 0.f, 0.f, 1.f },
+            };
+            entity.material = scene_material_desc{
+                .color = glm::vec4(1.f),
+                .model_path = model.model_path,
+                .texture_path = model.texture_path,
+            };
+            entity.physics_body = scene_format::physics_body_record{
+                .linear_velocity = glm::vec3(0.f),
+                .angular_velocity = glm::vec3(0.f),
+                .cumulative_force = glm::vec3(0.f),
+                .cumulative_torque = glm::vec3(0.f),
+                .center_mass_position = position,
+                .mass_factor = 1.f,
+                .friction = 0.8f,
+                .restitution = dynamic ? 0.3f : 0.f,
+                .body_movement_type = dynamic ? s_dynamic_body : s_static_body,
+                .body_layer_type = dynamic ? 1u : 0u,
+            };
+            if(sphere) {
+                entity.sphere_collider = scene_format::sphere_collider_record{ .radius = 0.5f };
+            }
+            else {
+                entity.box_collider = scene_format::box_collider_record{ .half_extent = glm::vec3(0.5f) };
+            }
+            document.entities.push_back(std::move(entity));
+        }
+
+        return document;
+    }
+
+    std::vector<flecs::entity> spawn_scene(flecs::world& p_registry, const scene_generator_settings& p_settings) {
+        scene_document document = generate_scene(p_settings);
+
+        std::vector<flecs::entity> entities;
+        entities.reserve(document.entities.size());
+        for(const scene_entity_desc& desc : document.entities) {
+            entities.push_back(p_registry.entity(desc.name.c_str()));
+        }
+
+        std::vector<flecs::entity> groups;
+        if(p_settings.group_size != 0) {
+            for(uint32_t i = 0; i < entities.size(); i += p_settings.group_size) {
+                groups.push_back(p_registry.entity(("Group " + std::to_string(groups.size())).c_str()));
+            }
+        }
+
+        // same batching as binary_scene::apply, every entity moves tables once
+        p_registry.defer_begin();
+        for(flecs::entity group : groups) {
+            group.set<atlas::transform>({});
+        }
+
+        for(uint32_t i = 0; i < entities.size(); i++) {
+            const scene_entity_desc& desc = document.entities[i];
+            flecs::entity entity = entities[i];
+            entity.add<atlas::tag::serialize>();
+
+            atlas::transform transform{};
+            transform.position = desc.transform->position;
+            transform.rotation = desc.transform->rotation;
+            transform.scale = desc.transform->scale;
+            transform.quaternion = desc.transform->quaternion;
+            entity.set<atlas::transform>(transform);
+
+            entity.set<atlas::material>({
+              .color = desc.material->color,
+              .model_path = desc.material->model_path,
+              .texture_path = desc.material->texture_path,
+            });
+
+            atlas::physics_body body{};
+            body.center_mass_position = desc.physics_body->center_mass_position;
+            body.friction = desc.physics_body->friction;
+            body.restitution = desc.physics_body->restitution;
+            body.body_movement_type = static_cast<decltype(body.body_movement_type)>(desc.physics_body->body_movement_type);
+            body.body_layer_type = static_cast<decltype(body.body_layer_type)>(desc.physics_body->body_layer_type);
+            entity.set<atlas::physics_body>(body);
+
+            if(desc.sphere_collider) {
+                entity.set<atlas::sphere_collider>({ .radius = desc.sphere_collider->radius });
+            }
+            else if(desc.box_collider) {
+                entity.set<atlas::box_collider>({ .half_extent = desc.box_collider->half_extent });
+            }
+
+            if(!groups.empty()) {
+                entity.child_of(groups[i / p_settings.group_size]);
+            }
+        }
+        p_registry.defer_end();
+
+        return entities;
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <flecs.h>
+#include <scene_document.hpp>
+
+/**
+ * @brief Procedural scenes shared by the benchmark cases
+ *
+ * Entities are laid out on a grid like the level's props: a mix of static
+ * boxes and dynamic spheres and boxes with materials pointing at the
+ * bundled models. The same settings always produce the same scene so runs
+ * on different commits measure the same work.
+ */
+namespace bench {
+    struct scene_generator_settings {
+        uint32_t entity_count = 1'000;
+        //! seeds the shape, body type and material picks
+        uint32_t seed = 1;
+        //! share of entities with a dynamic physics body, the rest are static
+        float dynamic_fraction = 0.5f;
+        //! when non-zero entities are parented in groups of this size under "Group <n>" entities
+        uint32_t group_size = 0;
+        //! grid spacing in world units
+        float spacing = 2.f;
+    };
+
+    //! @brief Builds the scene as a document, ready to be written as YAML or binary
+    scene_document generate_scene(const scene_generator_settings& p_settings);
+
+    /**
+     * @brief Creates the generated scene straight in p_registry
+     *
+     * Group entities only get a transform, every other entity gets the same
+     * components generate_scene() describes.
+     *
+     * @return the generated (non-group) entities in generation order
+     */
+    std::vector<flecs::entity> spawn_scene(flecs::world& p_registry, const scene_generator_settings& p_settings);
+}
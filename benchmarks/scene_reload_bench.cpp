@@ -0,0 +1,87 @@
+#include "benchmark.hpp"
+#include "scene_generator.hpp"
+#include <binary_scene.hpp>
+#include <scene_document.hpp>
+#include <scene_reload.hpp>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+/**
+ * Hot reload of a generated 100k-entity scene after a one-line edit (one
+ * entity's friction), against the same file saved unchanged. The full
+ * reload a stop/start does is scene_format/yaml_parse/100000 plus
+ * scene_format/binary_load/100000.
+ */
+
+namespace {
+    constexpr uint32_t s_entity_count = 100'000;
+
+    struct reload_fixture {
+        std::filesystem::path path;
+        std::string original;
+        std::string edited;
+        std::unique_ptr<flecs::world> registry;
+        scene_reloader reloader;
+    };
+
+    void write_text(const std::filesystem::path& p_path, const std::string& p_text) {
+        std::ofstream file(p_path, std::ios::binary);
+        file.write(p_text.data(), static_cast<std::streamsize>(p_text.size()));
+    }
+
+    std::unique_ptr<reload_fixture> make_fixture() {
+        auto fixture = std::make_unique<reload_fixture>();
+        auto directory = std::filesystem::temp_directory_path() / "game-template-bench";
+        std::filesystem::create_directories(directory);
+        fixture->path = directory / "reload_scene.yaml";
+
+        scene_document document = bench::generate_scene({ .entity_count = s_entity_count });
+        write_yaml_scene(fixture->path, document);
+        auto binary = directory / "reload_scene.bin";
+        write_binary_scene(binary, document);
+
+        std::ifstream file(fixture->path, std::ios::binary);
+        fixture->original.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+        // one line in the middle of the file, the entity's friction
+        fixture->edited = fixture->original;
+        size_t entity = fixture->edited.find("Entity: Entity " + std::to_string(s_entity_count / 2) + "\n");
+        size_t line = fixture->edited.find("Friction: ", entity);
+        fixture->edited.insert(line + std::string_view("Friction: ").size(), "1");
+
+        fixture->registry = std::make_unique<flecs::world>();
+        binary_scene(binary).apply(*fixture->registry);
+        fixture->reloader.track(fixture->path);
+        return fixture;
+    }
+
+    [[maybe_unused]] const bool s_registered = []() {
+        bench::registrar("scene_reload/one_line/100000", [](bench::state& p_state) {
+            auto fixture = make_fixture();
+            bool edited = false;
+            scene_patch patch;
+            // every iteration flips the line, so each reload has exactly one entity to patch
+            p_state.measure([&]() {
+                                edited = !edited;
+                                write_text(fixture->path, edited ? fixture->edited : fixture->original);
+                            },
+                            [&]() {
+                                fixture->reloader.reload(*fixture->registry, patch);
+                                bench::do_not_optimize(patch.components);
+                            });
+            p_state.set_counter("components patched", patch.components);
+        }, 10);
+
+        bench::registrar("scene_reload/unchanged/100000", [](bench::state& p_state) {
+            auto fixture = make_fixture();
+            scene_patch patch;
+            p_state.measure([&]() { write_text(fixture->path, fixture->original); },
+                            [&]() {
+                                fixture->reloader.reload(*fixture->registry, patch);
+                                bench::do_not_optimize(patch.components);
+                            });
+        }, 10);
+        return true;
+    }();
+}
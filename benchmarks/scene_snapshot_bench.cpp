@@ -0,0 +1,51 @@
+#include "benchmark.hpp"
+#include "scene_generator.hpp"
+#include <scene_snapshot.hpp>
+#include <memory>
+
+/**
+ * Measures a play/stop cycle: capturing the serialized entities and restoring
+ * them after a fraction of them moved.
+ */
+
+namespace {
+    std::unique_ptr<flecs::world> make_world(uint32_t p_entity_count) {
+        auto registry = std::make_unique<flecs::world>();
+        bench::spawn_scene(*registry, { .entity_count = p_entity_count });
+        return registry;
+    }
+
+    //! moves every tenth entity, roughly what a short play session does
+    void simulate_play(flecs::world& p_registry) {
+        uint32_t index = 0;
+        p_registry.query_builder<atlas::transform>().build().each([&](flecs::entity, atlas::transform& p_transform) {
+            if(index++ % 10 == 0) {
+                p_transform.position.y += 1.f;
+            }
+        });
+    }
+
+    void register_snapshot_cases(uint32_t p_entity_count) {
+        std::string suffix = "/" + std::to_string(p_entity_count);
+
+        bench::registrar("scene_snapshot/capture" + suffix, [p_entity_count](bench::state& p_state) {
+            auto registry = make_world(p_entity_count);
+            scene_snapshot snapshot;
+            p_state.measure([&]() { snapshot.capture(*registry); });
+        });
+
+        bench::registrar("scene_snapshot/restore" + suffix, [p_entity_count](bench::state& p_state) {
+            auto registry = make_world(p_entity_count);
+            scene_snapshot snapshot;
+            snapshot.capture(*registry);
+            p_state.measure([&]() { simulate_play(*registry); },
+                            [&]() { bench::do_not_optimize(snapshot.restore(*registry)); });
+        });
+    }
+
+    [[maybe_unused]] const bool s_registered = []() {
+        register_snapshot_cases(100);
+        register_snapshot_cases(10'000);
+        return true;
+    }();
+}
@@ -0,0 +1,233 @@
+#include "benchmark.hpp"
+#include <spatial_hash.hpp>
+#include <algorithm>
+#include <random>
+#include <string>
+
+/**
+ * 10k entities scattered over a 200 x 200 area, queried from 1k points the
+ * way trigger checks run: radius 5 (the charger trigger distance) and the 8
+ * nearest neighbours. Each query shape runs as a brute-force scan over every
+ * position and through spatial_hash. The sync case moves a tenth of the
+ * entities per step and measures keeping the hash up to date from flecs.
+ *
+ * The validate case inserts, moves and erases 3k points, then checks radius,
+ * AABB and 8-nearest answers against brute force and reports the number of
+ * queries that disagree as its mismatches counter. Any mismatch fails the
+ * case.
+ */
+
+namespace {
+    constexpr uint32_t s_entity_count = 10'000;
+    constexpr uint32_t s_query_count = 1'000;
+    constexpr float s_radius = 5.f;
+    constexpr uint32_t s_nearest = 8;
+    constexpr uint32_t s_validate_count = 3'000;
+
+    std::vector<glm::vec3> scatter(uint32_t p_count, uint32_t p_seed) {
+        std::mt19937 random(p_seed);
+        std::uniform_real_distribution<float> across(-100.f, 100.f);
+        std::uniform_real_distribution<float> height(0.f, 2.f);
+        std::vector<glm::vec3> positions(p_count);
+        for(glm::vec3& position : positions) {
+            position = glm::vec3(across(random), height(random), across(random));
+        }
+        return positions;
+    }
+
+    [[maybe_unused]] const bool s_registered = []() {
+        std::string suffix = "/" + std::to_string(s_entity_count);
+
+        bench::registrar("spatial/radius_brute_force" + suffix, [](bench::state& p_state) {
+            auto positions = scatter(s_entity_count, 1);
+            auto queries = scatter(s_query_count, 2);
+            std::vector<flecs::entity_t> found;
+
+            p_state.measure([&]() {
+                found.clear();
+                for(const glm::vec3& center : queries) {
+                    for(uint32_t i = 0; i < s_entity_count; i++) {
+                        glm::vec3 offset = positions[i] - center;
+                        if(glm::dot(offset, offset) <= s_radius * s_radius) {
+                            found.push_back(i + 1);
+                        }
+                    }
+                }
+            });
+            p_state.set_counter("hits", static_cast<double>(found.size()));
+        });
+
+        bench::registrar("spatial/radius_hash" + suffix, [](bench::state& p_state) {
+            auto positions = scatter(s_entity_count, 1);
+            auto queries = scatter(s_query_count, 2);
+            spatial_hash hash(s_radius);
+            for(uint32_t i = 0; i < s_entity_count; i++) {
+                hash.insert(i + 1, positions[i]);
+            }
+            std::vector<flecs::entity_t> found;
+
+            p_state.measure([&]() {
+                found.clear();
+                for(const glm::vec3& center : queries) {
+                    hash.query_radius(center, s_radius, found);
+                }
+            });
+            p_state.set_counter("hits", static_cast<double>(found.size()));
+        });
+
+        bench::registrar("spatial/nearest_brute_force" + suffix, [](bench::state& p_state) {
+            auto positions = scatter(s_entity_count, 1);
+            auto queries = scatter(s_query_count, 2);
+            std::vector<std::pair<float, uint32_t>> candidates(s_entity_count);
+            uint64_t checksum = 0;
+
+            p_state.measure([&]() {
+                for(const glm::vec3& center : queries) {
+                    for(uint32_t i = 0; i < s_entity_count; i++) {
+                        glm::vec3 offset = positions[i] - center;
+                        candidates[i] = { glm::dot(offset, offset), i + 1 };
+                    }
+                    std::partial_sort(candidates.begin(), candidates.begin() + s_nearest, candidates.end());
+                    checksum += candidates.front().second;
+                }
+            });
+            bench::do_not_optimize(checksum);
+        });
+
+        bench::registrar("spatial/nearest_hash" + suffix, [](bench::state& p_state) {
+            auto positions = scatter(s_entity_count, 1);
+            auto queries = scatter(s_query_count, 2);
+            spatial_hash hash(s_radius);
+            for(uint32_t i = 0; i < s_entity_count; i++) {
+                hash.insert(i + 1, positions[i]);
+            }
+            std::vector<flecs::entity_t> found;
+            uint64_t checksum = 0;
+
+            p_state.measure([&]() {
+                for(const glm::vec3& center : queries) {
+                    found.clear();
+                    hash.query_nearest(center, s_nearest, found);
+                    checksum += found.front();
+                }
+            });
+            bench::do_not_optimize(checksum);
+        });
+
+        bench::registrar("spatial/sync" + suffix, [](bench::state& p_state) {
+            flecs::world registry;
+            spatial_hash hash(s_radius);
+            hash.attach(registry);
+
+            auto positions = scatter(s_entity_count, 1);
+            std::vector<flecs::entity> entities;
+            entities.reserve(s_entity_count);
+            for(const glm::vec3& position : positions) {
+                entities.push_back(registry.entity().set<atlas::transform>({ .position = position }).add<spatial_indexed>());
+            }
+            hash.sync(registry);
+
+            auto targets = scatter(s_entity_count, 3);
+            uint32_t step = 0;
+            p_state.measure(
+              [&]() {
+                  // a tenth of the entities move a bit towards a new spot, some cross cells
+                  for(uint32_t i = step % 10; i < s_entity_count; i += 10) {
+                      atlas::transform* transform = entities[i].get_mut<atlas::transform>();
+                      transform->position += (targets[i] - transform->position) * 0.05f;
+                      entities[i].modified<atlas::transform>();
+                  }
+                  step++;
+              },
+              [&]() { hash.sync(registry); });
+
+            hash.detach();
+        });
+
+        bench::registrar("spatial/validate/" + std::to_string(s_validate_count), [](bench::state& p_state) {
+            // entity ids are index + 1, erased ones get a zero position in alive
+            auto positions = scatter(s_validate_count, 4);
+            auto moves = scatter(s_validate_count, 5);
+            auto queries = scatter(200, 6);
+            std::vector<bool> alive(s_validate_count, true);
+            std::vector<uint32_t> slots(s_validate_count);
+            uint32_t mismatches = 0;
+
+            p_state.measure([&]() {
+                spatial_hash hash(s_radius);
+                for(uint32_t i = 0; i < s_validate_count; i++) {
+                    slots[i] = hash.insert(i + 1, positions[i]);
+                }
+                for(uint32_t i = 0; i < s_validate_count; i += 3) {
+                    positions[i] = moves[i];
+                    hash.move(slots[i], positions[i]);
+                }
+                for(uint32_t i = 1; i < s_validate_count; i += 7) {
+                    flecs::entity_t moved = hash.erase(slots[i]);
+                    if(moved != 0) {
+                        slots[moved - 1] = slots[i];
+                    }
+                    alive[i] = false;
+                }
+
+                std::vector<flecs::entity_t> found;
+                std::vector<flecs::entity_t> expected;
+                auto compare = [&]() {
+                    std::sort(found.begin(), found.end());
+                    std::sort(expected.begin(), expected.end());
+                    mismatches += found != expected ? 1 : 0;
+                    found.clear();
+                    expected.clear();
+                };
+
+                for(const glm::vec3& center : queries) {
+                    hash.query_radius(center, s_radius, found);
+                    for(uint32_t i = 0; i < s_validate_count; i++) {
+                        glm::vec3 offset = positions[i] - center;
+                        if(alive[i] and glm::dot(offset, offset) <= s_radius * s_radius) {
+                            expected.push_back(i + 1);
+                        }
+                    }
+                    compare();
+
+                    glm::vec3 min = center - glm::vec3(7.f, 1.f, 3.f);
+                    glm::vec3 max = center + glm::vec3(7.f, 1.f, 3.f);
+                    hash.query_aabb(min, max, found);
+                    for(uint32_t i = 0; i < s_validate_count; i++) {
+                        const glm::vec3& position = positions[i];
+                        if(alive[i] and position.x >= min.x and position.y >= min.y and position.z >= min.z and position.x <= max.x and
+                           position.y <= max.y and position.z <= max.z) {
+                            expected.push_back(i + 1);
+                        }
+                    }
+                    compare();
+
+                    // ties can come back in either order, so the distances are compared, not the ids
+                    hash.query_nearest(center, s_nearest, found);
+                    std::vector<float> found_distances;
+                    for(flecs::entity_t id : found) {
+                        glm::vec3 offset = positions[id - 1] - center;
+                        found_distances.push_back(glm::dot(offset, offset));
+                    }
+                    std::vector<float> expected_distances;
+                    for(uint32_t i = 0; i < s_validate_count; i++) {
+                        if(alive[i]) {
+                            glm::vec3 offset = positions[i] - center;
+                            expected_distances.push_back(glm::dot(offset, offset));
+                        }
+                    }
+                    std::sort(expected_distances.begin(), expected_distances.end());
+                    expected_distances.resize(std::min<size_t>(s_nearest, expected_distances.size()));
+                    mismatches += found_distances != expected_distances ? 1 : 0;
+                    found.clear();
+                }
+            });
+            p_state.set_counter("mismatches", mismatches);
+            if(mismatches != 0) {
+                p_state.fail(std::to_string(mismatches) + " queries disagree with brute force");
+            }
+        }, 1);
+
+        return true;
+    }();
+}
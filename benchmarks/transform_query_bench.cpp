@@ -0,0 +1,73 @@
+#include "benchmark.hpp"
+#include "scene_generator.hpp"
+#include <memory>
+#include <core/scene/components.hpp>
+#include <physics/components.hpp>
+
+/**
+ * Integrates transform positions from physics_body velocities over a
+ * generated scene of 10k and 100k entities, the access pattern of the
+ * physics interpolation passes. Compares building the query on every call
+ * (what fixed_timestep.cpp does today) against a cached query iterated with
+ * each() and with run() over whole tables.
+ */
+
+namespace {
+    constexpr float s_step = 1.f / 60.f;
+
+    std::unique_ptr<flecs::world> make_world(uint32_t p_entity_count) {
+        auto registry = std::make_unique<flecs::world>();
+        bench::spawn_scene(*registry, { .entity_count = p_entity_count });
+        registry->query_builder<atlas::physics_body>().build().each([](flecs::entity p_entity, atlas::physics_body& p_body) {
+            p_body.linear_velocity = { 0.f, -static_cast<float>(p_entity.id() % 7), 0.f };
+        });
+        return registry;
+    }
+
+    void integrate(atlas::transform& p_transform, const atlas::physics_body& p_body) {
+        p_transform.position += p_body.linear_velocity * s_step;
+    }
+
+    void register_query_cases(uint32_t p_entity_count) {
+        std::string suffix = "/" + std::to_string(p_entity_count);
+
+        bench::registrar("transform_query/built_per_call" + suffix, [p_entity_count](bench::state& p_state) {
+            auto registry = make_world(p_entity_count);
+            p_state.measure([&]() {
+                registry->query_builder<atlas::transform, const atlas::physics_body>().build().each(
+                  [](flecs::entity, atlas::transform& p_transform, const atlas::physics_body& p_body) { integrate(p_transform, p_body); });
+            });
+        }, 20);
+
+        bench::registrar("transform_query/cached_each" + suffix, [p_entity_count](bench::state& p_state) {
+            auto registry = make_world(p_entity_count);
+            auto query = registry->query_builder<atlas::transform, const atlas::physics_body>().cached().build();
+            p_state.measure([&]() {
+                query.each([](flecs::entity, atlas::transform& p_transform, const atlas::physics_body& p_body) { integrate(p_transform, p_body); });
+            });
+        }, 20);
+
+        bench::registrar("transform_query/cached_run" + suffix, [p_entity_count](bench::state& p_state) {
+            auto registry = make_world(p_entity_count);
+            auto query = registry->query_builder<atlas::transform, const atlas::physics_body>().cached().build();
+            p_state.measure([&]() {
+                query.run([](flecs::iter& p_it) {
+                    while(p_it.next()) {
+                        auto transforms = p_it.field<atlas::transform>(0);
+                        auto bodies = p_it.field<const atlas::physics_body>(1);
+                        auto count = static_cast<uint32_t>(p_it.count());
+                        for(uint32_t i = 0; i < count; i++) {
+                            integrate(transforms[i], bodies[i]);
+                        }
+                    }
+                });
+            });
+        }, 20);
+    }
+
+    [[maybe_unused]] const bool s_registered = []() {
+        register_query_cases(10'000);
+        register_query_cases(100'000);
+        return true;
+    }();
+}
@@ -0,0 +1,110 @@
+#include "benchmark.hpp"
+#include "scene_generator.hpp"
+#include <visibility.hpp>
+#include <cmath>
+#include <memory>
+#include <string>
+
+/**
+ * Frustum culling a generated 100k-entity scene from the middle of the
+ * grid, looking along +x with the level's camera settings (45 degrees, far
+ * plane 5000). The BVH walk is compared against testing every entity's box
+ * in turn, both with the same SIMD plane test. The sync cases measure
+ * keeping the tree up to date when nothing moved, which refits no leaf,
+ * and when a tenth of the entities moved by more than the fat-box margin.
+ */
+
+namespace {
+    constexpr uint32_t s_entity_count = 100'000;
+    constexpr float s_aspect = 16.f / 9.f;
+
+    struct cull_fixture {
+        std::unique_ptr<flecs::world> registry;
+        visibility_system visibility;
+        atlas::transform camera_transform;
+        atlas::perspective_camera camera;
+    };
+
+    std::unique_ptr<cull_fixture> make_fixture() {
+        auto fixture = std::make_unique<cull_fixture>();
+        fixture->registry = std::make_unique<flecs::world>();
+        bench::spawn_scene(*fixture->registry, { .entity_count = s_entity_count });
+        fixture->visibility.attach(*fixture->registry);
+        fixture->visibility.sync(*fixture->registry);
+
+        // the generator lays entities on a square grid, this is its center
+        float half_extent = std::ceil(std::sqrt(static_cast<float>(s_entity_count))) * 2.f * 0.5f;
+        fixture->camera_transform.position = { half_extent, 20.f, half_extent };
+        // yaw of -90 degrees turns the default -z view towards +x
+        float yaw = glm::radians(-90.f);
+        fixture->camera_transform.quaternion = { 0.f, std::sin(yaw * 0.5f), 0.f, std::cos(yaw * 0.5f) };
+        fixture->camera.plane = { 0.1f, 5000.f };
+        fixture->camera.field_of_view = 45.f;
+        return fixture;
+    }
+
+    void set_cull_counters(bench::state& p_state, const visibility_system& p_visibility) {
+        const visibility_system::frame_stats& stats = p_visibility.stats();
+        p_state.set_counter("visible", stats.visible);
+        for(uint32_t lod = 0; lod < visibility_system::lod_count; lod++) {
+            p_state.set_counter("lod " + std::to_string(lod), stats.per_lod[lod]);
+        }
+    }
+
+    [[maybe_unused]] const bool s_registered = []() {
+        std::string suffix = "/" + std::to_string(s_entity_count);
+
+        bench::registrar("visibility/cull_bvh" + suffix, [](bench::state& p_state) {
+            auto fixture = make_fixture();
+            p_state.measure([&]() {
+                auto visible = fixture->visibility.cull(fixture->camera_transform, fixture->camera, s_aspect);
+                bench::do_not_optimize(visible.size());
+            });
+            set_cull_counters(p_state, fixture->visibility);
+            p_state.set_counter("tree height", fixture->visibility.tree().height());
+        });
+
+        bench::registrar("visibility/cull_linear" + suffix, [](bench::state& p_state) {
+            auto fixture = make_fixture();
+            auto query = fixture->registry->query_builder<const visibility_proxy>().build();
+            const bounds_tree& tree = fixture->visibility.tree();
+            std::vector<flecs::entity_t> visible;
+            p_state.measure([&]() {
+                visible.clear();
+                frustum planes = frustum::from_camera(fixture->camera_transform, fixture->camera, s_aspect);
+                query.each([&](flecs::entity p_entity, const visibility_proxy& p_proxy) {
+                    if(planes.classify(tree.fat_bounds(p_proxy.leaf)) != frustum::result::outside) {
+                        visible.push_back(p_entity.id());
+                    }
+                });
+            });
+            p_state.set_counter("visible", static_cast<double>(visible.size()));
+        });
+
+        bench::registrar("visibility/sync_static" + suffix, [](bench::state& p_state) {
+            auto fixture = make_fixture();
+            p_state.measure([&]() { fixture->visibility.sync(*fixture->registry); });
+            p_state.set_counter("refitted", fixture->visibility.stats().refitted);
+            p_state.set_counter("reinserted", fixture->visibility.stats().reinserted);
+        });
+
+        bench::registrar("visibility/sync_moving" + suffix, [](bench::state& p_state) {
+            auto fixture = make_fixture();
+            auto query = fixture->registry->query_builder<atlas::transform, const visibility_proxy>().build();
+            float direction = 1.f;
+            p_state.measure([&]() {
+                                // every tenth entity steps a whole grid cell, out of its fat box
+                                direction = -direction;
+                                query.each([&](flecs::entity p_entity, atlas::transform& p_transform, const visibility_proxy&) {
+                                    if(p_entity.id() % 10 == 0) {
+                                        p_transform.position.x += direction * 2.f;
+                                    }
+                                });
+                            },
+                            [&]() { fixture->visibility.sync(*fixture->registry); });
+            p_state.set_counter("refitted", fixture->visibility.stats().refitted);
+            p_state.set_counter("reinserted", fixture->visibility.stats().reinserted);
+        });
+        return true;
+    }();
+}
@@ -0,0 +1,522 @@
+#include "binary_scene.hpp"
+#include <core/engine_logger.hpp>
+#include <core/scene/components.hpp>
+#include <physics/components.hpp>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+
+namespace {
+    uint64_t align_up(uint64_t p_value, uint64_t p_alignment) {
+        return (p_value + p_alignment - 1) & ~(p_alignment - 1);
+    }
+
+    //! deduplicates every string written into the scene
+    class string_table_builder {
+    public:
+        uint32_t add(const std::string& p_value) {
+            auto it = m_offsets.find(p_value);
+            if(it != m_offsets.end()) {
+                return it->second;
+            }
+
+            uint32_t offset = static_cast<uint32_t>(m_data.size());
+            m_data.insert(m_data.end(), p_value.begin(), p_value.end());
+            m_data.push_back('\0');
+            m_offsets.emplace(p_value, offset);
+            return offset;
+        }
+
+        [[nodiscard]] const std::vector<char>& data() const { return m_data; }
+
+    private:
+        std::vector<char> m_data;
+        std::unordered_map<std::string, uint32_t> m_offsets;
+    };
+
+    struct pending_section {
+        scene_format::component_id id;
+        uint32_t stride;
+        std::vector<uint32_t> entities;
+        std::vector<std::byte> records;
+    };
+
+    template<typename T>
+    void push_record(pending_section& p_section, uint32_t p_entity, const T& p_record) {
+        const auto* bytes = reinterpret_cast<const std::byte*>(&p_record);
+        p_section.entities.push_back(p_entity);
+        p_section.records.insert(p_section.records.end(), bytes, bytes + sizeof(T));
+    }
+
+    template<typename T>
+    pending_section make_section() {
+        return { scene_format::record_traits<T>::id, sizeof(T), {}, {} };
+    }
+
+    template<typename T>
+    void write_at(std::vector<std::byte>& p_buffer, uint64_t p_offset, const T* p_data, size_t p_count) {
+        std::memcpy(p_buffer.data() + p_offset, p_data, sizeof(T) * p_count);
+    }
+
+    template<typename T, typename Fn>
+    void for_each_record(const binary_scene& p_scene, Fn&& p_callback) {
+        auto section = p_scene.get_section<T>();
+        for(size_t i = 0; i < section.records.size(); i++) {
+            p_callback(section.entities[i], section.records[i]);
+        }
+    }
+}
+
+binary_scene::binary_scene(const std::filesystem::path& p_path) : m_file(p_path) {
+    if(!m_file.is_open()) {
+        return;
+    }
+
+    if(!validate()) {
+        console_log_error("{} is not a valid binary scene", p_path.string());
+        m_header = nullptr;
+        m_file.close();
+    }
+}
+
+bool binary_scene::validate() {
+    const size_t file_size = m_file.size();
+    const std::byte* base = m_file.data();
+
+    if(file_size < sizeof(scene_format::file_header)) {
+        return false;
+    }
+
+    const auto* header = reinterpret_cast<const scene_format::file_header*>(base);
+    if(header->magic != scene_format::magic or header->version_major != scene_format::version_major) {
+        return false;
+    }
+
+    auto in_bounds = [file_size](uint64_t p_offset, uint64_t p_size) {
+        return p_offset <= file_size and p_size <= file_size - p_offset;
+    };
+
+    if(!in_bounds(header->entity_table_offset, uint64_t(header->entity_count) * sizeof(scene_format::entity_entry)) or
+       !in_bounds(header->section_table_offset, uint64_t(header->section_count) * sizeof(scene_format::section_entry)) or
+       !in_bounds(header->string_table_offset, header->string_table_size)) {
+        return false;
+    }
+
+    // every string must be terminated inside of the table
+    m_strings = { reinterpret_cast<const char*>(base + header->string_table_offset), header->string_table_size };
+    if(!m_strings.empty() and m_strings.back() != '\0') {
+        return false;
+    }
+
+    m_entities = { reinterpret_cast<const scene_format::entity_entry*>(base + header->entity_table_offset), header->entity_count };
+    m_sections = { reinterpret_cast<const scene_format::section_entry*>(base + header->section_table_offset), header->section_count };
+
+    for(const auto& entity : m_entities) {
+        if(entity.name >= m_strings.size()) {
+            return false;
+        }
+    }
+
+    for(const auto& section : m_sections) {
+        if(section.index_offset % alignof(uint32_t) != 0 or section.record_offset % alignof(float) != 0 or
+           !in_bounds(section.index_offset, uint64_t(section.count) * sizeof(uint32_t)) or
+           !in_bounds(section.record_offset, uint64_t(section.count) * section.stride)) {
+            return false;
+        }
+
+        const auto* indices = reinterpret_cast<const uint32_t*>(base + section.index_offset);
+        for(uint32_t i = 0; i < section.count; i++) {
+            if(indices[i] >= header->entity_count) {
+                return false;
+            }
+        }
+    }
+
+    m_header = header;
+    return true;
+}
+
+const char* binary_scene::string(uint32_t p_offset) const {
+    if(p_offset == scene_format::no_string or p_offset >= m_strings.size()) {
+        return "";
+    }
+    return m_strings.data() + p_offset;
+}
+
+void set_scene_component(flecs::entity p_entity, const scene_format::transform_record& p_record) {
+    atlas::transform transform{};
+    transform.position = p_record.position;
+    transform.rotation = p_record.rotation;
+    transform.scale = p_record.scale;
+    transform.quaternion = p_record.quaternion;
+    p_entity.set<atlas::transform>(transform);
+}
+
+void set_scene_component(flecs::entity p_entity, const scene_format::perspective_camera_record& p_record) {
+    p_entity.set<atlas::perspective_camera>({
+        .plane = p_record.plane,
+        .is_active = p_record.is_active != 0,
+        .field_of_view = p_record.field_of_view,
+    });
+}
+
+void set_scene_component(flecs::entity p_entity, const scene_material_desc& p_material) {
+    p_entity.set<atlas::material>({
+        .color = p_material.color,
+        .model_path = p_material.model_path,
+        .texture_path = p_material.texture_path,
+    });
+}
+
+void set_scene_component(flecs::entity p_entity, const scene_format::physics_body_record& p_record) {
+    atlas::physics_body body{};
+    body.linear_velocity = p_record.linear_velocity;
+    body.angular_velocity = p_record.angular_velocity;
+    body.cumulative_force = p_record.cumulative_force;
+    body.cumulative_torque = p_record.cumulative_torque;
+    body.mass_factor = p_record.mass_factor;
+    body.center_mass_position = p_record.center_mass_position;
+    body.friction = p_record.friction;
+    body.restitution = p_record.restitution;
+    body.body_movement_type = static_cast<decltype(body.body_movement_type)>(p_record.body_movement_type);
+    body.body_layer_type = static_cast<decltype(body.body_layer_type)>(p_record.body_layer_type);
+    p_entity.set<atlas::physics_body>(body);
+}
+
+void set_scene_component(flecs::entity p_entity, const scene_format::box_collider_record& p_record) {
+    p_entity.set<atlas::box_collider>({
+        .half_extent = p_record.half_extent,
+    });
+}
+
+void set_scene_component(flecs::entity p_entity, const scene_format::sphere_collider_record& p_record) {
+    p_entity.set<atlas::sphere_collider>({
+        .radius = p_record.radius,
+    });
+}
+
+void set_scene_component(flecs::entity p_entity, const scene_format::capsule_collider_record& p_record) {
+    p_entity.set<atlas::capsule_collider>({
+        .half_height = p_record.half_height,
+        .radius = p_record.radius,
+    });
+}
+
+std::vector<flecs::entity> binary_scene::apply(flecs::world& p_registry) const {
+    std::vector<flecs::entity> entities;
+    if(!is_valid()) {
+        return entities;
+    }
+
+    // Entities are created (or looked up by name) before deferring so handles
+    // are valid; all component writes are then batched so each entity only
+    // moves tables once when defer_end() flushes.
+    entities.reserve(entity_count());
+    for(uint32_t i = 0; i < entity_count(); i++) {
+        entities.push_back(p_registry.entity(entity_name(i)));
+    }
+
+    p_registry.defer_begin();
+
+    for(uint32_t i = 0; i < entity_count(); i++) {
+        if(entity_flags(i) & scene_format::entity_serialize) {
+            entities[i].add<atlas::tag::serialize>();
+        }
+    }
+
+    for_each_record<scene_format::transform_record>(*this, [&](uint32_t p_index, const scene_format::transform_record& p_record) {
+        set_scene_component(entities[p_index], p_record);
+    });
+
+    for_each_record<scene_format::perspective_camera_record>(*this, [&](uint32_t p_index, const scene_format::perspective_camera_record& p_record) {
+        set_scene_component(entities[p_index], p_record);
+    });
+
+    for_each_record<scene_format::material_record>(*this, [&](uint32_t p_index, const scene_format::material_record& p_record) {
+        entities[p_index].set<atlas::material>({
+            .color = p_record.color,
+            .model_path = string(p_record.model_path),
+            .texture_path = string(p_record.texture_path),
+        });
+    });
+
+    for_each_record<scene_format::physics_body_record>(*this, [&](uint32_t p_index, const scene_format::physics_body_record& p_record) {
+        set_scene_component(entities[p_index], p_record);
+    });
+
+    for_each_record<scene_format::box_collider_record>(*this, [&](uint32_t p_index, const scene_format::box_collider_record& p_record) {
+        set_scene_component(entities[p_index], p_record);
+    });
+
+    for_each_record<scene_format::sphere_collider_record>(*this, [&](uint32_t p_index, const scene_format::sphere_collider_record& p_record) {
+        set_scene_component(entities[p_index], p_record);
+    });
+
+    for_each_record<scene_format::capsule_collider_record>(*this, [&](uint32_t p_index, const scene_format::capsule_collider_record& p_record) {
+        set_scene_component(entities[p_index], p_record);
+    });
+
+    p_registry.defer_end();
+    return entities;
+}
+
+scene_document binary_scene::to_document() const {
+    scene_document document;
+    if(!is_valid()) {
+        return document;
+    }
+
+    document.name = name();
+    document.entities.resize(entity_count());
+    for(uint32_t i = 0; i < entity_count(); i++) {
+        document.entities[i].name = entity_name(i);
+        document.entities[i].serialize = (entity_flags(i) & scene_format::entity_serialize) != 0;
+    }
+
+    for_each_record<scene_format::transform_record>(*this, [&](uint32_t p_index, const auto& p_record) {
+        document.entities[p_index].transform = p_record;
+    });
+    for_each_record<scene_format::perspective_camera_record>(*this, [&](uint32_t p_index, const auto& p_record) {
+        document.entities[p_index].perspective_camera = p_record;
+    });
+    for_each_record<scene_format::material_record>(*this, [&](uint32_t p_index, const auto& p_record) {
+        document.entities[p_index].material = scene_material_desc{
+            .color = p_record.color,
+            .model_path = string(p_record.model_path),
+            .texture_path = string(p_record.texture_path),
+        };
+    });
+    for_each_record<scene_format::physics_body_record>(*this, [&](uint32_t p_index, const auto& p_record) {
+        document.entities[p_index].physics_body = p_record;
+    });
+    for_each_record<scene_format::box_collider_record>(*this, [&](uint32_t p_index, const auto& p_record) {
+        document.entities[p_index].box_collider = p_record;
+    });
+    for_each_record<scene_format::sphere_collider_record>(*this, [&](uint32_t p_index, const auto& p_record) {
+        document.entities[p_index].sphere_collider = p_record;
+    });
+    for_each_record<scene_format::capsule_collider_record>(*this, [&](uint32_t p_index, const auto& p_record) {
+        document.entities[p_index].capsule_collider = p_record;
+    });
+
+    return document;
+}
+
+scene_document capture_scene_document(flecs::world& p_registry, const std::string& p_name) {
+    scene_document document;
+    document.name = p_name;
+
+    auto query = p_registry.query_builder().with<atlas::tag::serialize>().build();
+    document.entities.reserve(static_cast<size_t>(query.count()));
+    query.each([&](flecs::entity p_entity) {
+        scene_entity_desc entity;
+        entity.name = p_entity.name().c_str();
+
+        if(const auto* transform = p_entity.get<atlas::transform>()) {
+            entity.transform = scene_format::transform_record{
+                .position = transform->position,
+                .rotation = transform->rotation,
+                .scale = transform->scale,
+                .quaternion = transform->quaternion,
+            };
+        }
+        if(const auto* camera = p_entity.get<atlas::perspective_camera>()) {
+            entity.perspective_camera = scene_format::perspective_camera_record{
+                .plane = camera->plane,
+                .field_of_view = camera->field_of_view,
+                .is_active = camera->is_active ? 1u : 0u,
+            };
+        }
+        if(const auto* material = p_entity.get<atlas::material>()) {
+            entity.material = scene_material_desc{
+                .color = material->color,
+                .model_path = material->model_path,
+                .texture_path = material->texture_path,
+            };
+        }
+        if(const auto* body = p_entity.get<atlas::physics_body>()) {
+            entity.physics_body = scene_format::physics_body_record{
+                .linear_velocity = body->linear_velocity,
+                .angular_velocity = body->angular_velocity,
+                .cumulative_force = body->cumulative_force,
+                .cumulative_torque = body->cumulative_torque,
+                .center_mass_position = body->center_mass_position,
+                .mass_factor = body->mass_factor,
+                .friction = body->friction,
+                .restitution = body->restitution,
+                .body_movement_type = static_cast<uint32_t>(body->body_movement_type),
+                .body_layer_type = static_cast<uint32_t>(body->body_layer_type),
+            };
+        }
+        if(const auto* box = p_entity.get<atlas::box_collider>()) {
+            entity.box_collider = scene_format::box_collider_record{ .half_extent = box->half_extent };
+        }
+        if(const auto* sphere = p_entity.get<atlas::sphere_collider>()) {
+            entity.sphere_collider = scene_format::sphere_collider_record{ .radius = sphere->radius };
+        }
+        if(const auto* capsule = p_entity.get<atlas::capsule_collider>()) {
+            entity.capsule_collider = scene_format::capsule_collider_record{ .half_height = capsule->half_height, .radius = capsule->radius };
+        }
+
+        document.entities.push_back(std::move(entity));
+    });
+
+    // query order follows archetype tables, sort so two runs of the same scene line up
+    std::sort(document.entities.begin(), document.entities.end(),
+              [](const scene_entity_desc& p_left, const scene_entity_desc& p_right) { return p_left.name < p_right.name; });
+    return document;
+}
+
+bool write_binary_scene(const std::filesystem::path& p_path, const scene_document& p_document) {
+    string_table_builder strings;
+    std::vector<scene_format::entity_entry> entity_table;
+    entity_table.reserve(p_document.entities.size());
+
+    pending_section transforms = make_section<scene_format::transform_record>();
+    pending_section cameras = make_section<scene_format::perspective_camera_record>();
+    pending_section materials = make_section<scene_format::material_record>();
+    pending_section bodies = make_section<scene_format::physics_body_record>();
+    pending_section boxes = make_section<scene_format::box_collider_record>();
+    pending_section spheres = make_section<scene_format::sphere_collider_record>();
+    pending_section capsules = make_section<scene_format::capsule_collider_record>();
+
+    uint32_t scene_name = strings.add(p_document.name);
+
+    for(uint32_t i = 0; i < p_document.entities.size(); i++) {
+        const scene_entity_desc& entity = p_document.entities[i];
+        entity_table.push_back({
+            .name = strings.add(entity.name),
+            .flags = entity.serialize ? scene_format::entity_serialize : 0u,
+        });
+
+        if(entity.transform) {
+            push_record(transforms, i, *entity.transform);
+        }
+        if(entity.perspective_camera) {
+            push_record(cameras, i, *entity.perspective_camera);
+        }
+        if(entity.material) {
+            push_record(materials, i, scene_format::material_record{
+                .color = entity.material->color,
+                .model_path = entity.material->model_path.empty() ? scene_format::no_string : strings.add(entity.material->model_path),
+                .texture_path = entity.material->texture_path.empty() ? scene_format::no_string : strings.add(entity.material->texture_path),
+            });
+        }
+        if(entity.physics_body) {
+            push_record(bodies, i, *entity.physics_body);
+        }
+        if(entity.box_collider) {
+            push_record(boxes, i, *entity.box_collider);
+        }
+        if(entity.sphere_collider) {
+            push_record(spheres, i, *entity.sphere_collider);
+        }
+        if(entity.capsule_collider) {
+            push_record(capsules, i, *entity.capsule_collider);
+        }
+    }
+
+    std::vector<pending_section*> sections;
+    for(pending_section* section : { &transforms, &cameras, &materials, &bodies, &boxes, &spheres, &capsules }) {
+        if(!section->entities.empty()) {
+            sections.push_back(section);
+        }
+    }
+
+    // computing the layout up front lets us write everything into a single buffer
+    scene_format::file_header header{
+        .magic = scene_format::magic,
+        .version_major = scene_format::version_major,
+        .version_minor = scene_format::version_minor,
+        .entity_count = static_cast<uint32_t>(entity_table.size()),
+        .section_count = static_cast<uint32_t>(sections.size()),
+        .scene_name = scene_name,
+        .reserved = 0,
+    };
+
+    uint64_t offset = sizeof(scene_format::file_header);
+    header.entity_table_offset = offset;
+    offset += entity_table.size() * sizeof(scene_format::entity_entry);
+
+    offset = align_up(offset, alignof(scene_format::section_entry));
+    header.section_table_offset = offset;
+    offset += sections.size() * sizeof(scene_format::section_entry);
+
+    std::vector<scene_format::section_entry> section_table;
+    for(const pending_section* section : sections) {
+        scene_format::section_entry entry{
+            .id = section->id,
+            .stride = section->stride,
+            .count = static_cast<uint32_t>(section->entities.size()),
+            .reserved = 0,
+        };
+        offset = align_up(offset, scene_format::blob_alignment);
+        entry.index_offset = offset;
+        offset += section->entities.size() * sizeof(uint32_t);
+
+        offset = align_up(offset, scene_format::blob_alignment);
+        entry.record_offset = offset;
+        offset += section->records.size();
+        section_table.push_back(entry);
+    }
+
+    header.string_table_offset = offset;
+    header.string_table_size = strings.data().size();
+    offset += strings.data().size();
+
+    std::vector<std::byte> buffer(offset);
+    write_at(buffer, 0, &header, 1);
+    write_at(buffer, header.entity_table_offset, entity_table.data(), entity_table.size());
+    write_at(buffer, header.section_table_offset, section_table.data(), section_table.size());
+    for(size_t i = 0; i < sections.size(); i++) {
+        write_at(buffer, section_table[i].index_offset, sections[i]->entities.data(), sections[i]->entities.size());
+        write_at(buffer, section_table[i].record_offset, sections[i]->records.data(), sections[i]->records.size());
+    }
+    write_at(buffer, header.string_table_offset, strings.data().data(), strings.data().size());
+
+    std::ofstream file(p_path, std::ios::binary | std::ios::trunc);
+    if(!file) {
+        console_log_error("Could not open {} for writing", p_path.string());
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    return static_cast<bool>(file);
+}
+
+bool bake_binary_scene(const std::filesystem::path& p_source, const std::filesystem::path& p_binary) {
+    std::error_code ec;
+    bool has_source = std::filesystem::exists(p_source, ec);
+    bool has_binary = std::filesystem::exists(p_binary, ec);
+
+    if(!has_source) {
+        return has_binary;
+    }
+
+    if(has_binary and std::filesystem::last_write_time(p_binary, ec) >= std::filesystem::last_write_time(p_source, ec)) {
+        return true;
+    }
+
+    scene_document document;
+    if(!read_yaml_scene(p_source, document)) {
+        return false;
+    }
+
+    // write to a temporary first so a half-written file is never mapped
+    std::filesystem::path staging = p_binary;
+    staging += ".tmp";
+    if(!write_binary_scene(staging, document)) {
+        return false;
+    }
+
+    std::filesystem::rename(staging, p_binary, ec);
+    if(ec) {
+        console_log_error("Could not replace {}: {}", p_binary.string(), ec.message());
+        return false;
+    }
+
+    console_log_info("Baked {} into {} ({} entities)", p_source.string(), p_binary.string(), document.entities.size());
+    return true;
+}
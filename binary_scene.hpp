@@ -0,0 +1,103 @@
+#pragma once
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <vector>
+#include <flecs.h>
+#include "mapped_file.hpp"
+#include "scene_document.hpp"
+
+/**
+ * @name binary_scene
+ * @brief Memory-mapped reader for the binary scene format
+ *
+ * Opening a binary_scene only maps the file and validates the header and
+ * section table. Records are read in-place from the mapping, nothing is
+ * parsed or allocated until apply() pushes them into a flecs world.
+ */
+class binary_scene {
+public:
+    template<typename T>
+    struct section {
+        std::span<const uint32_t> entities;
+        std::span<const T> records;
+    };
+
+    binary_scene() = default;
+    binary_scene(const std::filesystem::path& p_path);
+
+    [[nodiscard]] bool is_valid() const { return m_header != nullptr; }
+
+    [[nodiscard]] const char* name() const { return string(m_header->scene_name); }
+
+    [[nodiscard]] uint32_t entity_count() const { return m_header->entity_count; }
+
+    [[nodiscard]] const char* entity_name(uint32_t p_index) const { return string(m_entities[p_index].name); }
+
+    [[nodiscard]] uint32_t entity_flags(uint32_t p_index) const { return m_entities[p_index].flags; }
+
+    //! @return null-terminated string stored in the string table, or "" when p_offset is scene_format::no_string
+    [[nodiscard]] const char* string(uint32_t p_offset) const;
+
+    template<typename T>
+    [[nodiscard]] section<T> get_section() const {
+        for(const auto& entry : m_sections) {
+            if(entry.id == scene_format::record_traits<T>::id and entry.stride == sizeof(T)) {
+                const std::byte* base = m_file.data();
+                return {
+                    { reinterpret_cast<const uint32_t*>(base + entry.index_offset), entry.count },
+                    { reinterpret_cast<const T*>(base + entry.record_offset), entry.count },
+                };
+            }
+        }
+        return {};
+    }
+
+    /**
+     * @brief Creates (or looks up by name) every entity in the scene and sets
+     * its components
+     *
+     * @return entity handles indexed the same way as the file's entity table
+     */
+    std::vector<flecs::entity> apply(flecs::world& p_registry) const;
+
+    //! @brief Expands the mapped scene back into an owning scene_document
+    [[nodiscard]] scene_document to_document() const;
+
+private:
+    bool validate();
+
+private:
+    mapped_file m_file;
+    const scene_format::file_header* m_header=nullptr;
+    std::span<const scene_format::entity_entry> m_entities;
+    std::span<const scene_format::section_entry> m_sections;
+    std::string_view m_strings;
+};
+
+//! @brief Sets the atlas component a scene record describes, shared by binary_scene::apply and the hot reload
+void set_scene_component(flecs::entity p_entity, const scene_format::transform_record& p_record);
+void set_scene_component(flecs::entity p_entity, const scene_format::perspective_camera_record& p_record);
+void set_scene_component(flecs::entity p_entity, const scene_material_desc& p_material);
+void set_scene_component(flecs::entity p_entity, const scene_format::physics_body_record& p_record);
+void set_scene_component(flecs::entity p_entity, const scene_format::box_collider_record& p_record);
+void set_scene_component(flecs::entity p_entity, const scene_format::sphere_collider_record& p_record);
+void set_scene_component(flecs::entity p_entity, const scene_format::capsule_collider_record& p_record);
+
+/**
+ * @brief Builds a scene_document from every serialized entity in p_registry,
+ * sorted by name so documents of the same scene compare line by line
+ */
+scene_document capture_scene_document(flecs::world& p_registry, const std::string& p_name);
+
+//! @brief Serializes p_document into the binary scene format
+bool write_binary_scene(const std::filesystem::path& p_path, const scene_document& p_document);
+
+/**
+ * @brief Converts the YAML scene at p_source into p_binary if the binary file
+ * is missing or older than the source
+ *
+ * @return false when neither an up-to-date binary scene nor a readable YAML
+ * source are available
+ */
+bool bake_binary_scene(const std::filesystem::path& p_source, const std::filesystem::path& p_binary);
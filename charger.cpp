@@ -0,0 +1,135 @@
+#include "charger.hpp"
+#include <cmath>
+#include <limits>
+
+void charger_system::arm(flecs::world& p_registry) {
+    p_registry.query_builder<charger, const atlas::transform>().build().each(
+      [](flecs::entity, charger& p_charger, const atlas::transform& p_transform) {
+          p_charger.state = charger_state::idle;
+          p_charger.has_charged = false;
+          p_charger.respawn_timer = 0.f;
+          p_charger.home = p_transform.position;
+      });
+}
+
+void charger_system::gather(flecs::world& p_registry) {
+    if(m_query_world != p_registry.c_ptr()) {
+        m_chargers_query = p_registry.query_builder<charger, atlas::transform>().build();
+        m_targets_query = p_registry.query_builder<const atlas::transform>().with<charge_target>().build();
+        m_query_world = p_registry.c_ptr();
+    }
+
+    m_entities.clear();
+    m_chargers.clear();
+    m_transforms.clear();
+    m_x.clear();
+    m_y.clear();
+    m_z.clear();
+    m_chargers_query.each([this](flecs::entity p_entity, charger& p_charger, atlas::transform& p_transform) {
+        m_entities.push_back(p_entity.id());
+        m_chargers.push_back(&p_charger);
+        m_transforms.push_back(&p_transform);
+        m_x.push_back(p_transform.position.x);
+        m_y.push_back(p_transform.position.y);
+        m_z.push_back(p_transform.position.z);
+    });
+
+    m_target_x.clear();
+    m_target_y.clear();
+    m_target_z.clear();
+    m_targets_query.each([this](flecs::entity, const atlas::transform& p_transform) {
+        m_target_x.push_back(p_transform.position.x);
+        m_target_y.push_back(p_transform.position.y);
+        m_target_z.push_back(p_transform.position.z);
+    });
+}
+
+void charger_system::find_nearest_targets() {
+    size_t count = m_x.size();
+    m_nearest_distance_squared.assign(count, std::numeric_limits<float>::max());
+    m_nearest_target.assign(count, 0);
+
+    const float* x = m_x.data();
+    const float* y = m_y.data();
+    const float* z = m_z.data();
+    float* nearest = m_nearest_distance_squared.data();
+    uint32_t* nearest_target = m_nearest_target.data();
+
+    // targets outside, chasers inside: the inner loop is contiguous loads and selects
+    for(size_t target = 0; target < m_target_x.size(); target++) {
+        float target_x = m_target_x[target];
+        float target_y = m_target_y[target];
+        float target_z = m_target_z[target];
+        auto index = static_cast<uint32_t>(target);
+
+        for(size_t i = 0; i < count; i++) {
+            float dx = target_x - x[i];
+            float dy = target_y - y[i];
+            float dz = target_z - z[i];
+            float distance_squared = dx * dx + dy * dy + dz * dz;
+            bool closer = distance_squared < nearest[i];
+            nearest[i] = closer ? distance_squared : nearest[i];
+            nearest_target[i] = closer ? index : nearest_target[i];
+        }
+    }
+}
+
+std::span<const charger_event> charger_system::update(flecs::world& p_registry, float p_step) {
+    m_events.clear();
+    gather(p_registry);
+    if(m_chargers.empty()) {
+        return m_events;
+    }
+
+    bool has_targets = !m_target_x.empty();
+    if(has_targets) {
+        find_nearest_targets();
+    }
+
+    for(size_t i = 0; i < m_chargers.size(); i++) {
+        charger& state = *m_chargers[i];
+        glm::vec3& position = m_transforms[i]->position;
+
+        switch(state.state) {
+        case charger_state::idle: {
+            bool armed = !state.charge_once or !state.has_charged;
+            if(has_targets and armed and m_nearest_distance_squared[i] < state.trigger_distance * state.trigger_distance) {
+                state.state = charger_state::charging;
+                state.has_charged = true;
+                m_events.push_back({ m_entities[i], charger_event::kind::started });
+            }
+            break;
+        }
+        case charger_state::charging: {
+            float distance_squared = has_targets ? m_nearest_distance_squared[i] : std::numeric_limits<float>::max();
+            bool missed = distance_squared > state.miss_distance * state.miss_distance;
+            bool hit = distance_squared < state.hit_distance * state.hit_distance;
+            if(missed or hit) {
+                state.state = charger_state::respawning;
+                state.respawn_timer = state.respawn_delay;
+                position = state.home;
+                m_events.push_back({ m_entities[i], hit ? charger_event::kind::hit : charger_event::kind::missed });
+                break;
+            }
+
+            uint32_t target = m_nearest_target[i];
+            glm::vec3 direction(m_target_x[target] - m_x[i], m_target_y[target] - m_y[i], m_target_z[target] - m_z[i]);
+            float distance = std::sqrt(distance_squared);
+            // Avoid division by zero
+            if(distance > 0.1f) {
+                position += direction * (state.speed * p_step / distance);
+            }
+            break;
+        }
+        case charger_state::respawning: {
+            state.respawn_timer -= p_step;
+            if(state.respawn_timer <= 0.f) {
+                state.state = charger_state::idle;
+            }
+            break;
+        }
+        }
+    }
+
+    return m_events;
+}
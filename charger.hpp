@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <flecs.h>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+#include <core/scene/components.hpp>
+
+enum class charger_state : uint8_t {
+    idle,
+    charging,
+    respawning,
+};
+
+/**
+ * @brief Chaser that charges the nearest charge_target once it comes within
+ * trigger_distance and goes back to its home position after a hit or a miss
+ */
+struct charger {
+    float speed = 8.f;
+    float trigger_distance = 5.f;
+    //! a charge that ends up further than this from every target is a miss
+    float miss_distance = 20.f;
+    float hit_distance = 2.f;
+    //! seconds spent at home after a respawn before the charger can trigger again
+    float respawn_delay = 0.f;
+    //! only charge once per run, cleared by charger_system::arm
+    bool charge_once = true;
+
+    charger_state state = charger_state::idle;
+    bool has_charged = false;
+    float respawn_timer = 0.f;
+    glm::vec3 home{ 0.f };
+};
+
+//! Tag for entities chargers go after
+struct charge_target {};
+
+struct charger_event {
+    enum class kind : uint8_t {
+        started,
+        hit,
+        missed,
+    };
+
+    flecs::entity_t entity;
+    kind what;
+};
+
+/**
+ * @name charger_system
+ * @brief Runs the charger state machine for every charger entity in one pass
+ *
+ * Chaser and target positions are copied into structure-of-arrays buffers
+ * once per update. The nearest-target search then loops over chasers in the
+ * inner loop with squared distances and selects instead of branches, so the
+ * compiler vectorizes it and per-chaser cost stays flat as the count grows.
+ * The state machine runs afterwards over the same buffers and moves each
+ * charger by writing straight into its atlas::transform.
+ */
+class charger_system {
+public:
+    //! @brief Resets every charger to idle and makes its current position its home
+    static void arm(flecs::world& p_registry);
+
+    //! @brief Advances every charger by p_step seconds, returns what happened this step
+    std::span<const charger_event> update(flecs::world& p_registry, float p_step);
+
+    [[nodiscard]] size_t charger_count() const { return m_chargers.size(); }
+
+private:
+    void gather(flecs::world& p_registry);
+
+    void find_nearest_targets();
+
+private:
+    flecs::query<charger, atlas::transform> m_chargers_query;
+    flecs::query<const atlas::transform> m_targets_query;
+    flecs::world_t* m_query_world=nullptr;
+
+    // chasers, one entry per charger entity
+    std::vector<flecs::entity_t> m_entities;
+    std::vector<charger*> m_chargers;
+    std::vector<atlas::transform*> m_transforms;
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_z;
+    std::vector<float> m_nearest_distance_squared;
+    std::vector<uint32_t> m_nearest_target;
+
+    // targets
+    std::vector<float> m_target_x;
+    std::vector<float> m_target_y;
+    std::vector<float> m_target_z;
+
+    std::vector<charger_event> m_events;
+};
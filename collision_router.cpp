@@ -0,0 +1,47 @@
+#include "collision_router.hpp"
+
+collision_filter& collision_filter::entity(flecs::entity_t p_entity) {
+    m_entity = p_entity;
+    return *this;
+}
+
+collision_filter& collision_filter::with(flecs::id_t p_id) {
+    m_self_ids.push_back(p_id);
+    return *this;
+}
+
+collision_filter& collision_filter::other_with(flecs::id_t p_id) {
+    m_other_ids.push_back(p_id);
+    return *this;
+}
+
+bool collision_filter::matches(flecs::world& p_registry, flecs::entity_t p_self, flecs::entity_t p_other) const {
+    // cheapest checks first, most events are rejected by the entity compare
+    if(m_entity != 0 and m_entity != p_self) {
+        return false;
+    }
+
+    if(!m_self_ids.empty()) {
+        flecs::entity self = p_registry.entity(p_self);
+        for(flecs::id_t id : m_self_ids) {
+            if(!self.has(id)) {
+                return false;
+            }
+        }
+    }
+
+    if(!m_other_ids.empty()) {
+        flecs::entity other = p_registry.entity(p_other);
+        for(flecs::id_t id : m_other_ids) {
+            if(!other.has(id)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void collision_router::clear() {
+    std::apply([](auto&... p_channels) { (p_channels.clear(), ...); }, m_channels);
+}
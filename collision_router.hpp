@@ -0,0 +1,104 @@
+#pragma once
+#include <functional>
+#include <tuple>
+#include <vector>
+#include <flecs.h>
+#include <core/event/types.hpp>
+
+/**
+ * @brief Pair handed to a filtered collision handler, ordered so that self is
+ * the entity the filter matched and other is the one it collided with
+ */
+struct collision_match {
+    flecs::entity self;
+    flecs::entity other;
+};
+
+/**
+ * @name collision_filter
+ * @brief Describes which collision pairs a handler is interested in
+ *
+ * A pair matches when one of its entities satisfies every self requirement
+ * (a specific entity and/or a set of components, tags or pairs) and the other
+ * entity has every id passed to other_with().
+ *
+ * collision_filter().entity(sphere).other_with(registry.component<atlas::box_collider>());
+ */
+class collision_filter {
+public:
+    collision_filter() = default;
+
+    collision_filter& entity(flecs::entity_t p_entity);
+
+    collision_filter& with(flecs::id_t p_id);
+
+    collision_filter& other_with(flecs::id_t p_id);
+
+    //! @brief Returns true when the filter matches with p_self on the filtered side
+    [[nodiscard]] bool matches(flecs::world& p_registry, flecs::entity_t p_self, flecs::entity_t p_other) const;
+
+private:
+    flecs::entity_t m_entity=0;
+    std::vector<flecs::id_t> m_self_ids;
+    std::vector<flecs::id_t> m_other_ids;
+};
+
+/**
+ * @name collision_router
+ * @brief Routes collision events to handlers whose filter matches the pair
+ *
+ * The scene subscribes to each collision event once and forwards it to
+ * dispatch(). Pairs are checked against the filters before any handler runs,
+ * entity filters are a plain id compare and component filters a table lookup,
+ * so handlers only run for the pairs they asked for and never need to look
+ * entities up by name.
+ */
+class collision_router {
+public:
+    template<typename Event>
+    using handler = std::function<void(Event&, const collision_match&)>;
+
+    template<typename Event>
+    void on(const collision_filter& p_filter, handler<Event> p_handler) {
+        channel<Event>().push_back({ p_filter, std::move(p_handler) });
+    }
+
+    template<typename Event>
+    void dispatch(flecs::world& p_registry, Event& p_event) {
+        auto& subscriptions = channel<Event>();
+        if(subscriptions.empty()) {
+            return;
+        }
+
+        auto first = static_cast<flecs::entity_t>(p_event.entity1);
+        auto second = static_cast<flecs::entity_t>(p_event.entity2);
+        for(subscription<Event>& target : subscriptions) {
+            if(target.filter.matches(p_registry, first, second)) {
+                target.callback(p_event, { p_registry.entity(first), p_registry.entity(second) });
+            }
+            else if(target.filter.matches(p_registry, second, first)) {
+                target.callback(p_event, { p_registry.entity(second), p_registry.entity(first) });
+            }
+        }
+    }
+
+    void clear();
+
+private:
+    template<typename Event>
+    struct subscription {
+        collision_filter filter;
+        handler<Event> callback;
+    };
+
+    template<typename Event>
+    std::vector<subscription<Event>>& channel() {
+        return std::get<std::vector<subscription<Event>>>(m_channels);
+    }
+
+private:
+    std::tuple<std::vector<subscription<atlas::event::collision_enter>>,
+               std::vector<subscription<atlas::event::collision_persisted>>,
+               std::vector<subscription<atlas::event::collision_exit>>>
+      m_channels;
+};
@@ -0,0 +1,46 @@
+#include "collision_stream.hpp"
+
+void collision_stream::frame_buffer::reserve(size_t p_count) {
+    kinds.reserve(p_count);
+    entity1.reserve(p_count);
+    entity2.reserve(p_count);
+}
+
+void collision_stream::frame_buffer::clear() {
+    // clear keeps the capacity, steady state frames never reallocate
+    kinds.clear();
+    entity1.clear();
+    entity2.clear();
+}
+
+collision_stream::collision_stream(size_t p_reserved_contacts) {
+    for(frame_buffer& frame : m_frames) {
+        frame.reserve(p_reserved_contacts);
+    }
+}
+
+void collision_stream::subscribe(batch_handler p_handler) {
+    m_handlers.push_back(std::move(p_handler));
+}
+
+void collision_stream::publish() {
+    frame_buffer& frame = m_frames[m_write];
+
+    collision_batch batch;
+    batch.frame = m_frame;
+    batch.kinds = frame.kinds;
+    batch.entity1 = frame.entity1;
+    batch.entity2 = frame.entity2;
+
+    for(const batch_handler& handler : m_handlers) {
+        handler(batch);
+    }
+
+    m_write = (m_write + 1) % frames_in_flight;
+    m_frames[m_write].clear();
+    m_frame++;
+}
+
+void collision_stream::discard() {
+    m_frames[m_write].clear();
+}
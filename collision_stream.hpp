@@ -0,0 +1,119 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <span>
+#include <vector>
+#include <flecs.h>
+#include <core/event/types.hpp>
+#include "thread_pool.hpp"
+
+enum class contact_kind : uint8_t { enter, persisted, exit };
+
+/**
+ * @name collision_batch
+ * @brief Every contact reported during one physics frame, one span per field
+ *
+ * Index i of each span belongs to the same contact. atlas collision events
+ * only carry the two entities, so there is no contact point or impulse. The
+ * spans stay valid until the next collision_stream::publish().
+ */
+struct collision_batch {
+    uint64_t frame=0;
+    std::span<const contact_kind> kinds;
+    std::span<const flecs::entity_t> entity1;
+    std::span<const flecs::entity_t> entity2;
+
+    [[nodiscard]] size_t size() const { return kinds.size(); }
+
+    [[nodiscard]] bool empty() const { return kinds.empty(); }
+
+    /**
+     * @brief Splits the batch into ranges of p_chunk_size contacts and runs
+     * p_body(begin, end) for each one on p_pool, blocks until all are done
+     */
+    template<typename Fn>
+    void parallel_for(thread_pool& p_pool, size_t p_chunk_size, Fn&& p_body) const {
+        if(size() <= p_chunk_size) {
+            p_body(size_t(0), size());
+            return;
+        }
+
+        std::vector<std::future<void>> chunks;
+        chunks.reserve(size() / p_chunk_size + 1);
+        for(size_t begin = p_chunk_size; begin < size(); begin += p_chunk_size) {
+            size_t end = std::min(begin + p_chunk_size, size());
+            chunks.push_back(p_pool.submit([&p_body, begin, end]() { p_body(begin, end); }));
+        }
+
+        // the calling thread takes the first chunk instead of idling
+        p_body(size_t(0), p_chunk_size);
+        for(std::future<void>& chunk : chunks) {
+            chunk.get();
+        }
+    }
+};
+
+/**
+ * @name collision_stream
+ * @brief Collects collision events into per-frame structure-of-arrays buffers
+ *
+ * The batched alternative to dispatching every contact through the event bus.
+ * Contacts are appended with push() while the physics step runs and
+ * publish() hands the whole frame to each handler as one collision_batch.
+ * Frame buffers are reused round-robin so a warmed up stream does not
+ * allocate.
+ *
+ * @note push() and publish() must be called from the same thread
+ */
+class collision_stream {
+public:
+    static constexpr uint32_t frames_in_flight = 2;
+
+    using batch_handler = std::function<void(const collision_batch&)>;
+
+    collision_stream(size_t p_reserved_contacts = 4096);
+
+    //! @brief Called once per contact, kept inline since it sits on the physics step's hot path
+    void push(contact_kind p_kind, flecs::entity_t p_entity1, flecs::entity_t p_entity2) {
+        frame_buffer& frame = m_frames[m_write];
+        frame.kinds.push_back(p_kind);
+        frame.entity1.push_back(p_entity1);
+        frame.entity2.push_back(p_entity2);
+    }
+
+    void push(const atlas::event::collision_enter& p_event) { push(contact_kind::enter, p_event.entity1, p_event.entity2); }
+
+    void push(const atlas::event::collision_persisted& p_event) { push(contact_kind::persisted, p_event.entity1, p_event.entity2); }
+
+    void push(const atlas::event::collision_exit& p_event) { push(contact_kind::exit, p_event.entity1, p_event.entity2); }
+
+    void subscribe(batch_handler p_handler);
+
+    //! @brief Hands the current frame to every handler and starts the next one
+    void publish();
+
+    //! @brief Drops the contacts pushed since the last publish
+    void discard();
+
+    //! @brief Contacts pushed since the last publish
+    [[nodiscard]] size_t pending() const { return m_frames[m_write].kinds.size(); }
+
+private:
+    struct frame_buffer {
+        std::vector<contact_kind> kinds;
+        std::vector<flecs::entity_t> entity1;
+        std::vector<flecs::entity_t> entity2;
+
+        void reserve(size_t p_count);
+        void clear();
+    };
+
+private:
+    std::array<frame_buffer, frames_in_flight> m_frames;
+    uint32_t m_write=0;
+    uint64_t m_frame=0;
+    std::vector<batch_handler> m_handlers;
+};
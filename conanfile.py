@@ -32,6 +32,7 @@ class StarterConanRecipe(ConanFile):
         self.requires("glm/1.0.1")
         self.requires("atlas/0.2")
         self.requires("miniaudio/1.0")
+        self.requires("yaml-cpp/0.8.0")
 
     def build(self):
         cmake = CMake(self)
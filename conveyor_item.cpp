@@ -1,9 +1,135 @@
 #include "conveyor_item.hpp"
+#include <algorithm>
+#include <cmath>
+#include <future>
 #include <core/common.hpp>
-#include <core/scene/components.hpp>
 #include <core/math/utilities.hpp>
 
-conveyor_item::conveyor_item(flecs::entity& p_entity) : m_entity(&p_entity) {
+namespace {
+    //! p_distance folded into [0, p_length), any number of lengths away and either side of the start
+    float wrap_distance(float p_distance, float p_length) {
+        float distance = std::fmod(p_distance, p_length);
+        if(distance < 0.f) {
+            distance += p_length;
+        }
+        // a tiny negative remainder plus p_length rounds up to p_length itself
+        return std::clamp(distance, 0.f, std::nextafter(p_length, 0.f));
+    }
+}
+
+conveyor_belt conveyor_system::belt_from_transform(const atlas::transform& p_transform, float p_length, float p_speed) {
     // set direction to the forward direction
-    m_direction = glm::rotate(atlas::to_quat(m_entity->get<atlas::transform>()->quaternion), glm::vec3(0.f, 0.f, -1.f));
-}
\ No newline at end of file
+    glm::vec3 direction = glm::rotate(atlas::to_quat(p_transform.quaternion), glm::vec3(0.f, 0.f, -1.f));
+    return {
+        .start = p_transform.position,
+        .end = p_transform.position + direction * p_length,
+        .speed = p_speed,
+    };
+}
+
+void conveyor_system::attach(flecs::entity p_item, flecs::entity p_belt, float p_distance) {
+    // advance_span wraps once per step, which only holds for distances already on the belt
+    if(const conveyor_belt* belt = p_belt.get<conveyor_belt>()) {
+        float length = glm::length(belt->end - belt->start);
+        p_distance = length > 0.f ? wrap_distance(p_distance, length) : 0.f;
+    }
+    p_item.set<conveyor_item>({ .distance = p_distance });
+    p_item.add<conveyor_on>(p_belt);
+}
+
+void conveyor_system::detach(flecs::entity p_item) {
+    p_item.remove<conveyor_on>(flecs::Wildcard);
+    p_item.remove<conveyor_item>();
+}
+
+void conveyor_system::gather(flecs::world& p_registry, float p_delta_time) {
+    if(m_query_world != p_registry.c_ptr()) {
+        m_query = p_registry.query_builder<conveyor_item, atlas::transform>().with<conveyor_on>(flecs::Wildcard).build();
+        m_query_world = p_registry.c_ptr();
+    }
+
+    m_spans.clear();
+    m_item_count = 0;
+    m_query.run([this, p_delta_time](flecs::iter& p_it) {
+        while(p_it.next()) {
+            auto count = static_cast<uint32_t>(p_it.count());
+            if(count == 0) {
+                continue;
+            }
+
+            // every item in a table rides the same belt
+            const conveyor_belt* belt = p_it.pair(2).second().get<conveyor_belt>();
+            if(belt == nullptr) {
+                continue;
+            }
+
+            glm::vec3 along = belt->end - belt->start;
+            float length = glm::length(along);
+            if(length <= 0.f) {
+                continue;
+            }
+
+            // wrapping the step once here keeps the per-item wrap a single compare
+            float advance = wrap_distance(belt->speed * p_delta_time, length);
+
+            auto items = p_it.field<conveyor_item>(0);
+            auto transforms = p_it.field<atlas::transform>(1);
+            for(uint32_t begin = 0; begin < count; begin += chunk_size) {
+                m_spans.push_back({
+                  .items = &items[begin],
+                  .transforms = &transforms[begin],
+                  .count = std::min(chunk_size, count - begin),
+                  .start = belt->start,
+                  .direction = along / length,
+                  .length = length,
+                  .advance = advance,
+                });
+            }
+            m_item_count += count;
+        }
+    });
+}
+
+void conveyor_system::advance_span(const belt_span& p_span) {
+    conveyor_item* items = p_span.items;
+    uint32_t count = p_span.count;
+    float length = p_span.length;
+    float advance = p_span.advance;
+
+    // branch free so the compiler can vectorize over the distance column
+    for(uint32_t i = 0; i < count; i++) {
+        float distance = items[i].distance + advance;
+        distance -= (distance >= length) ? length : 0.f;
+        items[i].distance = distance;
+    }
+
+    atlas::transform* transforms = p_span.transforms;
+    for(uint32_t i = 0; i < count; i++) {
+        transforms[i].position = p_span.start + p_span.direction * items[i].distance;
+    }
+}
+
+void conveyor_system::update(flecs::world& p_registry, float p_delta_time, thread_pool* p_pool) {
+    gather(p_registry, p_delta_time);
+    if(m_spans.empty()) {
+        return;
+    }
+
+    if(p_pool == nullptr or m_spans.size() == 1) {
+        for(const belt_span& span : m_spans) {
+            advance_span(span);
+        }
+        return;
+    }
+
+    m_pending.clear();
+    for(size_t i = 1; i < m_spans.size(); i++) {
+        m_pending.push_back(p_pool->submit([span = m_spans[i]]() { advance_span(span); }));
+    }
+
+    // the calling thread takes the first span instead of idling
+    advance_span(m_spans.front());
+    for(std::future<void>& span : m_pending) {
+        span.get();
+    }
+}
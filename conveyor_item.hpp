@@ -1,17 +1,89 @@
 #pragma once
+#include <cstdint>
+#include <future>
+#include <vector>
 #include <flecs.h>
 #include <glm/glm.hpp>
+#include <core/scene/components.hpp>
+#include <thread_pool.hpp>
 
-class conveyor_item {
+//! Belt segment, items ride from start to end and wrap back to start
+struct conveyor_belt {
+    glm::vec3 start{ 0.f };
+    glm::vec3 end{ 0.f };
+    //! units per second along the belt, negative runs the belt backwards
+    float speed = 1.f;
+};
+
+//! Relationship from an item to the belt it rides, added as (conveyor_on, belt)
+struct conveyor_on {};
+
+/**
+ * @brief Distance of an item along its belt
+ *
+ * The (conveyor_on, belt) pair puts every belt's items in their own table, so
+ * the distances of one belt sit in one contiguous float column and the
+ * conveyor_system advances them with a plain loop over that column.
+ */
+struct conveyor_item {
+    float distance = 0.f;
+};
+
+/**
+ * @name conveyor_system
+ * @brief Moves conveyor_item entities along their belts in bulk
+ *
+ * Each update gathers the matching tables into spans of at most
+ * chunk_size items with the belt parameters resolved once per span, then
+ * advances the spans on the thread pool. Item positions are written
+ * straight into atlas::transform, items should not carry a dynamic
+ * physics_body since the physics step would fight the belt over the
+ * transform.
+ */
+class conveyor_system {
 public:
-    conveyor_item() = default;
-    conveyor_item(flecs::entity& p_entity);
+    //! @brief Belt running p_length units along the -z axis of p_transform, which is how belts face in the editor
+    static conveyor_belt belt_from_transform(const atlas::transform& p_transform, float p_length, float p_speed);
+
+    //! @brief Puts p_item on p_belt at p_distance units from the start, wrapped onto the belt's length
+    static void attach(flecs::entity p_item, flecs::entity p_belt, float p_distance = 0.f);
+
+    static void detach(flecs::entity p_item);
+
+    /**
+     * @brief Advances every item by speed * p_delta_time and writes its position
+     *
+     * @param p_pool runs the spans in parallel, nullptr runs everything on the calling thread
+     */
+    void update(flecs::world& p_registry, float p_delta_time, thread_pool* p_pool = &shared_thread_pool());
+
+    //! @brief Items moved by the last update
+    [[nodiscard]] uint64_t item_count() const { return m_item_count; }
+
+    //! items per span handed to one worker
+    static constexpr uint32_t chunk_size = 4096;
 
 private:
-    flecs::entity* m_entity;
-    glm::vec3 m_direction;
-    glm::vec3 m_respawn_startpoint;
-    glm::vec3 m_respawn_endpoint;
+    struct belt_span {
+        conveyor_item* items;
+        atlas::transform* transforms;
+        uint32_t count;
+        glm::vec3 start;
+        glm::vec3 direction;
+        float length;
+        //! speed * dt wrapped into [0, length)
+        float advance;
+    };
 
+    void gather(flecs::world& p_registry, float p_delta_time);
 
-};
\ No newline at end of file
+    static void advance_span(const belt_span& p_span);
+
+private:
+    flecs::query<conveyor_item, atlas::transform> m_query;
+    flecs::world_t* m_query_world=nullptr;
+    std::vector<belt_span> m_spans;
+    // reused between updates so a step does not reallocate it
+    std::vector<std::future<void>> m_pending;
+    uint64_t m_item_count=0;
+};
@@ -1,10 +1,15 @@
 #include "editor_panels.hpp"
+#include "profiler.hpp"
 #include <imgui.h>
 #include <core/scene/components.hpp>
 #include <physics/components.hpp>
 #include <core/ui/widgets.hpp>
 
-editor_panel::editor_panel(flecs::world& p_registry, atlas::event::event_bus& p_bus) : m_registry(&p_registry), m_bus(&p_bus) {
+editor_panel::editor_panel(flecs::world& p_registry, atlas::event::event_bus& p_bus)
+  : m_registry(&p_registry)
+  , m_bus(&p_bus)
+  , m_hierarchy(std::make_unique<scene_hierarchy>()) {
+    m_hierarchy->attach(p_registry);
 }
 
 void editor_panel::defer_begin() {
@@ -16,11 +21,15 @@ void editor_panel::defer_end() {
 }
 
 void
-ui_component_list(flecs::entity& p_selected_entity) {
-    std::string entity_name = p_selected_entity.name().c_str();
-
-    atlas::ui::draw_input_text(entity_name);
-    p_selected_entity.set_name(entity_name.c_str());
+ui_component_list(flecs::entity& p_selected_entity, std::string& p_name_edit) {
+    const char* entity_name = p_selected_entity.name().c_str();
+    p_name_edit.assign(entity_name);
+
+    atlas::ui::draw_input_text(p_name_edit);
+    // only rename on edits, set_name notifies every name observer
+    if(p_name_edit != entity_name) {
+        p_selected_entity.set_name(p_name_edit.c_str());
+    }
 
     ImGui::SameLine();
     ImGui::PushItemWidth(-1);
@@ -95,85 +104,35 @@ ui_component_list(flecs::entity& p_selected_entity) {
 
 
 void editor_panel::render_properties_panel() {
+    PROFILE_ZONE("editor_panel::render_properties_panel");
+    // deletes from the context menu are applied once the panel is done drawing
     defer_begin();
-    auto query_builder = m_registry->query_builder<atlas::transform>().build();
-
-    if (ImGui::Begin("Scene Heirarchy")) {
-
-        query_builder.each([&](flecs::entity p_entity, atlas::transform&) {
-            // We set the imgui flags for our scene heirarchy panel
-            // TODO -- Make the scene heirarchy panel a separate class that is
-            // used for specify the layout and other UI elements here
-            ImGuiTreeNodeFlags flags =
-              ((m_selected_entity == p_entity) ? ImGuiTreeNodeFlags_Selected
-                                               : 0) |
-              ImGuiTreeNodeFlags_OpenOnArrow;
-            flags |= ImGuiTreeNodeFlags_SpanAvailWidth;
-            flags |= ImGuiWindowFlags_Popup;
-            bool opened = ImGui::TreeNodeEx(p_entity.name().c_str(), flags);
-            if (ImGui::IsItemClicked()) {
-                m_selected_entity = p_entity;
-                // m_create_entity = search_entity(p_entity.name().c_str());
-            }
-
-            bool delete_entity = false;
-            if (ImGui::BeginPopupContextItem()) {
-                if (ImGui::MenuItem("Delete Entity")) {
-                    delete_entity = true;
-                }
-                ImGui::EndPopup();
-            }
-
-            if (delete_entity) {
-                // _context->destroyEntity(entity);
-                m_selected_entity.destruct();
-            }
-
-            if (opened) {
-                flags = ImGuiTreeNodeFlags_OpenOnArrow |
-                        ImGuiTreeNodeFlags_SpanAvailWidth;
-                auto query_children_builder =
-                  m_registry->query_builder().with(flecs::ChildOf, p_entity).build();
-                int32_t child_count = query_children_builder.count();
-
-                // // Only show children in scene heirarchy panel if there are
-                // children entities
-                if (child_count > 0) {
-                    m_selected_entity.children(
-                      [&](flecs::entity p_child_entity) {
-                          opened = ImGui::TreeNodeEx(
-                            p_child_entity.name().c_str(), flags);
-                          if (opened) {
-                              if (ImGui::IsItemClicked()) {
-                                  m_selected_entity = p_child_entity;
-                                  // m_create_entity =
-                                  // search_entity(p_child_entity.name().c_str());
-                              }
-                              ImGui::TreePop();
-                          }
-                      });
-                }
-
-                ImGui::TreePop();
-            }
-        });
-
-        defer_end();
-        ImGui::End();
+    if (ImGui::Begin("Scene Heirarchy") and m_hierarchy) {
+        m_hierarchy->render(m_selected_entity);
     }
+    ImGui::End();
+    defer_end();
 
     if (ImGui::Begin("Properties")) {
         if (m_selected_entity.is_alive()) {
-            ui_component_list(m_selected_entity);
+            ui_component_list(m_selected_entity, m_name_edit);
 
+            bool transform_edited = false;
             atlas::ui::draw_component<atlas::transform>(
               "transform",
               m_selected_entity,
-              [](atlas::transform* p_transform) {
+              [&transform_edited](atlas::transform* p_transform) {
+                  atlas::transform before = *p_transform;
                   atlas::ui::draw_vec3("Position", p_transform->position);
                   atlas::ui::draw_vec3("Scale", p_transform->scale);
                   atlas::ui::draw_vec3("Rotation", p_transform->rotation);
+                  transform_edited = p_transform->position != before.position or p_transform->scale != before.scale or
+                                     p_transform->rotation != before.rotation;
               });
+            // the widgets write through a pointer, flecs only sees the change when told
+            if(transform_edited) {
+                m_selected_entity.modified<atlas::transform>();
+            }
 
             atlas::ui::draw_component<atlas::perspective_camera>(
               "camera",
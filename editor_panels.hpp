@@ -1,6 +1,9 @@
 #pragma once
 #include <core/event/event_bus.hpp>
 #include <flecs.h>
+#include <memory>
+#include <string>
+#include "scene_hierarchy.hpp"
 
 class editor_panel {
 public:
@@ -15,6 +18,10 @@ private:
 
 private:
     flecs::entity m_selected_entity{flecs::entity::null()};
+    // reused every frame so editing the selected entity's name does not allocate
+    std::string m_name_edit;
     flecs::world* m_registry;
     atlas::event::event_bus* m_bus=nullptr;
+    // heap allocated so its observers keep a stable pointer when the panel is moved
+    std::unique_ptr<scene_hierarchy> m_hierarchy;
 };
\ No newline at end of file
@@ -0,0 +1,40 @@
+#version 460
+
+// Instanced variant of test.vert: the model matrix and color come from the
+// instance storage buffer render_batcher packs instead of a per-object
+// MaterialSource UBO, so one draw covers every instance of a batch. The
+// draw passes draw_batch::first_instance as firstInstance, gl_InstanceIndex
+// already includes it.
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec3 inNormals;
+layout(location = 3) in vec2 inTexCoords;
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec3 fragNormals;
+layout(location = 2) out vec2 fragTexCoords;
+layout(location = 3) out vec4 materialColor;
+
+layout (set = 0, binding = 0) uniform UniformBuffer {
+	mat4 MVP;
+} ubo;
+
+// matches instance_data in render_batches.hpp
+struct Instance {
+	mat4 model;
+	vec4 color;
+};
+
+layout (std430, set = 1, binding = 0) readonly buffer InstanceBuffer {
+	Instance instances[];
+} instance_src;
+
+void main() {
+	Instance instance = instance_src.instances[gl_InstanceIndex];
+	gl_Position = (ubo.MVP * instance.model) * vec4(inPosition, 1.0);
+	fragColor = vec4(inColor, 1.0);
+	fragTexCoords = inTexCoords;
+	fragNormals = inNormals;
+	materialColor = instance.color;
+}
@@ -0,0 +1,121 @@
+#include "file_watcher.hpp"
+#include <algorithm>
+#include <core/engine_logger.hpp>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    constexpr auto scan_interval = std::chrono::milliseconds(250);
+
+    std::filesystem::file_time_type write_time_of(const std::filesystem::path& p_path) {
+        std::error_code ec;
+        auto time = std::filesystem::last_write_time(p_path, ec);
+        return ec ? std::filesystem::file_time_type{} : time;
+    }
+}
+
+file_watcher::file_watcher() {
+#if defined(__linux__)
+    m_descriptor = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(m_descriptor < 0) {
+        console_log_warn("inotify unavailable, polling watched files instead");
+    }
+#endif
+}
+
+file_watcher::~file_watcher() {
+#if defined(__linux__)
+    if(m_descriptor >= 0) {
+        ::close(m_descriptor);
+    }
+#endif
+}
+
+bool file_watcher::watch(const std::filesystem::path& p_path) {
+    std::error_code ec;
+    auto path = std::filesystem::absolute(p_path, ec).lexically_normal();
+    if(ec) {
+        return false;
+    }
+
+    if(std::ranges::any_of(m_files, [&](const watched_file& p_file) { return p_file.path == path; })) {
+        return true;
+    }
+
+    watched_file file{ .path = path, .last_write = write_time_of(path) };
+
+#if defined(__linux__)
+    if(m_descriptor >= 0) {
+        // the directory is watched, not the file, so a save that replaces the file keeps being seen
+        file.directory = ::inotify_add_watch(m_descriptor, path.parent_path().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if(file.directory < 0) {
+            console_log_error("Could not watch {}", path.string());
+            return false;
+        }
+    }
+#endif
+
+    m_files.push_back(std::move(file));
+    return true;
+}
+
+void file_watcher::mark_changed(const watched_file& p_file) {
+    if(std::ranges::find(m_changed, p_file.path) == m_changed.end()) {
+        m_changed.push_back(p_file.path);
+    }
+}
+
+std::span<const std::filesystem::path> file_watcher::poll() {
+    m_changed.clear();
+    if(m_files.empty()) {
+        return {};
+    }
+
+#if defined(__linux__)
+    if(m_descriptor >= 0) {
+        alignas(inotify_event) char buffer[4096];
+        while(true) {
+            ssize_t length = ::read(m_descriptor, buffer, sizeof(buffer));
+            if(length <= 0) {
+                // EAGAIN, the queue is drained
+                break;
+            }
+
+            for(ssize_t offset = 0; offset < length;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+                if(event->len == 0) {
+                    continue;
+                }
+
+                std::string_view name(event->name);
+                for(const watched_file& file : m_files) {
+                    if(file.directory == event->wd and file.path.filename().native() == name) {
+                        mark_changed(file);
+                    }
+                }
+            }
+        }
+        return m_changed;
+    }
+#endif
+
+    auto now = std::chrono::steady_clock::now();
+    if(now < m_next_scan) {
+        return {};
+    }
+    m_next_scan = now + scan_interval;
+
+    for(watched_file& file : m_files) {
+        auto write_time = write_time_of(file.path);
+        if(write_time != file.last_write) {
+            file.last_write = write_time;
+            mark_changed(file);
+        }
+    }
+    return m_changed;
+}
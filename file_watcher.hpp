@@ -0,0 +1,53 @@
+#pragma once
+#include <chrono>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+/**
+ * @name file_watcher
+ * @brief Reports files that were written since the last poll
+ *
+ * On Linux the parent directory of every watched file is registered with
+ * inotify and poll() drains the queued events without blocking. Only
+ * finished writes (IN_CLOSE_WRITE) and files renamed into place
+ * (IN_MOVED_TO) count, which covers editors that save in place as well as
+ * the ones that write a temporary file and rename it over the original.
+ * Other platforms fall back to comparing write times a few times a second,
+ * the interface stays the same.
+ */
+class file_watcher {
+public:
+    file_watcher();
+    ~file_watcher();
+
+    file_watcher(const file_watcher&) = delete;
+    file_watcher& operator=(const file_watcher&) = delete;
+
+    //! @return false if the file could not be watched
+    bool watch(const std::filesystem::path& p_path);
+
+    /**
+     * @brief Collects the watched files that changed since the last call
+     *
+     * Each file is listed once no matter how many writes landed in between.
+     * The span is valid until the next call.
+     */
+    std::span<const std::filesystem::path> poll();
+
+private:
+    struct watched_file {
+        std::filesystem::path path;
+        std::filesystem::file_time_type last_write;
+        int directory=-1;
+    };
+
+    void mark_changed(const watched_file& p_file);
+
+private:
+    std::vector<watched_file> m_files;
+    std::vector<std::filesystem::path> m_changed;
+    // inotify instance, -1 when unavailable and write times are polled instead
+    int m_descriptor=-1;
+    std::chrono::steady_clock::time_point m_next_scan{};
+};
@@ -0,0 +1,168 @@
+#include "fixed_timestep.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    //! normalized lerp, takes the short way around by flipping b into a's hemisphere
+    glm::vec4 nlerp(const glm::vec4& p_a, glm::vec4 p_b, float p_alpha) {
+        if(glm::dot(p_a, p_b) < 0.f) {
+            p_b = p_b * -1.f;
+        }
+        glm::vec4 blended = glm::mix(p_a, p_b, p_alpha);
+        float length = std::sqrt(glm::dot(blended, blended));
+        return length > 0.f ? blended * (1.f / length) : p_a;
+    }
+
+    //! euler angles only blend while no axis wrapped around between the two steps
+    glm::vec3 blend_euler(const glm::vec3& p_a, const glm::vec3& p_b, float p_alpha) {
+        glm::vec3 delta = p_b - p_a;
+        constexpr float half_turn = 3.14159265f;
+        if(std::fabs(delta.x) > half_turn or std::fabs(delta.y) > half_turn or std::fabs(delta.z) > half_turn) {
+            return p_b;
+        }
+        return glm::mix(p_a, p_b, p_alpha);
+    }
+
+    bool is_moving(const atlas::physics_body& p_body) {
+        return p_body.body_movement_type != atlas::fixed;
+    }
+
+    //! true when something other than apply() wrote the transform after it
+    bool edited_since_apply(const atlas::transform& p_transform, const physics_pose& p_pose) {
+        return p_pose.applied and (p_transform.position != p_pose.applied_position or p_transform.quaternion != p_pose.applied_quaternion or
+                                   p_transform.rotation != p_pose.applied_rotation);
+    }
+
+    //! the edited transform becomes both poses, like a snap for this body alone
+    void adopt_edit(const atlas::transform& p_transform, physics_pose& p_pose) {
+        p_pose.previous_position = p_pose.current_position = p_transform.position;
+        p_pose.previous_quaternion = p_pose.current_quaternion = p_transform.quaternion;
+        p_pose.previous_rotation = p_pose.current_rotation = p_transform.rotation;
+        p_pose.applied = false;
+    }
+}
+
+fixed_timestep::fixed_timestep(const fixed_timestep_settings& p_settings) {
+    configure(p_settings);
+}
+
+void fixed_timestep::configure(const fixed_timestep_settings& p_settings) {
+    m_step = 1.0 / static_cast<double>(std::max(p_settings.step_rate, 1.f));
+    m_max_substeps = std::max(p_settings.max_substeps, 1u);
+    m_accumulator = std::min(m_accumulator, m_step);
+}
+
+uint32_t fixed_timestep::advance(float p_frame_time) {
+    m_accumulator += std::max(static_cast<double>(p_frame_time), 0.0);
+
+    auto steps = static_cast<uint32_t>(m_accumulator / m_step);
+    if(steps > m_max_substeps) {
+        m_dropped_steps += steps - m_max_substeps;
+        steps = m_max_substeps;
+        // keep the fractional part so interpolation stays smooth after a hitch
+        m_accumulator = std::fmod(m_accumulator, m_step) + static_cast<double>(steps) * m_step;
+    }
+
+    m_accumulator -= static_cast<double>(steps) * m_step;
+    return steps;
+}
+
+void fixed_timestep::reset() {
+    m_accumulator = 0.0;
+}
+
+void physics_interpolation::build_queries(flecs::world& p_registry) {
+    if(m_query_world == p_registry.c_ptr()) {
+        return;
+    }
+    m_apply_query = p_registry.query_builder<atlas::transform, physics_pose>().build();
+    m_store_query = p_registry.query_builder<const atlas::transform, physics_pose>().build();
+    m_new_body_query = p_registry.query_builder<const atlas::transform, const atlas::physics_body>().without<physics_pose>().build();
+    m_query_world = p_registry.c_ptr();
+}
+
+void physics_interpolation::restore(flecs::world& p_registry) {
+    build_queries(p_registry);
+    m_apply_query.each(
+      [](flecs::entity, atlas::transform& p_transform, physics_pose& p_pose) {
+          if(edited_since_apply(p_transform, p_pose)) {
+              adopt_edit(p_transform, p_pose);
+              return;
+          }
+          p_transform.position = p_pose.current_position;
+          p_transform.quaternion = p_pose.current_quaternion;
+          p_transform.rotation = p_pose.current_rotation;
+          p_pose.applied = false;
+      });
+}
+
+void physics_interpolation::store_previous(flecs::world& p_registry) {
+    build_queries(p_registry);
+    m_store_query.each(
+      [](flecs::entity, const atlas::transform& p_transform, physics_pose& p_pose) {
+          p_pose.previous_position = p_transform.position;
+          p_pose.previous_quaternion = p_transform.quaternion;
+          p_pose.previous_rotation = p_transform.rotation;
+      });
+}
+
+void physics_interpolation::store_current(flecs::world& p_registry) {
+    build_queries(p_registry);
+
+    // bodies spawned since the last frame start out with both poses equal
+    p_registry.defer_begin();
+    m_new_body_query.each(
+      [](flecs::entity p_entity, const atlas::transform& p_transform, const atlas::physics_body& p_body) {
+          if(!is_moving(p_body)) {
+              return;
+          }
+          p_entity.set<physics_pose>({
+            .previous_position = p_transform.position,
+            .current_position = p_transform.position,
+            .previous_quaternion = p_transform.quaternion,
+            .current_quaternion = p_transform.quaternion,
+            .previous_rotation = p_transform.rotation,
+            .current_rotation = p_transform.rotation,
+          });
+      });
+    p_registry.defer_end();
+
+    bool snap = m_snap;
+    m_store_query.each(
+      [snap](flecs::entity, const atlas::transform& p_transform, physics_pose& p_pose) {
+          p_pose.current_position = p_transform.position;
+          p_pose.current_quaternion = p_transform.quaternion;
+          p_pose.current_rotation = p_transform.rotation;
+          if(snap) {
+              p_pose.previous_position = p_pose.current_position;
+              p_pose.previous_quaternion = p_pose.current_quaternion;
+              p_pose.previous_rotation = p_pose.current_rotation;
+          }
+      });
+    m_snap = false;
+}
+
+void physics_interpolation::reset(flecs::world& p_registry) {
+    m_snap = true;
+    store_current(p_registry);
+}
+
+void physics_interpolation::apply(flecs::world& p_registry, float p_alpha) {
+    build_queries(p_registry);
+    float alpha = std::clamp(p_alpha, 0.f, 1.f);
+    m_apply_query.each(
+      [alpha](flecs::entity, atlas::transform& p_transform, physics_pose& p_pose) {
+          // frames without a step skip restore(), so an edit can reach this point first
+          if(edited_since_apply(p_transform, p_pose)) {
+              adopt_edit(p_transform, p_pose);
+              return;
+          }
+          p_transform.position = glm::mix(p_pose.previous_position, p_pose.current_position, alpha);
+          p_transform.quaternion = nlerp(p_pose.previous_quaternion, p_pose.current_quaternion, alpha);
+          p_transform.rotation = blend_euler(p_pose.previous_rotation, p_pose.current_rotation, alpha);
+          p_pose.applied_position = p_transform.position;
+          p_pose.applied_quaternion = p_transform.quaternion;
+          p_pose.applied_rotation = p_transform.rotation;
+          p_pose.applied = true;
+      });
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include <flecs.h>
+#include <glm/glm.hpp>
+#include <core/scene/components.hpp>
+#include <physics/components.hpp>
+
+struct fixed_timestep_settings {
+    //! physics steps per second
+    float step_rate = 60.f;
+    //! steps allowed per frame, time beyond that is dropped instead of caught up
+    uint32_t max_substeps = 4;
+};
+
+/**
+ * @name fixed_timestep
+ * @brief Accumulates frame time and hands it out in fixed-size physics steps
+ *
+ * A frame that took longer than max_substeps steps only advances the
+ * simulation by max_substeps steps, so one slow frame cannot snowball into
+ * ever longer physics updates.
+ */
+class fixed_timestep {
+public:
+    fixed_timestep(const fixed_timestep_settings& p_settings = {});
+
+    void configure(const fixed_timestep_settings& p_settings);
+
+    //! @brief Adds p_frame_time to the accumulator and returns how many steps to run
+    uint32_t advance(float p_frame_time);
+
+    void reset();
+
+    [[nodiscard]] float step() const { return static_cast<float>(m_step); }
+
+    //! @brief How far the render frame is between the last two physics states, 0 to 1
+    [[nodiscard]] float alpha() const { return static_cast<float>(m_accumulator / m_step); }
+
+    //! @brief Steps skipped because a frame hit max_substeps, useful for spotting overload
+    [[nodiscard]] uint64_t dropped_steps() const { return m_dropped_steps; }
+
+private:
+    double m_step;
+    uint32_t m_max_substeps;
+    // double so the accumulator does not drift over long sessions
+    double m_accumulator=0.0;
+    uint64_t m_dropped_steps=0;
+};
+
+//! Last two physics poses of a moving body, added by physics_interpolation
+struct physics_pose {
+    glm::vec3 previous_position{ 0.f };
+    glm::vec3 current_position{ 0.f };
+    glm::vec4 previous_quaternion{ 0.f, 0.f, 0.f, 1.f };
+    glm::vec4 current_quaternion{ 0.f, 0.f, 0.f, 1.f };
+    glm::vec3 previous_rotation{ 0.f };
+    glm::vec3 current_rotation{ 0.f };
+    //! what apply() last wrote into the transform, anything else there is an edit to keep
+    glm::vec3 applied_position{ 0.f };
+    glm::vec4 applied_quaternion{ 0.f, 0.f, 0.f, 1.f };
+    glm::vec3 applied_rotation{ 0.f };
+    bool applied = false;
+};
+
+/**
+ * @name physics_interpolation
+ * @brief Blends the transforms of moving bodies between physics steps
+ *
+ * The transform component holds the interpolated pose between frames so the
+ * renderer picks it up. Before the next step restore() puts the real
+ * physics pose back, so the physics engine never sees interpolated values.
+ *
+ * A transform that no longer holds what apply() wrote was changed by
+ * gameplay or the editor in between. restore() and apply() keep such an
+ * edit and take it as the body's new pose instead of overwriting it.
+ *
+ * Per frame:
+ *   restore() -> [store_previous() before the last step] steps -> store_current() -> apply(alpha)
+ */
+class physics_interpolation {
+public:
+    void restore(flecs::world& p_registry);
+
+    void store_previous(flecs::world& p_registry);
+
+    void store_current(flecs::world& p_registry);
+
+    void apply(flecs::world& p_registry, float p_alpha);
+
+    //! @brief Skips blending on the next apply, for teleports and resets
+    void snap() { m_snap = true; }
+
+    //! @brief Takes the current transforms as both poses, call when the simulation (re)starts
+    void reset(flecs::world& p_registry);
+
+private:
+    //! queries are built once per world instead of on every call
+    void build_queries(flecs::world& p_registry);
+
+private:
+    bool m_snap=true;
+    flecs::query<atlas::transform, physics_pose> m_apply_query;
+    flecs::query<const atlas::transform, physics_pose> m_store_query;
+    flecs::query<const atlas::transform, const atlas::physics_body> m_new_body_query;
+    flecs::world_t* m_query_world=nullptr;
+};
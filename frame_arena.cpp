@@ -0,0 +1,85 @@
+#include "frame_arena.hpp"
+#include <algorithm>
+
+namespace {
+    constexpr size_t block_alignment = alignof(std::max_align_t);
+}
+
+frame_arena::frame_arena(size_t p_capacity, std::pmr::memory_resource* p_upstream) : m_upstream(p_upstream) {
+    m_blocks.reserve(4);
+    push_block(std::max<size_t>(p_capacity, 1));
+}
+
+frame_arena::~frame_arena() {
+    release_blocks();
+}
+
+void frame_arena::push_block(size_t p_size) {
+    if(!m_blocks.empty()) {
+        m_used_before += static_cast<size_t>(m_cursor - m_blocks.back().data);
+    }
+
+    auto* data = static_cast<std::byte*>(m_upstream->allocate(p_size, block_alignment));
+    m_blocks.push_back({ data, p_size });
+    m_cursor = data;
+    m_end = data + p_size;
+}
+
+void frame_arena::release_blocks() {
+    for(const block& item : m_blocks) {
+        m_upstream->deallocate(item.data, item.size, block_alignment);
+    }
+    m_blocks.clear();
+    m_cursor = nullptr;
+    m_end = nullptr;
+    m_used_before = 0;
+}
+
+void* frame_arena::do_allocate(size_t p_bytes, size_t p_alignment) {
+    auto align = [p_alignment](std::byte* p_pointer) {
+        auto address = reinterpret_cast<uintptr_t>(p_pointer);
+        return reinterpret_cast<std::byte*>((address + p_alignment - 1) & ~(uintptr_t(p_alignment) - 1));
+    };
+
+    std::byte* start = align(m_cursor);
+    if(start > m_end or static_cast<size_t>(m_end - start) < p_bytes) {
+        // the next block is at least as large as the last so a busy frame chains few of them
+        push_block(std::max(p_bytes + p_alignment, m_blocks.back().size));
+        start = align(m_cursor);
+    }
+
+    m_cursor = start + p_bytes;
+    return start;
+}
+
+void frame_arena::reset() {
+    m_peak = std::max(m_peak, used());
+
+    // a frame that overflowed gets one block that holds all of it next time
+    if(m_blocks.size() > 1) {
+        size_t total = capacity();
+        release_blocks();
+        push_block(total);
+    }
+
+    m_cursor = m_blocks.front().data;
+    m_end = m_cursor + m_blocks.front().size;
+    m_used_before = 0;
+}
+
+size_t frame_arena::used() const {
+    return m_used_before + static_cast<size_t>(m_cursor - m_blocks.back().data);
+}
+
+size_t frame_arena::capacity() const {
+    size_t total = 0;
+    for(const block& item : m_blocks) {
+        total += item.size;
+    }
+    return total;
+}
+
+frame_arena& frame_memory() {
+    static frame_arena s_arena;
+    return s_arena;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+/**
+ * @name frame_arena
+ * @brief Linear allocator for data that only lives until the end of the frame
+ *
+ * allocate() bumps a pointer through a block, deallocate() does nothing and
+ * reset() hands the whole arena back at once. A frame that needs more than
+ * the block holds chains extra blocks from the upstream resource, reset()
+ * then swaps them for a single block big enough for that frame, so after
+ * the first few frames the arena stops touching the heap.
+ *
+ * It is a std::pmr::memory_resource, so std::pmr containers and strings
+ * allocate from it directly. Not thread safe, every thread needs its own.
+ */
+class frame_arena : public std::pmr::memory_resource {
+public:
+    static constexpr size_t default_capacity = 256 * 1024;
+
+    frame_arena(size_t p_capacity = default_capacity, std::pmr::memory_resource* p_upstream = std::pmr::new_delete_resource());
+
+    ~frame_arena() override;
+
+    frame_arena(const frame_arena&) = delete;
+    frame_arena& operator=(const frame_arena&) = delete;
+
+    //! @brief Releases everything allocated since the last reset, nothing allocated from the arena may be used afterwards
+    void reset();
+
+    //! @brief Bytes handed out since the last reset, alignment padding included
+    [[nodiscard]] size_t used() const;
+
+    //! @brief Bytes held in blocks
+    [[nodiscard]] size_t capacity() const;
+
+    //! @brief Most bytes any frame used so far
+    [[nodiscard]] size_t peak() const { return m_peak; }
+
+    //! @brief Blocks chained since the last reset because the frame outgrew the arena
+    [[nodiscard]] uint32_t overflow_blocks() const { return static_cast<uint32_t>(m_blocks.size() - 1); }
+
+protected:
+    void* do_allocate(size_t p_bytes, size_t p_alignment) override;
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& p_other) const noexcept override { return this == &p_other; }
+
+private:
+    struct block {
+        std::byte* data;
+        size_t size;
+    };
+
+    void push_block(size_t p_size);
+
+    void release_blocks();
+
+private:
+    std::pmr::memory_resource* m_upstream;
+    std::vector<block> m_blocks;
+    std::byte* m_cursor=nullptr;
+    std::byte* m_end=nullptr;
+    // bytes used in every block before the current one
+    size_t m_used_before=0;
+    size_t m_peak=0;
+};
+
+/**
+ * @brief Arena for transient data on the main thread, reset by main_scene at
+ * the start of every frame
+ *
+ * Anything allocated from it must not outlive the frame. Code running
+ * outside main_scene's frames (tools, benchmarks) resets it itself.
+ */
+frame_arena& frame_memory();
+
+template<typename T>
+using frame_vector = std::pmr::vector<T>;
+
+using frame_string = std::pmr::string;
@@ -0,0 +1,47 @@
+#include "frame_input.hpp"
+#include <core/application.hpp>
+#include <core/event/event.hpp>
+
+float device_input::delta_time() const {
+    return atlas::application::delta_time();
+}
+
+bool device_input::is_key_pressed(int32_t p_key) const {
+    return atlas::event::is_key_pressed(static_cast<decltype(key_w)>(p_key));
+}
+
+bool device_input::is_mouse_pressed(int32_t p_button) const {
+    return atlas::event::is_mouse_pressed(static_cast<decltype(mouse_button_right)>(p_button));
+}
+
+bool device_input::is_joystick_present(int32_t p_joystick) const {
+    return atlas::event::is_joystic_present(p_joystick);
+}
+
+float device_input::joystick_axis(int32_t p_joystick, int32_t p_axis) const {
+    return atlas::event::get_joystic_axis(p_joystick, p_axis);
+}
+
+bool device_input::is_joystick_button_pressed(int32_t p_joystick, int32_t p_button) const {
+    int button_count = 0;
+    const unsigned char* buttons = glfwGetJoystickButtons(p_joystick, &button_count);
+    return buttons != nullptr and p_button < button_count and buttons[p_button] == GLFW_PRESS;
+}
+
+scripted_input::scripted_input(float p_fixed_delta_time) : m_delta_time(p_fixed_delta_time) {}
+
+void scripted_input::press(uint32_t p_frame, int32_t p_key, uint32_t p_duration) {
+    if(p_duration == 0) {
+        return;
+    }
+    m_presses.push_back({ p_frame, p_frame + p_duration - 1, p_key });
+}
+
+bool scripted_input::is_key_pressed(int32_t p_key) const {
+    for(const key_press& press : m_presses) {
+        if(press.key == p_key and m_frame >= press.first_frame and m_frame <= press.last_frame) {
+            return true;
+        }
+    }
+    return false;
+}
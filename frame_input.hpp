@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/**
+ * @name frame_input
+ * @brief Source of frame time and input state for main_scene
+ *
+ * Gameplay code reads time and input through this interface instead of the
+ * window directly so the scene can also be driven without one, at a fixed
+ * dt with scripted input.
+ */
+class frame_input {
+public:
+    virtual ~frame_input() = default;
+
+    [[nodiscard]] virtual float delta_time() const = 0;
+
+    [[nodiscard]] virtual bool is_key_pressed(int32_t p_key) const = 0;
+
+    [[nodiscard]] virtual bool is_mouse_pressed(int32_t p_button) const = 0;
+
+    [[nodiscard]] virtual bool is_joystick_present(int32_t p_joystick) const = 0;
+
+    //! @brief Gamepad axis in [-1, 1], p_axis is a GLFW_GAMEPAD_AXIS_* value
+    [[nodiscard]] virtual float joystick_axis(int32_t p_joystick, int32_t p_axis) const = 0;
+
+    [[nodiscard]] virtual bool is_joystick_button_pressed(int32_t p_joystick, int32_t p_button) const = 0;
+};
+
+//! Reads atlas::application::delta_time() and the window's input state
+class device_input : public frame_input {
+public:
+    [[nodiscard]] float delta_time() const override;
+
+    [[nodiscard]] bool is_key_pressed(int32_t p_key) const override;
+
+    [[nodiscard]] bool is_mouse_pressed(int32_t p_button) const override;
+
+    [[nodiscard]] bool is_joystick_present(int32_t p_joystick) const override;
+
+    [[nodiscard]] float joystick_axis(int32_t p_joystick, int32_t p_axis) const override;
+
+    [[nodiscard]] bool is_joystick_button_pressed(int32_t p_joystick, int32_t p_button) const override;
+};
+
+/**
+ * @name scripted_input
+ * @brief Fixed dt and a list of key presses keyed by frame number
+ *
+ * Used by the headless runner so every run of a script produces the same
+ * sequence of inputs.
+ */
+class scripted_input : public frame_input {
+public:
+    scripted_input(float p_fixed_delta_time);
+
+    //! @brief Holds p_key down from p_frame for p_duration frames
+    void press(uint32_t p_frame, int32_t p_key, uint32_t p_duration = 1);
+
+    void set_frame(uint32_t p_frame) { m_frame = p_frame; }
+
+    [[nodiscard]] uint32_t frame() const { return m_frame; }
+
+    [[nodiscard]] float delta_time() const override { return m_delta_time; }
+
+    [[nodiscard]] bool is_key_pressed(int32_t p_key) const override;
+
+    [[nodiscard]] bool is_mouse_pressed(int32_t) const override { return false; }
+
+    [[nodiscard]] bool is_joystick_present(int32_t) const override { return false; }
+
+    [[nodiscard]] float joystick_axis(int32_t, int32_t) const override { return 0.f; }
+
+    [[nodiscard]] bool is_joystick_button_pressed(int32_t, int32_t) const override { return false; }
+
+private:
+    struct key_press {
+        uint32_t first_frame;
+        uint32_t last_frame;
+        int32_t key;
+    };
+
+    float m_delta_time;
+    uint32_t m_frame=0;
+    std::vector<key_press> m_presses;
+};
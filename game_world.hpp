@@ -8,6 +8,8 @@ public:
     game_world();
     game_world(const std::string& p_tag);
 
+    [[nodiscard]] main_scene& first_scene() { return *m_first_scene; }
+
 private:
     atlas::ref<atlas::world_scope> m_main_world;
     atlas::ref<main_scene> m_first_scene;
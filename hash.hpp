@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+/**
+ * @brief 64-bit FNV-1a, used for cache keys and precomputed string IDs
+ *
+ * Not a cryptographic hash, only meant for detecting content changes and for
+ * hashing short keys.
+ */
+constexpr uint64_t fnv1a_offset_basis = 0xcbf29ce484222325ull;
+constexpr uint64_t fnv1a_prime = 0x100000001b3ull;
+
+constexpr uint64_t fnv1a(std::string_view p_value, uint64_t p_seed = fnv1a_offset_basis) {
+    uint64_t hash = p_seed;
+    for(char c : p_value) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= fnv1a_prime;
+    }
+    return hash;
+}
+
+inline uint64_t fnv1a(std::span<const std::byte> p_bytes, uint64_t p_seed = fnv1a_offset_basis) {
+    uint64_t hash = p_seed;
+    for(std::byte b : p_bytes) {
+        hash ^= static_cast<uint8_t>(b);
+        hash *= fnv1a_prime;
+    }
+    return hash;
+}
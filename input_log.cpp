@@ -0,0 +1,344 @@
+#include "input_log.hpp"
+#include "hash.hpp"
+#include "mapped_file.hpp"
+#include <core/engine_logger.hpp>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+namespace {
+    static_assert(std::endian::native == std::endian::little, "input logs are stored little-endian");
+
+    constexpr size_t header_size = 4 + 2 + 2 + 4 + 4 + 4;
+    constexpr size_t frame_size = 4 + 2;
+    constexpr size_t sample_size = 1 + 1 + 2 + 4;
+    constexpr size_t checksum_size = 4 + 8;
+
+    template<typename T>
+    void put(std::vector<std::byte>& p_out, const T& p_value) {
+        const auto* bytes = reinterpret_cast<const std::byte*>(&p_value);
+        p_out.insert(p_out.end(), bytes, bytes + sizeof(T));
+    }
+
+    //! bounds-checked reads out of the mapped file
+    class reader {
+    public:
+        reader(std::span<const std::byte> p_bytes) : m_bytes(p_bytes) {}
+
+        template<typename T>
+        bool get(T& p_value) {
+            if(m_offset + sizeof(T) > m_bytes.size()) {
+                return false;
+            }
+            std::memcpy(&p_value, m_bytes.data() + m_offset, sizeof(T));
+            m_offset += sizeof(T);
+            return true;
+        }
+
+        [[nodiscard]] size_t remaining() const { return m_bytes.size() - m_offset; }
+
+    private:
+        std::span<const std::byte> m_bytes;
+        size_t m_offset=0;
+    };
+
+    bool same_query(const input_log::sample& p_a, const input_log::sample& p_b) {
+        return p_a.kind == p_b.kind and p_a.device == p_b.device and p_a.code == p_b.code;
+    }
+}
+
+void input_log::push_frame(float p_delta_time) {
+    m_frames.push_back({ p_delta_time, static_cast<uint32_t>(m_samples.size()), 0 });
+}
+
+void input_log::add_sample(const sample& p_sample) {
+    if(m_frames.empty()) {
+        return;
+    }
+
+    frame& current = m_frames.back();
+    auto stored = std::span(m_samples).subspan(current.first_sample, current.sample_count);
+    if(std::ranges::any_of(stored, [&](const sample& p_stored) { return same_query(p_stored, p_sample); })) {
+        return;
+    }
+
+    m_samples.push_back(p_sample);
+    current.sample_count++;
+}
+
+void input_log::add_checksum(uint64_t p_value) {
+    if(!m_frames.empty()) {
+        m_checksums.push_back({ frame_count() - 1, p_value });
+    }
+}
+
+std::span<const input_log::sample> input_log::samples(uint32_t p_frame) const {
+    const frame& entry = m_frames[p_frame];
+    return std::span(m_samples).subspan(entry.first_sample, entry.sample_count);
+}
+
+std::optional<uint64_t> input_log::checksum_at(uint32_t p_frame) const {
+    auto it = std::ranges::lower_bound(m_checksums, p_frame, {}, &checksum::frame);
+    if(it == m_checksums.end() or it->frame != p_frame) {
+        return std::nullopt;
+    }
+    return it->value;
+}
+
+bool input_log::save(const std::filesystem::path& p_path) const {
+    std::vector<std::byte> data;
+    data.reserve(header_size + m_frames.size() * frame_size + m_samples.size() * sample_size + m_checksums.size() * checksum_size);
+
+    put(data, magic);
+    put(data, version);
+    put(data, uint16_t(0));
+    put(data, frame_count());
+    put(data, static_cast<uint32_t>(m_samples.size()));
+    put(data, static_cast<uint32_t>(m_checksums.size()));
+
+    for(const frame& entry : m_frames) {
+        put(data, entry.delta_time);
+        put(data, static_cast<uint16_t>(entry.sample_count));
+        for(uint32_t i = 0; i < entry.sample_count; i++) {
+            const sample& item = m_samples[entry.first_sample + i];
+            put(data, static_cast<uint8_t>(item.kind));
+            put(data, item.device);
+            put(data, item.code);
+            put(data, item.value);
+        }
+    }
+
+    for(const checksum& entry : m_checksums) {
+        put(data, entry.frame);
+        put(data, entry.value);
+    }
+
+    std::ofstream file(p_path, std::ios::binary);
+    if(!file) {
+        console_log_error("Could not open {} for writing", p_path.string());
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(file);
+}
+
+bool input_log::load(const std::filesystem::path& p_path) {
+    clear();
+
+    mapped_file file(p_path);
+    if(!file.is_open()) {
+        console_log_error("Could not open input log {}", p_path.string());
+        return false;
+    }
+
+    reader in(file.bytes());
+    uint32_t file_magic = 0;
+    uint16_t file_version = 0;
+    uint16_t reserved = 0;
+    uint32_t frames = 0;
+    uint32_t samples = 0;
+    uint32_t checksums = 0;
+    if(!in.get(file_magic) or !in.get(file_version) or !in.get(reserved) or !in.get(frames) or !in.get(samples) or !in.get(checksums) or
+       file_magic != magic or file_version != version) {
+        console_log_error("{} is not an input log this build can read", p_path.string());
+        return false;
+    }
+
+    // the counts size the reserves below, a corrupt header must not turn into a huge allocation
+    uint64_t body_size = uint64_t(frames) * frame_size + uint64_t(samples) * sample_size + uint64_t(checksums) * checksum_size;
+    if(body_size > in.remaining()) {
+        console_log_error("Input log {} is truncated", p_path.string());
+        return false;
+    }
+
+    m_frames.reserve(frames);
+    m_samples.reserve(samples);
+    m_checksums.reserve(checksums);
+
+    bool valid = true;
+    for(uint32_t i = 0; i < frames and valid; i++) {
+        float delta_time = 0.f;
+        uint16_t count = 0;
+        valid = in.get(delta_time) and in.get(count);
+        push_frame(delta_time);
+
+        for(uint16_t j = 0; j < count and valid; j++) {
+            uint8_t kind = 0;
+            sample item;
+            valid = in.get(kind) and in.get(item.device) and in.get(item.code) and in.get(item.value);
+            item.kind = static_cast<sample_kind>(kind);
+            m_samples.push_back(item);
+            m_frames.back().sample_count++;
+        }
+    }
+
+    for(uint32_t i = 0; i < checksums and valid; i++) {
+        checksum entry;
+        valid = in.get(entry.frame) and in.get(entry.value);
+        m_checksums.push_back(entry);
+    }
+
+    if(!valid) {
+        console_log_error("Input log {} is truncated", p_path.string());
+        clear();
+        return false;
+    }
+    if(m_samples.size() != samples) {
+        console_log_error("Input log {} holds {} samples, its header says {}", p_path.string(), m_samples.size(), samples);
+        clear();
+        return false;
+    }
+    return true;
+}
+
+void input_log::clear() {
+    m_frames.clear();
+    m_samples.clear();
+    m_checksums.clear();
+}
+
+uint64_t state_checksum::compute(flecs::world& p_registry) {
+    if(m_query_world != p_registry.c_ptr()) {
+        m_query = p_registry.query_builder<const atlas::transform, const atlas::physics_body>().cached().build();
+        m_query_world = p_registry.c_ptr();
+    }
+
+    // summed so the result does not depend on table or iteration order
+    uint64_t sum = 0;
+    uint64_t count = 0;
+    m_query.each([&](flecs::entity p_entity, const atlas::transform& p_transform, const atlas::physics_body& p_body) {
+        auto name = p_entity.name();
+        flecs::entity_t id = p_entity.id();
+        uint64_t hash = (name.c_str() != nullptr and name.c_str()[0] != '\0') ? fnv1a(name.c_str()) : fnv1a(std::as_bytes(std::span(&id, 1)));
+
+        const glm::vec3 values[] = {
+            p_transform.position, p_transform.rotation, p_transform.scale, p_body.linear_velocity, p_body.angular_velocity,
+        };
+        hash = fnv1a(std::as_bytes(std::span(values)), hash);
+        hash = fnv1a(std::as_bytes(std::span(&p_transform.quaternion, 1)), hash);
+        sum += hash;
+        count++;
+    });
+    return fnv1a(std::as_bytes(std::span(&count, 1)), sum);
+}
+
+input_recorder::input_recorder(frame_input& p_source, uint32_t p_checksum_interval)
+  : m_source(&p_source), m_checksum_interval(std::max<uint32_t>(p_checksum_interval, 1)) {}
+
+void input_recorder::begin_frame() {
+    m_log.push_frame(m_source->delta_time());
+}
+
+void input_recorder::end_frame(flecs::world& p_registry) {
+    if(m_log.frame_count() > 0 and (m_log.frame_count() - 1) % m_checksum_interval == 0) {
+        m_log.add_checksum(m_checksum.compute(p_registry));
+    }
+}
+
+float input_recorder::delta_time() const {
+    // the frame's dt is fixed when it begins, gameplay may read it several times
+    return m_log.frame_count() > 0 ? m_log.delta_time(m_log.frame_count() - 1) : m_source->delta_time();
+}
+
+bool input_recorder::is_key_pressed(int32_t p_key) const {
+    bool pressed = m_source->is_key_pressed(p_key);
+    if(pressed) {
+        m_log.add_sample({ input_log::sample_kind::key, 0, static_cast<uint16_t>(p_key), 1.f });
+    }
+    return pressed;
+}
+
+bool input_recorder::is_mouse_pressed(int32_t p_button) const {
+    bool pressed = m_source->is_mouse_pressed(p_button);
+    if(pressed) {
+        m_log.add_sample({ input_log::sample_kind::mouse_button, 0, static_cast<uint16_t>(p_button), 1.f });
+    }
+    return pressed;
+}
+
+bool input_recorder::is_joystick_present(int32_t p_joystick) const {
+    bool present = m_source->is_joystick_present(p_joystick);
+    if(present) {
+        m_log.add_sample({ input_log::sample_kind::joystick_present, static_cast<uint8_t>(p_joystick), 0, 1.f });
+    }
+    return present;
+}
+
+float input_recorder::joystick_axis(int32_t p_joystick, int32_t p_axis) const {
+    float value = m_source->joystick_axis(p_joystick, p_axis);
+    if(value != 0.f) {
+        m_log.add_sample({ input_log::sample_kind::joystick_axis, static_cast<uint8_t>(p_joystick), static_cast<uint16_t>(p_axis), value });
+    }
+    return value;
+}
+
+bool input_recorder::is_joystick_button_pressed(int32_t p_joystick, int32_t p_button) const {
+    bool pressed = m_source->is_joystick_button_pressed(p_joystick, p_button);
+    if(pressed) {
+        m_log.add_sample({ input_log::sample_kind::joystick_button, static_cast<uint8_t>(p_joystick), static_cast<uint16_t>(p_button), 1.f });
+    }
+    return pressed;
+}
+
+input_replay::input_replay(input_log p_log) : m_log(std::move(p_log)) {}
+
+bool input_replay::end_frame(flecs::world& p_registry) {
+    if(m_frame >= m_log.frame_count()) {
+        return true;
+    }
+
+    std::optional<uint64_t> expected = m_log.checksum_at(m_frame);
+    if(!expected) {
+        return true;
+    }
+
+    m_checked++;
+    if(m_checksum.compute(p_registry) == *expected) {
+        return true;
+    }
+
+    m_diverged++;
+    if(!m_first_divergence) {
+        m_first_divergence = m_frame;
+    }
+    return false;
+}
+
+float input_replay::find(input_log::sample_kind p_kind, int32_t p_device, int32_t p_code) const {
+    if(m_frame >= m_log.frame_count()) {
+        return 0.f;
+    }
+
+    for(const input_log::sample& item : m_log.samples(m_frame)) {
+        if(item.kind == p_kind and item.device == p_device and item.code == p_code) {
+            return item.value;
+        }
+    }
+    return 0.f;
+}
+
+float input_replay::delta_time() const {
+    return m_frame < m_log.frame_count() ? m_log.delta_time(m_frame) : 0.f;
+}
+
+bool input_replay::is_key_pressed(int32_t p_key) const {
+    return find(input_log::sample_kind::key, 0, p_key) != 0.f;
+}
+
+bool input_replay::is_mouse_pressed(int32_t p_button) const {
+    return find(input_log::sample_kind::mouse_button, 0, p_button) != 0.f;
+}
+
+bool input_replay::is_joystick_present(int32_t p_joystick) const {
+    return find(input_log::sample_kind::joystick_present, p_joystick, 0) != 0.f;
+}
+
+float input_replay::joystick_axis(int32_t p_joystick, int32_t p_axis) const {
+    return find(input_log::sample_kind::joystick_axis, p_joystick, p_axis);
+}
+
+bool input_replay::is_joystick_button_pressed(int32_t p_joystick, int32_t p_button) const {
+    return find(input_log::sample_kind::joystick_button, p_joystick, p_button) != 0.f;
+}
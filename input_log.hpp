@@ -0,0 +1,205 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <vector>
+#include <flecs.h>
+#include <core/scene/components.hpp>
+#include <physics/components.hpp>
+#include "frame_input.hpp"
+
+/**
+ * @name input_log
+ * @brief Per-frame input of a session, saved as a compact binary file
+ *
+ * Each frame stores its delta time and only the inputs that were queried
+ * and active that frame (pressed keys and buttons, connected joysticks,
+ * non-zero axes), so an idle frame costs 6 bytes. Every few frames a
+ * checksum of the simulated state is stored next to the input, replays
+ * compare against it to find the first frame where a run diverged.
+ *
+ * File layout (little-endian, no padding):
+ *
+ *  [header]
+ *  per frame:  [float delta_time][uint16 sample_count][sample x sample_count]
+ *  sample:     [uint8 kind][uint8 device][uint16 code][float value]
+ *  [checksum x checksum_count]: [uint32 frame][uint64 value]
+ */
+class input_log {
+public:
+    static constexpr uint32_t magic = 0x4E495441; // "ATIN"
+    static constexpr uint16_t version = 1;
+
+    enum class sample_kind : uint8_t {
+        key = 1,
+        mouse_button,
+        joystick_present,
+        joystick_button,
+        joystick_axis,
+    };
+
+    struct sample {
+        sample_kind kind{};
+        uint8_t device=0;
+        uint16_t code=0;
+        float value=0.f;
+    };
+
+    struct checksum {
+        uint32_t frame=0;
+        uint64_t value=0;
+    };
+
+    //! @brief Starts a new frame, the samples added after it belong to that frame
+    void push_frame(float p_delta_time);
+
+    //! @brief Adds p_sample to the last frame unless an identical query was already stored
+    void add_sample(const sample& p_sample);
+
+    //! @brief Stores a state checksum for the last frame
+    void add_checksum(uint64_t p_value);
+
+    [[nodiscard]] uint32_t frame_count() const { return static_cast<uint32_t>(m_frames.size()); }
+
+    [[nodiscard]] float delta_time(uint32_t p_frame) const { return m_frames[p_frame].delta_time; }
+
+    [[nodiscard]] std::span<const sample> samples(uint32_t p_frame) const;
+
+    //! @return the checksum stored for p_frame, if any
+    [[nodiscard]] std::optional<uint64_t> checksum_at(uint32_t p_frame) const;
+
+    [[nodiscard]] std::span<const checksum> checksums() const { return m_checksums; }
+
+    bool save(const std::filesystem::path& p_path) const;
+
+    bool load(const std::filesystem::path& p_path);
+
+    void clear();
+
+private:
+    struct frame {
+        float delta_time=0.f;
+        uint32_t first_sample=0;
+        uint32_t sample_count=0;
+    };
+
+    std::vector<frame> m_frames;
+    std::vector<sample> m_samples;
+    // sorted by frame, frames are only ever appended
+    std::vector<checksum> m_checksums;
+};
+
+/**
+ * @name state_checksum
+ * @brief Order-independent hash of every physics_body entity's transform and velocities
+ *
+ * Entities are identified by name (by id when unnamed) so a run that
+ * creates editor-only entities in a different order still matches.
+ */
+class state_checksum {
+public:
+    uint64_t compute(flecs::world& p_registry);
+
+private:
+    flecs::query<const atlas::transform, const atlas::physics_body> m_query;
+    flecs::world_t* m_query_world=nullptr;
+};
+
+/**
+ * @name input_recorder
+ * @brief Passes another frame_input through and logs what gameplay read from it
+ *
+ * Call begin_frame() before the first query of every frame and end_frame()
+ * after the frame's simulation ran.
+ */
+class input_recorder : public frame_input {
+public:
+    //! Frames between two state checksums, frame 0 is always checked
+    static constexpr uint32_t default_checksum_interval = 60;
+
+    input_recorder(frame_input& p_source, uint32_t p_checksum_interval = default_checksum_interval);
+
+    void begin_frame();
+
+    void end_frame(flecs::world& p_registry);
+
+    [[nodiscard]] frame_input& source() const { return *m_source; }
+
+    [[nodiscard]] const input_log& log() const { return m_log; }
+
+    [[nodiscard]] float delta_time() const override;
+
+    [[nodiscard]] bool is_key_pressed(int32_t p_key) const override;
+
+    [[nodiscard]] bool is_mouse_pressed(int32_t p_button) const override;
+
+    [[nodiscard]] bool is_joystick_present(int32_t p_joystick) const override;
+
+    [[nodiscard]] float joystick_axis(int32_t p_joystick, int32_t p_axis) const override;
+
+    [[nodiscard]] bool is_joystick_button_pressed(int32_t p_joystick, int32_t p_button) const override;
+
+private:
+    frame_input* m_source;
+    uint32_t m_checksum_interval;
+    // queries are const, recording them is not part of the observable state
+    mutable input_log m_log;
+    state_checksum m_checksum;
+};
+
+/**
+ * @name input_replay
+ * @brief Answers input queries from a recorded input_log
+ *
+ * Anything the log does not hold for the current frame reads as released,
+ * zero or disconnected. end_frame() compares the state checksum wherever
+ * the recording stored one.
+ */
+class input_replay : public frame_input {
+public:
+    input_replay(input_log p_log);
+
+    void set_frame(uint32_t p_frame) { m_frame = p_frame; }
+
+    [[nodiscard]] uint32_t frame() const { return m_frame; }
+
+    [[nodiscard]] uint32_t frame_count() const { return m_log.frame_count(); }
+
+    /**
+     * @brief Checks the simulated state of the current frame against the recording
+     *
+     * @return false if the frame has a recorded checksum and it differs
+     */
+    bool end_frame(flecs::world& p_registry);
+
+    [[nodiscard]] uint32_t checked_frames() const { return m_checked; }
+
+    [[nodiscard]] uint32_t diverged_frames() const { return m_diverged; }
+
+    //! @return the first frame whose checksum differed, if any
+    [[nodiscard]] std::optional<uint32_t> first_divergence() const { return m_first_divergence; }
+
+    [[nodiscard]] float delta_time() const override;
+
+    [[nodiscard]] bool is_key_pressed(int32_t p_key) const override;
+
+    [[nodiscard]] bool is_mouse_pressed(int32_t p_button) const override;
+
+    [[nodiscard]] bool is_joystick_present(int32_t p_joystick) const override;
+
+    [[nodiscard]] float joystick_axis(int32_t p_joystick, int32_t p_axis) const override;
+
+    [[nodiscard]] bool is_joystick_button_pressed(int32_t p_joystick, int32_t p_button) const override;
+
+private:
+    [[nodiscard]] float find(input_log::sample_kind p_kind, int32_t p_device, int32_t p_code) const;
+
+private:
+    input_log m_log;
+    uint32_t m_frame=0;
+    state_checksum m_checksum;
+    uint32_t m_checked=0;
+    uint32_t m_diverged=0;
+    std::optional<uint32_t> m_first_divergence;
+};
@@ -1,15 +1,29 @@
 #include "main_scene.hpp"
+#include "binary_scene.hpp"
+#include "frame_arena.hpp"
 #include <core/common.hpp>
 #include <core/math/utilities.hpp>
 #include <core/application.hpp>
 #include <core/event/event.hpp>
 #include <drivers/jolt-cpp/jolt_components.hpp>
+#include <imgui.h>
 #include <any>
-#include <thread>
 #include <chrono>
 
+namespace {
+    // looked up by hash at runtime, the paths are only needed when loading
+    constexpr sound_id contact_sound = make_sound_id("Resources/rolling_ball_on_wood.mp3");
+    constexpr sound_id background_music = make_sound_id("Resources/BabyElephantWalk60.wav");
+    constexpr const char* input_recording_path = "session.inputlog";
+}
+
 main_scene::main_scene(const std::string& p_tag, atlas::event::event_bus& p_bus)
-  : atlas::scene_scope(p_tag, p_bus) {
+  : atlas::scene_scope(p_tag, p_bus)
+  , m_mesh_cache(".cache/meshes", shared_thread_pool())
+  , m_texture_cache(".cache/textures", shared_thread_pool())
+  , m_level_loader(shared_thread_pool(), m_mesh_cache, m_texture_cache) {
+    // the scene is built on the thread that runs its callbacks
+    PROFILE_THREAD_NAME("main");
 
     m_camera = create_object("camera");
 
@@ -56,6 +70,12 @@ main_scene::main_scene(const std::string& p_tag, atlas::event::event_bus& p_bus)
         .texture_path = "assets/models/Tiles074_8K-JPG_Color.jpg"
     });
     m_cube->add<atlas::tag::serialize>();
+    m_cube->set<charger>({
+        .speed = 8.f,
+        .trigger_distance = 5.f,
+        .miss_distance = 20.f,
+        .hit_distance = 2.f,
+    });
 
     m_platform = create_object("Platform");
 
@@ -80,6 +100,7 @@ main_scene::main_scene(const std::string& p_tag, atlas::event::event_bus& p_bus)
 
     m_sphere = create_object("Sphere");
     m_sphere->add<atlas::tag::serialize>();
+    m_sphere->add<charge_target>();
 
     m_sphere->set<atlas::transform>({
         .position = {-2.70f, 2.70, -8.30f},
@@ -156,6 +177,25 @@ main_scene::main_scene(const std::string& p_tag, atlas::event::event_bus& p_bus)
     subscribe<atlas::event::collision_persisted>(this, &main_scene::collision_persisted);
     subscribe<atlas::event::collision_exit>(this, &main_scene::collision_removed);
 
+    // handlers below only see pairs their filter accepts
+    m_collisions.on<atlas::event::collision_persisted>(collision_filter().entity(m_sphere->id()),
+                                                       [this](atlas::event::collision_persisted&, const collision_match&) {
+        // This will only ever play the audio whenever the ball has made contact with the platform
+        // The sound is loaded with a single instance so persisted contacts do not stack it
+        m_audio.play(contact_sound);
+    });
+
+    // batched mode: the same behavior, one call per physics frame over every contact
+    m_collision_stream.subscribe([this](const collision_batch& p_batch) {
+        flecs::entity_t sphere = m_sphere->id();
+        for(size_t i = 0; i < p_batch.size(); i++) {
+            if(p_batch.kinds[i] == contact_kind::persisted and (p_batch.entity1[i] == sphere or p_batch.entity2[i] == sphere)) {
+                m_audio.play(contact_sound);
+                break;
+            }
+        }
+    });
+
 
     // game state behavior
     // registration update callbacks for offloading your own game logic
@@ -168,15 +208,76 @@ main_scene::main_scene(const std::string& p_tag, atlas::event::event_bus& p_bus)
 void main_scene::reset_objects() {
     
     // When we reload the simulation we load in all objects correlated to that particular scene
+    load_level();
+}
+
+void main_scene::load_level() {
+    PROFILE_ZONE("main_scene::load_level");
+    // hot reloads diff against the text the world is loaded from
+    m_level_reload.track("LevelScene");
+
+    // LevelScene is baked into LevelScene.bin whenever the YAML is newer, so
+    // only the first load after an edit pays for the text parse
+    if(bake_binary_scene("LevelScene", "LevelScene.bin")) {
+        binary_scene level("LevelScene.bin");
+        if(level.is_valid()) {
+            flecs::world registry = *this;
+            level.apply(registry);
+            return;
+        }
+    }
+
+    console_log_warn("Binary LevelScene unavailable, falling back to YAML");
     m_deserializer_test = atlas::serializer();
     if(!m_deserializer_test.load("LevelScene", *this)) {
         console_log_error("Cannot load LevelScene!!!");
     }
+}
 
 
+void main_scene::hot_reload_level() {
+    PROFILE_ZONE("main_scene::hot_reload_level");
+    flecs::world registry = *this;
+    auto start = std::chrono::steady_clock::now();
+    scene_patch patch;
+    if(!m_level_reload.reload(registry, patch) or patch.empty()) {
+        return;
+    }
 
-}
+    // only entities whose material changed look their mesh and texture up again
+    registry.defer_begin();
+    for(flecs::entity entity : patch.materials) {
+        const auto* material = entity.get<atlas::material>();
+        if(material == nullptr) {
+            entity.remove<cached_mesh>();
+            entity.remove<cached_texture>();
+            continue;
+        }
+
+        if(m_render_data) {
+            if(auto mesh = m_mesh_cache.get(material->model_path)) {
+                entity.set<cached_mesh>({ std::move(mesh) });
+            }
+            else {
+                entity.remove<cached_mesh>();
+            }
+        }
+
+        if(m_render_data) {
+            if(!material->texture_path.empty()) {
+                entity.set<cached_texture>({ m_texture_cache.get(material->texture_path) });
+            }
+            else {
+                entity.remove<cached_texture>();
+            }
+        }
+    }
+    registry.defer_end();
 
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    console_log_info("Hot reloaded LevelScene: {} created, {} destroyed, {} changed ({} components) in {} us",
+                     patch.created, patch.destroyed, patch.changed, patch.components, elapsed.count());
+}
 
 void edit_transform(atlas::transform* p_transform) {
     atlas::ui::draw_vec3("Position", p_transform->position);
@@ -185,6 +286,15 @@ void edit_transform(atlas::transform* p_transform) {
 }
 
 void main_scene::collision_enter(atlas::event::collision_enter& p_event) {
+    PROFILE_ZONE("collision_enter");
+    if(m_batched_collisions) {
+        m_collision_stream.push(p_event);
+        return;
+    }
+
+    flecs::world registry = *this;
+    m_collisions.dispatch(registry, p_event);
+
     // console_log_warn("Collision Enter happened!!! Executed from main_scene::collision_enter"); 
     // console_log_info("main_scene::collision_enter happened!");
 
@@ -197,122 +307,219 @@ void main_scene::collision_enter(atlas::event::collision_enter& p_event) {
 }
 
 void main_scene::collision_persisted(atlas::event::collision_persisted& p_event) {
-    flecs::world registry = *this;
-    
-    // Something TODO -- Is having ways to distinguish and only give you specific entities you want collision_persisted to give you
-    // Rather then having to do these state-checks
-    flecs::entity e1 = registry.entity(p_event.entity1);
-    flecs::entity e2 = registry.entity(p_event.entity2);
-
-    if(e1.name() == "Sphere" || e2.name() == "Sphere") {
-        // This will only ever play the audio whenever the ball has made contact with the platform
-        
-        std::string sound_file = "Resources/ball-in-hole-99750.mp3";
-
-        console_log_warn("m_is_audio_playing.load() = {}", m_is_audio_playing.load());
-        if(!m_is_audio_playing.load()) {
-            std::lock_guard<std::mutex> lock(m_audio_mutex);
-            m_is_audio_playing = true;
-            m_stop_audio_thread = false;
-
-            console_log_info("Starting audio thread!!");
+    PROFILE_ZONE("collision_persisted");
+    if(m_batched_collisions) {
+        m_collision_stream.push(p_event);
+        return;
+    }
 
-            // We create a separate thread that runs in the background
-            m_audio_thread = std::thread([this, sound_file](){
+    flecs::world registry = *this;
+    m_collisions.dispatch(registry, p_event);
+}
 
-                ma_result result;
-                ma_sound sound;
+void main_scene::collision_removed(atlas::event::collision_exit& p_event) {
+    PROFILE_ZONE("collision_removed");
+    console_log_info("collision_exit called!!!");
 
-                result = ma_sound_init_from_file(&m_audio_engine, sound_file.c_str(), 0, nullptr, nullptr, &sound);
-                if (result != MA_SUCCESS) {
-                    return;
-                }
+    if(m_batched_collisions) {
+        m_collision_stream.push(p_event);
+        return;
+    }
 
-                result = ma_sound_start(&sound);
-                if (result != MA_SUCCESS) {
-                    ma_sound_uninit(&sound);
-                    return;
-                }
+    flecs::world registry = *this;
+    m_collisions.dispatch(registry, p_event);
+}
 
-                while (ma_sound_is_playing(&sound) and !m_stop_audio_thread.load()) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                }
+void main_scene::use_headless_input(frame_input& p_input) {
+    m_input = &p_input;
+    m_headless = true;
+}
 
-                ma_sound_uninit(&sound);
-            });
+void main_scene::enable_render_data() {
+    m_render_data = true;
+}
 
-            // we detach this audio thread from the game-thread (main) to play in the background
-            m_audio_thread.detach();
-        }
+void main_scene::start_input_recording() {
+    if(m_recorder) {
+        return;
     }
+    m_recorder = std::make_unique<input_recorder>(*m_input);
+    m_input = m_recorder.get();
 }
 
-void main_scene::collision_removed(atlas::event::collision_exit& p_event) {
-    console_log_info("collision_exit called!!!");
+void main_scene::stop_input_recording(const std::filesystem::path& p_path) {
+    if(!m_recorder) {
+        return;
+    }
+
+    m_input = &m_recorder->source();
+    if(m_recorder->log().save(p_path)) {
+        console_log_info("Recorded {} frames of input to {}, replay with game-template-headless --replay", m_recorder->log().frame_count(), p_path.string());
+    }
+    m_recorder.reset();
 }
 
 void main_scene::start_game() {
+    PROFILE_ZONE("main_scene::start_game");
     // we just initialize the audio engine -- I am just doing this for funsies and experiementation
-    ma_result res = ma_engine_init(nullptr, &m_audio_engine);
+    // device start-up can take a while, so it happens on a worker; nothing plays before runtime_start waits for it
+    audio_settings audio;
+    audio.headless = m_headless;
+    m_audio_ready = shared_thread_pool().submit([this, audio]() {
+        if(m_audio.initialize(audio)) {
+            // short effects are decoded once into the bank, long clips like these are streamed
+            m_audio.load("Resources/rolling_ball_on_wood.mp3");
+            m_audio.load("Resources/BabyElephantWalk60.wav", { .mode = sound_load_desc::load_mode::streamed, .looping = true });
+        }
+    });
 
-    if(res != MA_SUCCESS) {
-        console_log_error("Could not initialize ma_engine!!!");
+    flecs::world registry = *this;
+    m_names.attach(registry);
+    if(m_render_data) {
+        m_visibility.attach(registry);
+        m_batches.attach(registry);
     }
-    
-    m_deserializer_test = atlas::serializer();
-    if(!m_deserializer_test.load("LevelScene", *this)) {
-        console_log_error("Cannot load LevelScene!!!");
+    m_panels = editor_panel(*this, *event_handle());
+
+    // the level parses and its models load on the thread pool while frames keep rendering,
+    // on_update commits it once everything is staged
+    m_level_loader.resolve_meshes(m_render_data);
+    m_level_loader.resolve_textures(m_render_data);
+    m_level_loader.start("LevelScene", "LevelScene.bin");
+    if(m_headless) {
+        // headless runs start the simulation on their first frame, the level has to be there
+        if(m_level_loader.wait() != scene_load_stage::ready) {
+            console_log_error("LevelScene failed to load, the headless run has no level");
+            return;
+        }
+        commit_level();
     }
+}
 
-    m_cube_initial_transform = *m_cube->get<atlas::transform>();
-    m_panels = editor_panel(*this, *event_handle());
+void main_scene::commit_level() {
+    PROFILE_ZONE("main_scene::commit_level");
+    flecs::world registry = *this;
+    auto start = std::chrono::steady_clock::now();
+    size_t count = m_level_loader.commit(registry).size();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    console_log_info("Committed {} entities of LevelScene in {} us", count, elapsed.count());
+
+    m_level_reload.track("LevelScene");
+    m_scene_watcher.watch("LevelScene");
 
+    // the physics engine is still built after the level is in the world, as it was before.
+    // It runs on Jolt's own threads: jolt_settings cannot take physics_job_system
     atlas::physics::jolt_settings settings = {};
-    flecs::world registry = *this;
     m_physics_engine_handler = atlas::physics::physics_engine(settings, registry, *event_handle());
+    m_level_loaded = true;
 }
 
 void main_scene::runtime_start() {
     // Make sure we can run the simulation
     // This will get replaced by a play button in the editor panel
     m_physics_is_runtime = true;
+    if(m_audio_ready.valid()) {
+        m_audio_ready.get();
+    }
 
+    // capture the editor state so runtime_stop can put everything back without touching disk
+    flecs::world registry = *this;
+    m_runtime_snapshot.capture(registry);
+
+    charger_system::arm(registry);
+    m_physics_clock.reset();
+    m_physics_interpolation.reset(registry);
     m_physics_engine_handler.start();
+    m_audio.play(background_music, 0.5f);
 }
 
 void main_scene::runtime_stop() {
     m_physics_is_runtime = false;
-    m_stop_audio_thread = true;
-    m_is_audio_playing = false;
 
     m_physics_engine_handler.stop();
 
-
     // resetting audio
     // when stopping simulation
-    if(m_stop_audio_thread.load()) {
-        if(m_audio_thread.joinable()) {
-            console_log_warn("Joining audio thread!!");
-            m_audio_thread.join();
-        }
+    m_audio.stop_all();
+
+    if(m_runtime_snapshot.empty()) {
+        reset_objects();
+        return;
     }
-    reset_objects();
+
+    flecs::world registry = *this;
+    auto start = std::chrono::steady_clock::now();
+    uint32_t written = m_runtime_snapshot.restore(registry);
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    console_log_info("Restored {} components from snapshot in {} us", written, elapsed.count());
 }
 
 void
 main_scene::on_ui_update() {
+    PROFILE_ZONE("main_scene::on_ui_update");
     m_panels.render_properties_panel();
+#if GAME_TEMPLATE_PROFILER
+    m_profiler_panel.render();
+#endif
+
+    // a hot reload can leave the cube without its charger
+    if(auto* cube_charger = m_cube->get_mut<charger>()) {
+        atlas::ui::draw_float("Trigger Distance", cube_charger->trigger_distance);
+    }
+    ImGui::Checkbox("Batch Collision Events", &m_batched_collisions);
+
+    if(ImGui::Button(m_recorder ? "Stop Input Recording" : "Record Input")) {
+        if(m_recorder) {
+            stop_input_recording(input_recording_path);
+        }
+        else {
+            start_input_recording();
+        }
+    }
+
+    if(m_render_data) {
+        const visibility_system::frame_stats& visibility = m_visibility.stats();
+        ImGui::Text("Visible: %u / %u (LOD %u / %u / %u / %u)", visibility.visible, visibility.renderables,
+                    visibility.per_lod[0], visibility.per_lod[1], visibility.per_lod[2], visibility.per_lod[3]);
+        const render_batcher::frame_stats& batches = m_batches.stats();
+        ImGui::Text("Batches: %u draws for %u instances", batches.batches, batches.instances);
+    }
 
-    atlas::ui::draw_float("Trigger Distance", m_cube_trigger_distance);
+    if(m_level_loader.busy()) {
+        ImGui::ProgressBar(m_level_loader.progress(), ImVec2(-1.f, 0.f), "Loading LevelScene");
+    }
 }
 
 void
 main_scene::on_update() {
+    // on_update runs first every frame, so it also opens the profiler frame
+    // and hands back last frame's transient memory
+    PROFILE_FRAME();
+    PROFILE_ZONE("main_scene::on_update");
+    frame_memory().reset();
+    if(m_recorder) {
+        m_recorder->begin_frame();
+    }
+
+    if(m_level_loader.busy() and m_level_loader.update() == scene_load_stage::ready) {
+        commit_level();
+    }
+
+    // a running simulation would be reset to its snapshot on stop anyway, so
+    // edits wait until it is stopped and then only touch the edited entities
+    if(!m_scene_watcher.poll().empty()) {
+        m_level_changed = true;
+    }
+    if(m_level_changed and m_level_loaded and !m_physics_is_runtime) {
+        m_level_changed = false;
+        hot_reload_level();
+    }
+
     float smooth_speed = 0.1f;
     atlas::transform* camera_transform = m_camera->get_mut<atlas::transform>();
     atlas::transform* sphere_transform = m_sphere->get_mut<atlas::transform>();
 
-    float dt = atlas::application::delta_time();
+    float dt = m_input->delta_time();
     float movement_speed = 10.f;
     float rotation_speed = 1.f;
     float velocity = movement_speed * dt;
@@ -322,89 +529,142 @@ main_scene::on_update() {
     glm::vec3 forward = glm::rotate(quaternion, glm::vec3(0.f, 0.f, -1.f));
     glm::vec3 right = glm::rotate(quaternion, glm::vec3(1.0f, 0.0f, 0.0f));
 
-    if (atlas::event::is_key_pressed(key_left_shift)) {
-        if (atlas::event::is_mouse_pressed(mouse_button_middle)) {
+    if (m_input->is_key_pressed(key_left_shift)) {
+        if (m_input->is_mouse_pressed(mouse_button_middle)) {
             camera_transform->position += up * velocity;
         }
 
-        if (atlas::event::is_mouse_pressed(mouse_button_right)) {
+        if (m_input->is_mouse_pressed(mouse_button_right)) {
             camera_transform->position -= up * velocity;
         }
     }
 
-    if (atlas::event::is_key_pressed(key_w)) {
+    if (m_input->is_key_pressed(key_w)) {
         camera_transform->position += forward * velocity;
     }
-    if (atlas::event::is_key_pressed(key_s)) {
+    if (m_input->is_key_pressed(key_s)) {
         camera_transform->position -= forward * velocity;
     }
 
-    if (atlas::event::is_key_pressed(key_d)) {
+    if (m_input->is_key_pressed(key_d)) {
         camera_transform->position += right * velocity;
     }
-    if (atlas::event::is_key_pressed(key_a)) {
+    if (m_input->is_key_pressed(key_a)) {
         camera_transform->position -= right * velocity;
     }
 
-    if (atlas::event::is_key_pressed(key_q)) {
+    if (m_input->is_key_pressed(key_q)) {
         camera_transform->rotation.y += rotation_velocity;
     }
-    if (atlas::event::is_key_pressed(key_e)) {
+    if (m_input->is_key_pressed(key_e)) {
         camera_transform->rotation.y -= rotation_velocity;
     }
 
     camera_transform->set_rotation(camera_transform->rotation);
+
+    // stream texture mips for whichever camera is currently rendering
+    bool runtime_camera_active = m_runtime_camera->get<atlas::perspective_camera>()->is_active;
+    auto& active_camera = runtime_camera_active ? m_runtime_camera : m_camera;
+    flecs::world registry = *this;
+    if(m_render_data) {
+        m_texture_cache.update_streaming(registry,
+                                         active_camera->get<atlas::transform>()->position,
+                                         active_camera->get<atlas::perspective_camera>()->field_of_view,
+                                         m_streaming_viewport_height);
+    }
+
+    if(m_render_data) {
+        PROFILE_ZONE("visibility_system::cull");
+        m_visibility.sync(registry);
+        m_visibility.cull(*active_camera->get<atlas::transform>(), *active_camera->get<atlas::perspective_camera>(), m_viewport_aspect);
+    }
+
+    if(m_render_data) {
+        PROFILE_ZONE("render_batcher::build");
+        m_batches.build(registry, m_visibility.visible());
+    }
 }
 
-void main_scene::respawn() {
-    m_cube->set<atlas::transform>(m_cube_initial_transform);
-    m_cube_moving = false;
+void main_scene::fixed_update(float p_step) {
+    PROFILE_ZONE("main_scene::fixed_update");
+    flecs::world registry = *this;
+    m_conveyors.update(registry, p_step);
+
+    for(const charger_event& event : m_chargers.update(registry, p_step)) {
+        std::string_view chaser = m_names.view(event.entity);
+        switch(event.what) {
+        case charger_event::kind::started:
+            console_log_warn("{} is charging!", chaser);
+            break;
+        case charger_event::kind::hit:
+            console_log_warn("{} hit its target! Respawning...", chaser);
+            // a teleport should not be blended over a frame
+            m_physics_interpolation.snap();
+            break;
+        case charger_event::kind::missed:
+            console_log_warn("{} missed! Respawning...", chaser);
+            m_physics_interpolation.snap();
+            break;
+        }
+    }
 }
 
 void
 main_scene::on_physics_update() {
-    float dt = atlas::application::delta_time();
+    PROFILE_ZONE("main_scene::on_physics_update");
+    float dt = m_input->delta_time();
     atlas::physics_body* sphere_body = m_sphere->get_mut<atlas::physics_body>();
-    atlas::transform* cube_transform = m_cube->get_mut<atlas::transform>();
     atlas::transform* sphere_transform = m_sphere->get_mut<atlas::transform>();
     atlas::perspective_camera* editor_camera = m_camera->get_mut<atlas::perspective_camera>();
     atlas::perspective_camera* game_camera = m_runtime_camera->get_mut<atlas::perspective_camera>();
     atlas::transform* game_camera_transform = m_runtime_camera->get_mut<atlas::transform>();
 
-    if (atlas::event::is_key_pressed(key_r) and !m_physics_is_runtime) {
+    // the simulation can only start once the level is in the world
+    if (m_input->is_key_pressed(key_r) and !m_physics_is_runtime and m_level_loaded) {
         editor_camera->is_active = false;
         game_camera->is_active = true;
         runtime_start();
     }
 
     if(m_physics_is_runtime) {
-        m_physics_engine_handler.update(dt);
-
-        // Calculate direction from cube to sphere
-        glm::vec3 direction = sphere_transform->position - cube_transform->position;
-        float distance = glm::length(direction);
-        
-        if (!m_cube_charging && !m_has_charged && distance < m_cube_trigger_distance) {
-            m_cube_charging = true;
-            m_has_charged = true;
-            console_log_warn("Cube is charging at sphere!");
+        flecs::world registry = *this;
+
+        // physics only ever advances in fixed steps, a long frame runs more
+        // steps (up to max_substeps) instead of one large one
+        uint32_t steps = m_physics_clock.advance(dt);
+        if(steps > 0) {
+            m_physics_interpolation.restore(registry);
         }
-        
-        // Charge towards sphere if active
-        if (m_cube_charging) {
-            // Normalize direction and charge at full speed
-            if (distance > 0.1f) {  // Avoid division by zero
-                direction = glm::normalize(direction);
-                cube_transform->position += direction * m_cube_speed * dt;
+
+        for(uint32_t step = 0; step < steps; step++) {
+            if(step + 1 == steps) {
+                m_physics_interpolation.store_previous(registry);
             }
-            
-            // Check if cube missed (got too far from sphere)
-            if (distance > m_respawn_distance) {
-                console_log_warn("Cube missed! Respawning...");
-                respawn();
+            {
+                PROFILE_ZONE("physics_engine::update");
+                m_physics_engine_handler.update(m_physics_clock.step());
             }
+            fixed_update(m_physics_clock.step());
+        }
+
+        if(steps > 0) {
+            m_physics_interpolation.store_current(registry);
         }
+        // rendering sees the bodies blended between the last two steps
+        m_physics_interpolation.apply(registry, m_physics_clock.alpha());
+
+        // store_current may have added physics_pose to new bodies, which moves them between tables
+        sphere_body = m_sphere->get_mut<atlas::physics_body>();
+        sphere_transform = m_sphere->get_mut<atlas::transform>();
 
+        // contacts reported during the steps reach the batch handlers all at once
+        if(m_batched_collisions) {
+            PROFILE_ZONE("collision_stream::publish");
+            m_collision_stream.publish();
+        }
+        else {
+            m_collision_stream.discard();
+        }
 
         if(game_camera->is_active) {
             float camera_look_ahead_offset = 2.f;
@@ -423,7 +683,7 @@ main_scene::on_physics_update() {
             game_camera_transform->position = glm::mix(
                 game_camera_transform->position, 
                 target_position, 
-                follow_speed * atlas::application::delta_time()
+                follow_speed * m_input->delta_time()
             );
             
             // Look at sphere
@@ -447,15 +707,9 @@ main_scene::on_physics_update() {
             // game_camera_transform->rotation = {pitch, yaw, 0.f};
             // game_camera_transform->set_rotation(game_camera_transform->rotation);
         }
-        
-        // Check if cube hit the sphere (collision will be handled by collision events)
-        if (m_cube_charging && distance < 2.0f) {
-            console_log_warn("Cube hit sphere! Respawning...");
-            respawn();
-        }
     }
 
-    if (atlas::event::is_key_pressed(key_l) and m_physics_is_runtime) {
+    if (m_input->is_key_pressed(key_l) and m_physics_is_runtime) {
         runtime_stop();
         editor_camera->is_active = true;
         game_camera->is_active = false;
@@ -465,50 +719,54 @@ main_scene::on_physics_update() {
     // J = -up
     // H = +left
     // L = -Left
-    if(atlas::event::is_key_pressed(key_u)) {
+    if(m_input->is_key_pressed(key_u)) {
         glm::vec3 angular_vel = {0.f, 1.f, 0.f};
         sphere_body->angular_velocity = angular_vel;
     }
 
-    if(atlas::event::is_key_pressed(key_j)) {
+    if(m_input->is_key_pressed(key_j)) {
         glm::vec3 angular_vel = {0.f, -1.f, 0.f};
         sphere_body->angular_velocity = angular_vel;
     }
 
-    if(atlas::event::is_key_pressed(key_h)) {
+    if(m_input->is_key_pressed(key_h)) {
         glm::vec3 angular_vel = {1.f, 0.f, 0.f};
         sphere_body->angular_velocity = angular_vel;
     }
 
-    if(atlas::event::is_key_pressed(key_l)) {
+    if(m_input->is_key_pressed(key_l)) {
         glm::vec3 angular_vel = {-1.f, 0.f, 0.f};
         sphere_body->angular_velocity = angular_vel;
     }
 
-    if (atlas::event::is_key_pressed(key_space)) {
+    if (m_input->is_key_pressed(key_space)) {
         glm::vec3 linear_velocity = { 0.f, 10.0f, 0.f };
         sphere_body->linear_velocity = linear_velocity;
     }
 
     // checking if there is a controller device joystic connected
-    bool controller_connected = atlas::event::is_joystic_present(0);
+    bool controller_connected = m_input->is_joystick_present(0);
 
     if(controller_connected) {
         float speed = 10.f;
-        float left_joystick_x = atlas::event::get_joystic_axis(0, GLFW_GAMEPAD_AXIS_LEFT_X);
-        float left_joystick_y = atlas::event::get_joystic_axis(0, GLFW_GAMEPAD_AXIS_LEFT_Y);
-        float right_joystick_x = atlas::event::get_joystic_axis(0, GLFW_GAMEPAD_AXIS_RIGHT_X);
+        float left_joystick_x = m_input->joystick_axis(0, GLFW_GAMEPAD_AXIS_LEFT_X);
+        float left_joystick_y = m_input->joystick_axis(0, GLFW_GAMEPAD_AXIS_LEFT_Y);
+        float right_joystick_x = m_input->joystick_axis(0, GLFW_GAMEPAD_AXIS_RIGHT_X);
 
-        int button_count;
-        const unsigned char* buttons = glfwGetJoystickButtons(GLFW_JOYSTICK_1, &button_count);
         sphere_body->angular_velocity.x = left_joystick_x * 10;
         sphere_body->angular_velocity.y = glm::sin(right_joystick_x) * 10;
 
-        if(buttons[0] == GLFW_PRESS) {
+        if(m_input->is_joystick_button_pressed(GLFW_JOYSTICK_1, 0)) {
             glm::vec3 linear_velocity = { 0.f, 10.0f, 0.f };
             sphere_body->linear_velocity = linear_velocity;
             sphere_body->cumulative_force += 10.f;
         }
 
     }
+
+    // the frame's simulation is done, the recording stores a state checksum every so often
+    if(m_recorder) {
+        flecs::world registry = *this;
+        m_recorder->end_frame(registry);
+    }
 }
@@ -2,6 +2,8 @@
 #include <core/core.hpp>
 #include <core/scene/scene.hpp>
 #include <core/scene/scene_object.hpp>
+#include <filesystem>
+#include <memory>
 #include <string>
 #include <vector>
 #include <core/serialize/serializer.hpp>
@@ -10,6 +12,25 @@
 #include <core/event/types.hpp>
 #include "editor_panels.hpp"
 #include "sound.hpp"
+#include "audio_system.hpp"
+#include "scene_snapshot.hpp"
+#include "mesh_cache.hpp"
+#include "texture_cache.hpp"
+#include "collision_router.hpp"
+#include "collision_stream.hpp"
+#include "frame_input.hpp"
+#include "input_log.hpp"
+#include "fixed_timestep.hpp"
+#include "conveyor_item.hpp"
+#include "charger.hpp"
+#include "names.hpp"
+#include "profiler_panel.hpp"
+#include "file_watcher.hpp"
+#include "scene_reload.hpp"
+#include "scene_loader.hpp"
+#include "visibility.hpp"
+#include "render_batches.hpp"
+#include <future>
 
 /**
  * @name main_scene
@@ -23,6 +44,10 @@ public:
     main_scene(const std::string& p_tag, atlas::event::event_bus& p_bus);
 
     ~main_scene() {
+        // audio may still be starting up on the thread pool
+        if(m_audio_ready.valid()) {
+            m_audio_ready.wait();
+        }
         // m_testing_sound_source.stop();
         // m_testing_sound_source.cleanup();
     }
@@ -46,6 +71,43 @@ public:
 
     void collision_persisted(atlas::event::collision_persisted& p_event);
 
+    void collision_removed(atlas::event::collision_exit& p_event);
+
+    /**
+     * @brief Reads time and input from p_input instead of the window and
+     * keeps audio off the output device, must be called before start_game
+     */
+    void use_headless_input(frame_input& p_input);
+
+    /**
+     * @brief Keeps the scene's own render data up to date: cached_mesh and
+     * cached_texture on every material entity, texture mip streaming, the
+     * culled set and its instanced batches, must be called before start_game
+     *
+     * The renderer loads its models and textures itself and never reads
+     * any of it, so it is off by default and only tools that report on it
+     * (game-template-headless) turn it on.
+     */
+    void enable_render_data();
+
+    /**
+     * @brief Logs every input gameplay reads from now on, with a state
+     * checksum every input_recorder::default_checksum_interval frames
+     *
+     * Start it before the state a replay should reproduce, e.g. before
+     * starting the simulation.
+     */
+    void start_input_recording();
+
+    //! @brief Stops recording and saves the log, game-template-headless --replay plays it back
+    void stop_input_recording(const std::filesystem::path& p_path);
+
+    //! @brief Culling and LOD counts of the last on_update, all zero without enable_render_data
+    [[nodiscard]] const visibility_system::frame_stats& visibility_stats() const { return m_visibility.stats(); }
+
+    //! @brief Instanced draws built from the last on_update's visible set, empty without enable_render_data
+    [[nodiscard]] const render_batcher& render_batches() const { return m_batches; }
+
 
 private:
     // TODO: Will implement scene management system to coordinate with physics system
@@ -57,22 +119,24 @@ private:
     // NOTE: Typically re-serialization would occur in replacement of this
     void reset_objects();
 
-    void respawn();
+    // Loads LevelScene through the binary scene cache, falls back to the YAML serializer
+    void load_level();
+
+    // Patches the world with the entities edited in LevelScene since it was loaded
+    void hot_reload_level();
+
+    // Writes the level staged by m_level_loader into the world and brings up physics for it
+    void commit_level();
+
+    //! gameplay that has to advance in lockstep with physics, called once per fixed step
+    void fixed_update(float p_step);
 
 private:
     atlas::serializer m_deserializer_test;
     // atlas::optional_ref<atlas::scene_object> m_viking_room;
 
-    // cube stuff
+    // cube stuff, it charges the sphere through its charger component
     atlas::optional_ref<atlas::scene_object> m_cube;
-    atlas::transform m_cube_initial_transform;
-    float m_cube_speed= 8.f;
-    bool m_cube_moving = false;
-    bool m_cube_charging=false;
-    bool m_has_charged=false;
-    float m_cube_trigger_distance=5.f;
-    float m_respawn_distance = 20.f;
-    float m_cube_miss_distance = 30.f;
 
 
 
@@ -87,17 +151,63 @@ private:
     atlas::optional_ref<atlas::scene_object> m_camera;
     atlas::optional_ref<atlas::scene_object> m_runtime_camera;
     atlas::physics::physics_engine m_physics_engine_handler;
+    // 60Hz physics regardless of the render rate, at most 4 steps per frame
+    fixed_timestep m_physics_clock{ { .step_rate = 60.f, .max_substeps = 4 } };
+    physics_interpolation m_physics_interpolation;
+    // belt items advance once per fixed step while the simulation runs
+    conveyor_system m_conveyors;
+    charger_system m_chargers;
 
     editor_panel m_panels;
+#if GAME_TEMPLATE_PROFILER
+    profiler_panel m_profiler_panel;
+#endif
+    // imported meshes shared by every entity referencing the same model_path
+    mesh_cache m_mesh_cache;
+    // decoded mip chains, fine mips are streamed based on distance to the active camera
+    texture_cache m_texture_cache;
+    float m_streaming_viewport_height = 1080.f;
+    float m_viewport_aspect = 16.f / 9.f;
+    // frustum culled set and LOD of every material entity, for the active camera
+    visibility_system m_visibility;
+    // visible entities grouped by model, texture and LOD into instanced draws
+    render_batcher m_batches;
+    // parses LevelScene and loads its models in the background during start-up
+    scene_loader m_level_loader;
+    bool m_level_loaded=false;
+    // see enable_render_data
+    bool m_render_data=false;
     // sound_test m_play_sound;
-    ma_engine m_audio_engine;
-    // std::thread m_audio_thread;
-    // std::mutex m_audio_mutex;
-    // std::atomic<bool> m_is_audio_playing=false;
+    audio_system m_audio;
+    // initialize() runs on the thread pool, waited for before the first sound plays
+    std::future<void> m_audio_ready;
+    // filtered collision handlers, fed by the collision_* subscriptions
+    collision_router m_collisions;
+    // batched alternative to m_collisions, published once per frame after all of its physics steps
+    collision_stream m_collision_stream;
+    bool m_batched_collisions=false;
+
+    // time and input come from the window unless a headless run swaps them out
+    device_input m_device_input;
+    frame_input* m_input=&m_device_input;
+    // wraps whatever m_input pointed at while a recording runs
+    std::unique_ptr<input_recorder> m_recorder;
+    bool m_headless=false;
 
     bool m_blink_text=false;
     glm::vec3 m_offset_from_camera;
 
     bool m_physics_is_runtime=false;
 
+    // entity <-> interned name, so gameplay compares and looks up names as integers
+    name_index m_names;
+
+    // state of every serialized entity when the simulation was started
+    scene_snapshot m_runtime_snapshot;
+
+    // LevelScene edits made outside the editor, applied once the simulation is stopped
+    file_watcher m_scene_watcher;
+    scene_reloader m_level_reload;
+    bool m_level_changed=false;
+
 };
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "mapped_file.hpp"
+#include <algorithm>
+#include <fstream>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+mapped_file::mapped_file(const std::filesystem::path& p_path) {
+#if !defined(_WIN32)
+    int fd = ::open(p_path.c_str(), O_RDONLY);
+    if(fd < 0) {
+        return;
+    }
+
+    struct stat info{};
+    if(::fstat(fd, &info) != 0 or info.st_size <= 0) {
+        ::close(fd);
+        return;
+    }
+
+    void* mapped = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // the mapping keeps its own reference to the file
+    ::close(fd);
+
+    if(mapped == MAP_FAILED) {
+        return;
+    }
+
+    m_data = static_cast<const std::byte*>(mapped);
+    m_size = static_cast<size_t>(info.st_size);
+#else
+    std::ifstream file(p_path, std::ios::binary | std::ios::ate);
+    if(!file) {
+        return;
+    }
+
+    m_fallback.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(m_fallback.data()), static_cast<std::streamsize>(m_fallback.size()));
+
+    if(!file or m_fallback.empty()) {
+        m_fallback.clear();
+        return;
+    }
+
+    m_data = m_fallback.data();
+    m_size = m_fallback.size();
+#endif
+}
+
+mapped_file::~mapped_file() {
+    close();
+}
+
+mapped_file::mapped_file(mapped_file&& p_other) noexcept {
+    *this = std::move(p_other);
+}
+
+mapped_file& mapped_file::operator=(mapped_file&& p_other) noexcept {
+    if(this != &p_other) {
+        close();
+        m_fallback = std::move(p_other.m_fallback);
+        m_data = m_fallback.empty() ? p_other.m_data : m_fallback.data();
+        m_size = p_other.m_size;
+        p_other.m_data = nullptr;
+        p_other.m_size = 0;
+    }
+    return *this;
+}
+
+void mapped_file::advise(size_t p_offset, size_t p_size, access_hint p_hint) const {
+#if !defined(_WIN32)
+    if(m_data == nullptr or !m_fallback.empty() or p_offset >= m_size) {
+        return;
+    }
+
+    // madvise needs a page aligned start address
+    static const size_t page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t begin = p_offset & ~(page_size - 1);
+    size_t end = std::min(p_offset + p_size, m_size);
+    int advice = p_hint == access_hint::will_need ? MADV_WILLNEED : MADV_DONTNEED;
+    ::madvise(const_cast<std::byte*>(m_data) + begin, end - begin, advice);
+#else
+    (void)p_offset;
+    (void)p_size;
+    (void)p_hint;
+#endif
+}
+
+void mapped_file::close() {
+#if !defined(_WIN32)
+    if(m_data != nullptr and m_fallback.empty()) {
+        ::munmap(const_cast<std::byte*>(m_data), m_size);
+    }
+#endif
+    m_fallback.clear();
+    m_data = nullptr;
+    m_size = 0;
+}
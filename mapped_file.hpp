@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+/**
+ * @name mapped_file
+ * @brief Read-only view of a file on disk
+ *
+ * On POSIX platforms the file is memory-mapped so callers can read records
+ * straight out of the page cache. Other platforms fall back to reading the
+ * whole file into an owned buffer, the interface stays the same.
+ */
+class mapped_file {
+public:
+    mapped_file() = default;
+    mapped_file(const std::filesystem::path& p_path);
+    ~mapped_file();
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    mapped_file(mapped_file&& p_other) noexcept;
+    mapped_file& operator=(mapped_file&& p_other) noexcept;
+
+    [[nodiscard]] bool is_open() const { return m_data != nullptr; }
+
+    [[nodiscard]] const std::byte* data() const { return m_data; }
+
+    [[nodiscard]] size_t size() const { return m_size; }
+
+    [[nodiscard]] std::span<const std::byte> bytes() const { return { m_data, m_size }; }
+
+    enum class access_hint { will_need, dont_need };
+
+    //! @brief Hints the OS to prefetch or drop the pages of a byte range, no-op without mmap
+    void advise(size_t p_offset, size_t p_size, access_hint p_hint) const;
+
+    void close();
+
+private:
+    const std::byte* m_data=nullptr;
+    size_t m_size=0;
+    // only used when mmap is not available
+    std::vector<std::byte> m_fallback;
+};
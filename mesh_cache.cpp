@@ -0,0 +1,385 @@
+#include "mesh_cache.hpp"
+#include "hash.hpp"
+#include "mesh_optimizer.hpp"
+#include <core/engine_logger.hpp>
+#include <core/scene/components.hpp>
+#include <tiny_obj_loader.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <unordered_set>
+
+struct mesh_data::file_header {
+    uint32_t magic=0;
+    uint32_t version=0;
+    uint64_t source_hash=0;
+    uint64_t source_size=0;
+    int64_t source_write_time=0;
+    uint32_t vertex_count=0;
+    uint32_t index_count=0;
+    uint64_t vertex_offset=0;
+    uint64_t index_offset=0;
+    mesh_bounds bounds{};
+    uint32_t lod_count=0;
+    uint64_t lod_offset=0;
+};
+
+namespace {
+    //! "ATMS"
+    constexpr uint32_t mesh_file_magic = 0x534d5441;
+    //! bump whenever mesh_vertex or the header changes
+    constexpr uint32_t mesh_file_version = 2;
+
+    struct index_key {
+        int vertex;
+        int normal;
+        int texcoord;
+
+        bool operator==(const index_key&) const = default;
+    };
+
+    struct index_key_hash {
+        size_t operator()(const index_key& p_key) const {
+            uint64_t hash = fnv1a_offset_basis;
+            for(int value : { p_key.vertex, p_key.normal, p_key.texcoord }) {
+                hash = (hash ^ static_cast<uint32_t>(value)) * fnv1a_prime;
+            }
+            return static_cast<size_t>(hash);
+        }
+    };
+
+    mesh_bounds compute_bounds(const std::vector<mesh_vertex>& p_vertices) {
+        if(p_vertices.empty()) {
+            return { glm::vec3(0.f), glm::vec3(0.f), glm::vec3(0.f), 0.f };
+        }
+
+        glm::vec3 min(std::numeric_limits<float>::max());
+        glm::vec3 max(std::numeric_limits<float>::lowest());
+        for(const mesh_vertex& vertex : p_vertices) {
+            min = glm::min(min, vertex.position);
+            max = glm::max(max, vertex.position);
+        }
+
+        glm::vec3 center = (min + max) * 0.5f;
+        float radius = 0.f;
+        for(const mesh_vertex& vertex : p_vertices) {
+            radius = glm::max(radius, glm::length(vertex.position - center));
+        }
+        return { min, max, center, radius };
+    }
+
+    //! OBJ files without normals get area-weighted face normals
+    void generate_normals(mesh_geometry& p_geometry) {
+        for(mesh_vertex& vertex : p_geometry.vertices) {
+            vertex.normal = glm::vec3(0.f);
+        }
+
+        for(size_t i = 0; i + 2 < p_geometry.indices.size(); i += 3) {
+            mesh_vertex& v0 = p_geometry.vertices[p_geometry.indices[i]];
+            mesh_vertex& v1 = p_geometry.vertices[p_geometry.indices[i + 1]];
+            mesh_vertex& v2 = p_geometry.vertices[p_geometry.indices[i + 2]];
+            glm::vec3 face_normal = glm::cross(v1.position - v0.position, v2.position - v0.position);
+            v0.normal += face_normal;
+            v1.normal += face_normal;
+            v2.normal += face_normal;
+        }
+
+        for(mesh_vertex& vertex : p_geometry.vertices) {
+            float length = glm::length(vertex.normal);
+            vertex.normal = length > 0.f ? vertex.normal / length : glm::vec3(0.f, 1.f, 0.f);
+        }
+    }
+
+    int64_t write_time_of(const std::filesystem::path& p_path) {
+        std::error_code ec;
+        auto time = std::filesystem::last_write_time(p_path, ec);
+        return ec ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+    }
+}
+
+mesh_data::mesh_data(const std::filesystem::path& p_cache_path) : m_file(p_cache_path) {
+    if(!m_file.is_open() or m_file.size() < sizeof(file_header)) {
+        return;
+    }
+
+    const auto* header = reinterpret_cast<const file_header*>(m_file.data());
+    if(header->magic != mesh_file_magic or header->version != mesh_file_version) {
+        return;
+    }
+
+    uint64_t vertex_bytes = uint64_t(header->vertex_count) * sizeof(mesh_vertex);
+    uint64_t index_bytes = uint64_t(header->index_count) * sizeof(uint32_t);
+    uint64_t lod_bytes = uint64_t(header->lod_count) * sizeof(mesh_lod);
+    if(header->vertex_offset + vertex_bytes > m_file.size() or header->index_offset + index_bytes > m_file.size() or
+       header->lod_offset + lod_bytes > m_file.size()) {
+        return;
+    }
+
+    m_vertices = { reinterpret_cast<const mesh_vertex*>(m_file.data() + header->vertex_offset), header->vertex_count };
+    m_indices = { reinterpret_cast<const uint32_t*>(m_file.data() + header->index_offset), header->index_count };
+    m_lods = { reinterpret_cast<const mesh_lod*>(m_file.data() + header->lod_offset), header->lod_count };
+    for(const mesh_lod& level : m_lods) {
+        if(uint64_t(level.index_offset) + level.index_count > header->index_count) {
+            return;
+        }
+    }
+    m_header = header;
+}
+
+std::span<const uint32_t> mesh_data::lod_indices(uint32_t p_level) const {
+    if(m_lods.empty()) {
+        return m_indices;
+    }
+    const mesh_lod& level = m_lods[std::min<size_t>(p_level, m_lods.size() - 1)];
+    return m_indices.subspan(level.index_offset, level.index_count);
+}
+
+const mesh_bounds& mesh_data::bounds() const {
+    return m_header->bounds;
+}
+
+uint64_t mesh_data::source_hash() const {
+    return m_header->source_hash;
+}
+
+bool mesh_data::matches_source_stamp(uint64_t p_size, int64_t p_write_time) const {
+    return m_header->source_size == p_size and m_header->source_write_time == p_write_time;
+}
+
+mesh_cache::mesh_cache(const std::filesystem::path& p_directory, thread_pool& p_pool)
+  : m_directory(p_directory), m_pool(&p_pool) {
+    std::error_code ec;
+    std::filesystem::create_directories(m_directory, ec);
+}
+
+std::filesystem::path mesh_cache::cache_path(const std::string& p_source) const {
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), "-%016llx.mesh", static_cast<unsigned long long>(fnv1a(p_source)));
+    return m_directory / (std::filesystem::path(p_source).stem().string() + suffix);
+}
+
+void mesh_cache::prefetch(const std::vector<std::string>& p_paths) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for(const std::string& path : p_paths) {
+        if(path.empty() or m_meshes.contains(path) or m_pending.contains(path)) {
+            continue;
+        }
+
+        m_pending.emplace(path, m_pool->submit([this, path]() { return load_or_import(path); }).share());
+    }
+}
+
+std::shared_ptr<const mesh_data> mesh_cache::get(const std::string& p_path) {
+    std::shared_future<std::shared_ptr<const mesh_data>> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(auto it = m_meshes.find(p_path); it != m_meshes.end()) {
+            return it->second;
+        }
+
+        if(auto it = m_pending.find(p_path); it != m_pending.end()) {
+            pending = it->second;
+        }
+    }
+
+    std::shared_ptr<const mesh_data> mesh = pending.valid() ? pending.get() : load_or_import(p_path);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.erase(p_path);
+    // another thread may have finished the same path first, keep a single instance
+    return m_meshes.try_emplace(p_path, mesh).first->second;
+}
+
+void mesh_cache::resolve(flecs::world& p_registry) {
+    auto query = p_registry.query_builder<atlas::material>().build();
+
+    std::vector<std::string> paths;
+    std::unordered_set<std::string> unique_paths;
+    query.each([&](flecs::entity, atlas::material& p_material) {
+        if(unique_paths.insert(p_material.model_path).second) {
+            paths.push_back(p_material.model_path);
+        }
+    });
+
+    prefetch(paths);
+
+    p_registry.defer_begin();
+    query.each([&](flecs::entity p_entity, atlas::material& p_material) {
+        if(auto mesh = get(p_material.model_path)) {
+            p_entity.set<cached_mesh>({ std::move(mesh) });
+        }
+    });
+    p_registry.defer_end();
+}
+
+std::shared_ptr<const mesh_data> mesh_cache::load_or_import(const std::string& p_path) const {
+    std::error_code ec;
+    uint64_t source_size = std::filesystem::file_size(p_path, ec);
+    if(ec) {
+        console_log_error("Mesh {} does not exist", p_path);
+        return nullptr;
+    }
+
+    int64_t source_write_time = write_time_of(p_path);
+    std::filesystem::path cached_path = cache_path(p_path);
+
+    auto cached = std::make_shared<mesh_data>(cached_path);
+    if(cached->is_valid() and cached->matches_source_stamp(source_size, source_write_time)) {
+        return cached;
+    }
+
+    // the stamp changed, only re-import when the contents actually differ
+    uint64_t source_hash = 0;
+    {
+        mapped_file source(p_path);
+        source_hash = fnv1a(source.bytes());
+    }
+
+    mesh_geometry geometry;
+    if(cached->is_valid() and cached->source_hash() == source_hash) {
+        geometry.vertices.assign(cached->vertices().begin(), cached->vertices().end());
+        geometry.indices.assign(cached->all_indices().begin(), cached->all_indices().end());
+        geometry.lods.assign(cached->lods().begin(), cached->lods().end());
+        geometry.bounds = cached->bounds();
+    }
+    else {
+        auto start = std::chrono::steady_clock::now();
+        if(!import_obj(p_path, geometry)) {
+            return nullptr;
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        console_log_info("Imported {} ({} vertices, {} indices) in {} ms", p_path, geometry.vertices.size(), geometry.indices.size(), elapsed.count());
+
+        // welded, reordered and simplified once here, cache hits map the result as is
+        start = std::chrono::steady_clock::now();
+        mesh_optimize_report report = optimize_mesh(geometry);
+        elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        console_log_info("Optimized {} in {} ms, {} -> {} vertices", p_path, elapsed.count(), report.vertices_before, report.vertices_after);
+        for(size_t level = 0; level < report.lods.size(); level++) {
+            const mesh_lod_report& lod = report.lods[level];
+            console_log_info("  LOD {}: {} triangles, ACMR {:.3f} -> {:.3f}, error {:.4f}", level, lod.triangles, lod.acmr_before, lod.acmr_after, lod.error);
+        }
+    }
+
+    cached.reset();
+
+    // write to a temporary first so a half-written cache is never mapped
+    std::filesystem::path staging = cached_path;
+    staging += "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+    bool renamed = false;
+    if(write_mesh_file(staging, geometry, source_hash, source_size, source_write_time)) {
+        std::filesystem::rename(staging, cached_path, ec);
+        renamed = !ec;
+    }
+
+    // when the rename fails (the old cache can still be mapped elsewhere) cached_path holds the
+    // stale geometry, the fresh import is only in the staging file
+    auto mesh = std::make_shared<mesh_data>(renamed ? cached_path : staging);
+    if(!renamed) {
+        std::filesystem::remove(staging, ec);
+    }
+    if(!mesh->is_valid()) {
+        console_log_error("Could not write mesh cache {}", cached_path.string());
+        return nullptr;
+    }
+    return mesh;
+}
+
+bool mesh_cache::import_obj(const std::filesystem::path& p_path, mesh_geometry& p_geometry) {
+    tinyobj::ObjReaderConfig config;
+    config.triangulate = true;
+    config.mtl_search_path = p_path.parent_path().string();
+
+    tinyobj::ObjReader reader;
+    if(!reader.ParseFromFile(p_path.string(), config)) {
+        console_log_error("Could not parse {}: {}", p_path.string(), reader.Error());
+        return false;
+    }
+
+    const tinyobj::attrib_t& attrib = reader.GetAttrib();
+    const std::vector<tinyobj::shape_t>& shapes = reader.GetShapes();
+
+    size_t index_count = 0;
+    for(const tinyobj::shape_t& shape : shapes) {
+        index_count += shape.mesh.indices.size();
+    }
+
+    p_geometry.vertices.clear();
+    p_geometry.indices.clear();
+    p_geometry.indices.reserve(index_count);
+
+    // weld corners that reference the same position/normal/uv triple
+    std::unordered_map<index_key, uint32_t, index_key_hash> unique_vertices;
+    unique_vertices.reserve(index_count);
+    bool has_normals = !attrib.normals.empty();
+
+    for(const tinyobj::shape_t& shape : shapes) {
+        for(const tinyobj::index_t& index : shape.mesh.indices) {
+            index_key key{ index.vertex_index, index.normal_index, index.texcoord_index };
+            auto [it, inserted] = unique_vertices.try_emplace(key, static_cast<uint32_t>(p_geometry.vertices.size()));
+
+            if(inserted) {
+                mesh_vertex vertex{};
+                size_t v = static_cast<size_t>(index.vertex_index);
+                vertex.position = { attrib.vertices[3 * v + 0], attrib.vertices[3 * v + 1], attrib.vertices[3 * v + 2] };
+
+                vertex.color = glm::vec3(1.f);
+                if(attrib.colors.size() >= 3 * (v + 1)) {
+                    vertex.color = { attrib.colors[3 * v + 0], attrib.colors[3 * v + 1], attrib.colors[3 * v + 2] };
+                }
+
+                if(index.normal_index >= 0) {
+                    size_t n = static_cast<size_t>(index.normal_index);
+                    vertex.normal = { attrib.normals[3 * n + 0], attrib.normals[3 * n + 1], attrib.normals[3 * n + 2] };
+                }
+
+                if(index.texcoord_index >= 0) {
+                    size_t t = static_cast<size_t>(index.texcoord_index);
+                    vertex.uv = { attrib.texcoords[2 * t + 0], 1.f - attrib.texcoords[2 * t + 1] };
+                }
+
+                p_geometry.vertices.push_back(vertex);
+            }
+
+            p_geometry.indices.push_back(it->second);
+        }
+    }
+
+    if(!has_normals) {
+        generate_normals(p_geometry);
+    }
+
+    p_geometry.bounds = compute_bounds(p_geometry.vertices);
+    return true;
+}
+
+bool mesh_cache::write_mesh_file(const std::filesystem::path& p_path, const mesh_geometry& p_geometry, uint64_t p_source_hash,
+                                 uint64_t p_source_size, int64_t p_source_write_time) {
+    mesh_data::file_header header;
+    header.magic = mesh_file_magic;
+    header.version = mesh_file_version;
+    header.source_hash = p_source_hash;
+    header.source_size = p_source_size;
+    header.source_write_time = p_source_write_time;
+    header.vertex_count = static_cast<uint32_t>(p_geometry.vertices.size());
+    header.index_count = static_cast<uint32_t>(p_geometry.indices.size());
+    header.vertex_offset = sizeof(mesh_data::file_header);
+    header.index_offset = header.vertex_offset + p_geometry.vertices.size() * sizeof(mesh_vertex);
+    header.bounds = p_geometry.bounds;
+    header.lod_count = static_cast<uint32_t>(p_geometry.lods.size());
+    header.lod_offset = header.index_offset + p_geometry.indices.size() * sizeof(uint32_t);
+
+    std::ofstream file(p_path, std::ios::binary | std::ios::trunc);
+    if(!file) {
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(p_geometry.vertices.data()), static_cast<std::streamsize>(p_geometry.vertices.size() * sizeof(mesh_vertex)));
+    file.write(reinterpret_cast<const char*>(p_geometry.indices.data()), static_cast<std::streamsize>(p_geometry.indices.size() * sizeof(uint32_t)));
+    file.write(reinterpret_cast<const char*>(p_geometry.lods.data()), static_cast<std::streamsize>(p_geometry.lods.size() * sizeof(mesh_lod)));
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,143 @@
+#pragma once
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <flecs.h>
+#include <glm/glm.hpp>
+#include "mapped_file.hpp"
+#include "thread_pool.hpp"
+
+//! Matches the vertex input layout of the mesh shaders (position, color, normals, uv)
+struct mesh_vertex {
+    glm::vec3 position;
+    glm::vec3 color;
+    glm::vec3 normal;
+    glm::vec2 uv;
+};
+
+struct mesh_bounds {
+    glm::vec3 min;
+    glm::vec3 max;
+    glm::vec3 center;
+    float radius;
+};
+
+//! One level of detail, a range of the index buffer drawn over the shared vertices
+struct mesh_lod {
+    uint32_t index_offset=0;
+    uint32_t index_count=0;
+    //! simplification error relative to the mesh's largest extent, 0 for full detail
+    float error=0.f;
+};
+
+//! Owning geometry produced by an import, before it is written to the cache
+struct mesh_geometry {
+    std::vector<mesh_vertex> vertices;
+    //! every level's indices back to back, full detail first
+    std::vector<uint32_t> indices;
+    //! empty when indices holds a single level
+    std::vector<mesh_lod> lods;
+    mesh_bounds bounds;
+};
+
+/**
+ * @name mesh_data
+ * @brief Read-only view of a cached mesh file
+ *
+ * Vertices and indices point straight into the memory-mapped cache file.
+ * Every level of detail indexes the same vertices, indices() is the full
+ * detail level.
+ */
+class mesh_data {
+public:
+    mesh_data() = default;
+    mesh_data(const std::filesystem::path& p_cache_path);
+
+    [[nodiscard]] bool is_valid() const { return m_header != nullptr; }
+
+    [[nodiscard]] std::span<const mesh_vertex> vertices() const { return m_vertices; }
+
+    [[nodiscard]] std::span<const uint32_t> indices() const { return lod_indices(0); }
+
+    //! @brief Indices of p_level, levels past the last one return the last
+    [[nodiscard]] std::span<const uint32_t> lod_indices(uint32_t p_level) const;
+
+    [[nodiscard]] uint32_t lod_count() const { return m_lods.empty() ? 1 : static_cast<uint32_t>(m_lods.size()); }
+
+    //! @brief Every level's indices back to back, what mesh_lod::index_offset counts into
+    [[nodiscard]] std::span<const uint32_t> all_indices() const { return m_indices; }
+
+    [[nodiscard]] std::span<const mesh_lod> lods() const { return m_lods; }
+
+    [[nodiscard]] const mesh_bounds& bounds() const;
+
+    [[nodiscard]] uint64_t source_hash() const;
+
+    //! @return true when the cache was built from a source with this size and write time
+    [[nodiscard]] bool matches_source_stamp(uint64_t p_size, int64_t p_write_time) const;
+
+    struct file_header;
+
+private:
+    mapped_file m_file;
+    const file_header* m_header=nullptr;
+    std::span<const mesh_vertex> m_vertices;
+    std::span<const uint32_t> m_indices;
+    std::span<const mesh_lod> m_lods;
+};
+
+//! flecs component attaching a shared cached mesh to an entity
+struct cached_mesh {
+    std::shared_ptr<const mesh_data> mesh;
+};
+
+/**
+ * @name mesh_cache
+ * @brief Imports OBJ files into content-hashed binary mesh caches
+ *
+ * Each source path is imported once and shared between every entity that
+ * references it. A cache file is rebuilt only when the content hash of its
+ * source changes; the source size and write time are checked first so
+ * unchanged files are not even rehashed. Imports go through optimize_mesh
+ * before they are written, so the cache holds welded, cache-ordered
+ * geometry and its LOD chain.
+ */
+class mesh_cache {
+public:
+    mesh_cache(const std::filesystem::path& p_directory, thread_pool& p_pool);
+
+    //! @brief Starts loading or importing every path on the thread pool
+    void prefetch(const std::vector<std::string>& p_paths);
+
+    //! @brief Returns the shared mesh for p_path, waiting for a pending prefetch if there is one
+    std::shared_ptr<const mesh_data> get(const std::string& p_path);
+
+    /**
+     * @brief Prefetches every atlas::material model in the world then attaches
+     * a cached_mesh component to each of those entities
+     */
+    void resolve(flecs::world& p_registry);
+
+    //! @brief Parses and welds an OBJ file without touching the cache
+    static bool import_obj(const std::filesystem::path& p_path, mesh_geometry& p_geometry);
+
+    static bool write_mesh_file(const std::filesystem::path& p_path, const mesh_geometry& p_geometry, uint64_t p_source_hash,
+                                uint64_t p_source_size, int64_t p_source_write_time);
+
+    [[nodiscard]] std::filesystem::path cache_path(const std::string& p_source) const;
+
+private:
+    std::shared_ptr<const mesh_data> load_or_import(const std::string& p_path) const;
+
+private:
+    std::filesystem::path m_directory;
+    thread_pool* m_pool=nullptr;
+    std::mutex m_mutex;
+    std::unordered_map<std::string, std::shared_ptr<const mesh_data>> m_meshes;
+    std::unordered_map<std::string, std::shared_future<std::shared_ptr<const mesh_data>>> m_pending;
+};
@@ -0,0 +1,848 @@
+#include "mesh_optimizer.hpp"
+#include "hash.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+    constexpr uint32_t invalid_index = std::numeric_limits<uint32_t>::max();
+
+    struct vertex_bits_hash {
+        size_t operator()(const mesh_vertex& p_vertex) const { return static_cast<size_t>(fnv1a(std::as_bytes(std::span(&p_vertex, 1)))); }
+    };
+
+    struct vertex_bits_equal {
+        bool operator()(const mesh_vertex& p_a, const mesh_vertex& p_b) const { return std::memcmp(&p_a, &p_b, sizeof(mesh_vertex)) == 0; }
+    };
+
+    struct position_hash {
+        size_t operator()(const glm::vec3& p_position) const { return static_cast<size_t>(fnv1a(std::as_bytes(std::span(&p_position, 1)))); }
+    };
+
+    struct position_equal {
+        bool operator()(const glm::vec3& p_a, const glm::vec3& p_b) const { return std::memcmp(&p_a, &p_b, sizeof(glm::vec3)) == 0; }
+    };
+
+    //! triangles around every vertex, the triangle ids of vertex v are triangles[offsets[v]] up to triangles[offsets[v + 1]]
+    struct triangle_adjacency {
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> triangles;
+
+        void build(std::span<const uint32_t> p_corners, size_t p_vertex_count) {
+            offsets.assign(p_vertex_count + 1, 0);
+            for(uint32_t vertex : p_corners) {
+                offsets[vertex + 1]++;
+            }
+            for(size_t i = 0; i < p_vertex_count; i++) {
+                offsets[i + 1] += offsets[i];
+            }
+
+            triangles.resize(p_corners.size());
+            std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for(size_t i = 0; i < p_corners.size(); i++) {
+                triangles[fill[p_corners[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        [[nodiscard]] std::span<const uint32_t> around(uint32_t p_vertex) const {
+            return std::span(triangles).subspan(offsets[p_vertex], offsets[p_vertex + 1] - offsets[p_vertex]);
+        }
+    };
+
+    //! Garland-Heckbert error quadric, sum of squared distances to planes divided by their total weight
+    struct quadric {
+        double a2=0.0, ab=0.0, ac=0.0, ad=0.0, b2=0.0, bc=0.0, bd=0.0, c2=0.0, cd=0.0, d2=0.0;
+        double weight=0.0;
+
+        void add_plane(const glm::vec3& p_normal, float p_distance, double p_weight) {
+            double a = p_normal.x;
+            double b = p_normal.y;
+            double c = p_normal.z;
+            double d = p_distance;
+            a2 += p_weight * a * a;
+            ab += p_weight * a * b;
+            ac += p_weight * a * c;
+            ad += p_weight * a * d;
+            b2 += p_weight * b * b;
+            bc += p_weight * b * c;
+            bd += p_weight * b * d;
+            c2 += p_weight * c * c;
+            cd += p_weight * c * d;
+            d2 += p_weight * d * d;
+            weight += p_weight;
+        }
+
+        quadric& operator+=(const quadric& p_other) {
+            a2 += p_other.a2;
+            ab += p_other.ab;
+            ac += p_other.ac;
+            ad += p_other.ad;
+            b2 += p_other.b2;
+            bc += p_other.bc;
+            bd += p_other.bd;
+            c2 += p_other.c2;
+            cd += p_other.cd;
+            d2 += p_other.d2;
+            weight += p_other.weight;
+            return *this;
+        }
+
+        [[nodiscard]] double evaluate(const glm::vec3& p_point) const {
+            double x = p_point.x;
+            double y = p_point.y;
+            double z = p_point.z;
+            double error = a2 * x * x + b2 * y * y + c2 * z * z + 2.0 * (ab * x * y + ac * x * z + bc * y * z) + 2.0 * (ad * x + bd * y + cd * z) + d2;
+            return weight > 0.0 ? std::max(error / weight, 0.0) : 0.0;
+        }
+    };
+
+    uint64_t edge_key(uint32_t p_from, uint32_t p_to) {
+        return (static_cast<uint64_t>(p_from) << 32) | p_to;
+    }
+
+    /**
+     * Half-edge collapse over positions, see simplify_mesh. Work happens in
+     * passes: every pass ranks all edges by quadric error and applies the
+     * cheapest collapses whose neighbourhoods do not overlap, then rewrites
+     * the index buffer.
+     */
+    class edge_collapse {
+    public:
+        edge_collapse(std::span<const mesh_vertex> p_vertices, std::span<const uint32_t> p_indices) : m_vertices(p_vertices) {
+            // vertices sharing a position are one position for the topology, the corners keep their own attributes
+            std::unordered_map<glm::vec3, uint32_t, position_hash, position_equal> positions;
+            m_position_of.resize(p_vertices.size());
+            for(size_t i = 0; i < p_vertices.size(); i++) {
+                auto [it, inserted] = positions.try_emplace(p_vertices[i].position, static_cast<uint32_t>(m_points.size()));
+                if(inserted) {
+                    m_points.push_back(p_vertices[i].position);
+                }
+                m_position_of[i] = it->second;
+            }
+
+            // errors are measured in a unit box so max_error means the same for every mesh
+            glm::vec3 min(std::numeric_limits<float>::max());
+            glm::vec3 max(std::numeric_limits<float>::lowest());
+            for(const glm::vec3& point : m_points) {
+                min = glm::min(min, point);
+                max = glm::max(max, point);
+            }
+            float extent = std::max({ max.x - min.x, max.y - min.y, max.z - min.z });
+            float scale = extent > 0.f ? 1.f / extent : 1.f;
+            for(glm::vec3& point : m_points) {
+                point = (point - min) * scale;
+            }
+
+            m_indices.reserve(p_indices.size());
+            for(size_t i = 0; i + 2 < p_indices.size(); i += 3) {
+                uint32_t a = m_position_of[p_indices[i]];
+                uint32_t b = m_position_of[p_indices[i + 1]];
+                uint32_t c = m_position_of[p_indices[i + 2]];
+                if(a != b and b != c and a != c) {
+                    m_indices.insert(m_indices.end(), { p_indices[i], p_indices[i + 1], p_indices[i + 2] });
+                }
+            }
+
+            m_quadrics.resize(m_points.size());
+            for(size_t i = 0; i < m_indices.size(); i += 3) {
+                const glm::vec3& a = m_points[m_position_of[m_indices[i]]];
+                const glm::vec3& b = m_points[m_position_of[m_indices[i + 1]]];
+                const glm::vec3& c = m_points[m_position_of[m_indices[i + 2]]];
+                glm::vec3 normal = glm::cross(b - a, c - a);
+                float length = glm::length(normal);
+                if(length <= 0.f) {
+                    continue;
+                }
+                normal = normal / length;
+                for(uint32_t corner = 0; corner < 3; corner++) {
+                    m_quadrics[m_position_of[m_indices[i + corner]]].add_plane(normal, -glm::dot(normal, a), length * 0.5);
+                }
+            }
+
+            m_corner_positions.resize(m_indices.size());
+            m_wedge_remap.resize(p_vertices.size());
+            for(size_t i = 0; i < m_wedge_remap.size(); i++) {
+                m_wedge_remap[i] = static_cast<uint32_t>(i);
+            }
+            classify(true);
+        }
+
+        //! @return the largest error of an applied collapse, squared
+        double run(size_t p_target_index_count, float p_max_error) {
+            size_t target_triangles = p_target_index_count / 3;
+            double error_limit = static_cast<double>(p_max_error) * static_cast<double>(p_max_error);
+            double reached = 0.0;
+
+            while(m_indices.size() / 3 > target_triangles) {
+                if(m_passes++ > 0) {
+                    classify(false);
+                }
+
+                collect_candidates();
+                std::sort(m_candidates.begin(), m_candidates.end(), [](const candidate& p_a, const candidate& p_b) { return p_a.cost < p_b.cost; });
+
+                m_touched.assign(m_points.size(), 0);
+                size_t triangles = m_indices.size() / 3;
+                size_t removed = 0;
+                uint32_t applied = 0;
+                for(const candidate& edge : m_candidates) {
+                    if(edge.cost > error_limit or triangles - removed <= target_triangles) {
+                        break;
+                    }
+                    if(m_touched[edge.from] or m_touched[edge.to]) {
+                        continue;
+                    }
+
+                    uint32_t shared = 0;
+                    if(!try_collapse(edge.from, edge.to, shared)) {
+                        continue;
+                    }
+
+                    m_quadrics[edge.to] += m_quadrics[edge.from];
+                    removed += shared;
+                    applied++;
+                    reached = std::max(reached, edge.cost);
+                }
+
+                if(applied == 0) {
+                    break;
+                }
+                rewrite();
+            }
+            return reached;
+        }
+
+        [[nodiscard]] std::vector<uint32_t>& indices() { return m_indices; }
+
+    private:
+        enum class position_kind : uint8_t { interior, border, locked };
+
+        struct candidate {
+            uint32_t from;
+            uint32_t to;
+            double cost;
+        };
+
+        //! finds open borders and non-manifold edges of the current triangles and rebuilds the adjacency
+        void classify(bool p_add_border_planes) {
+            for(size_t i = 0; i < m_indices.size(); i++) {
+                m_corner_positions[i] = m_position_of[m_indices[i]];
+            }
+            m_corner_positions.resize(m_indices.size());
+            m_adjacency.build(m_corner_positions, m_points.size());
+
+            m_edges.clear();
+            m_edges.reserve(m_indices.size());
+            for(size_t i = 0; i < m_corner_positions.size(); i += 3) {
+                for(uint32_t corner = 0; corner < 3; corner++) {
+                    m_edges[edge_key(m_corner_positions[i + corner], m_corner_positions[i + (corner + 1) % 3])]++;
+                }
+            }
+
+            m_kinds.assign(m_points.size(), position_kind::interior);
+            m_border_edges.clear();
+            for(size_t i = 0; i < m_corner_positions.size(); i += 3) {
+                for(uint32_t corner = 0; corner < 3; corner++) {
+                    uint32_t from = m_corner_positions[i + corner];
+                    uint32_t to = m_corner_positions[i + (corner + 1) % 3];
+                    uint32_t forward = m_edges[edge_key(from, to)];
+                    auto backward = m_edges.find(edge_key(to, from));
+                    uint32_t backward_count = backward == m_edges.end() ? 0 : backward->second;
+
+                    if(forward + backward_count > 2 or forward > 1) {
+                        m_kinds[from] = position_kind::locked;
+                        m_kinds[to] = position_kind::locked;
+                        continue;
+                    }
+                    if(backward_count != 0) {
+                        continue;
+                    }
+
+                    m_border_edges.insert({ edge_key(std::min(from, to), std::max(from, to)), 0 });
+                    for(uint32_t end : { from, to }) {
+                        if(m_kinds[end] == position_kind::interior) {
+                            m_kinds[end] = position_kind::border;
+                        }
+                    }
+
+                    if(p_add_border_planes) {
+                        // a plane through the border edge, perpendicular to its triangle, keeps the outline in place
+                        const glm::vec3& a = m_points[from];
+                        const glm::vec3& b = m_points[to];
+                        const glm::vec3& c = m_points[m_corner_positions[i + (corner + 2) % 3]];
+                        glm::vec3 edge = b - a;
+                        glm::vec3 normal = glm::cross(edge, glm::cross(edge, c - a));
+                        float length = glm::length(normal);
+                        if(length > 0.f) {
+                            normal = normal / length;
+                            double weight = static_cast<double>(glm::dot(edge, edge)) * border_weight;
+                            m_quadrics[from].add_plane(normal, -glm::dot(normal, a), weight);
+                            m_quadrics[to].add_plane(normal, -glm::dot(normal, a), weight);
+                        }
+                    }
+                }
+            }
+        }
+
+        [[nodiscard]] bool is_border_edge(uint32_t p_a, uint32_t p_b) const {
+            return m_border_edges.contains(edge_key(std::min(p_a, p_b), std::max(p_a, p_b)));
+        }
+
+        [[nodiscard]] bool can_move(uint32_t p_from, uint32_t p_to) const {
+            switch(m_kinds[p_from]) {
+                case position_kind::interior:
+                    return true;
+                case position_kind::border:
+                    return m_kinds[p_to] != position_kind::interior and is_border_edge(p_from, p_to);
+                default:
+                    return false;
+            }
+        }
+
+        [[nodiscard]] double collapse_cost(uint32_t p_from, uint32_t p_to) const {
+            quadric combined = m_quadrics[p_from];
+            combined += m_quadrics[p_to];
+            return combined.evaluate(m_points[p_to]);
+        }
+
+        void collect_candidates() {
+            m_edge_list.clear();
+            for(size_t i = 0; i < m_corner_positions.size(); i += 3) {
+                for(uint32_t corner = 0; corner < 3; corner++) {
+                    uint32_t a = m_corner_positions[i + corner];
+                    uint32_t b = m_corner_positions[i + (corner + 1) % 3];
+                    m_edge_list.push_back(edge_key(std::min(a, b), std::max(a, b)));
+                }
+            }
+            std::sort(m_edge_list.begin(), m_edge_list.end());
+            m_edge_list.erase(std::unique(m_edge_list.begin(), m_edge_list.end()), m_edge_list.end());
+
+            m_candidates.clear();
+            for(uint64_t key : m_edge_list) {
+                auto a = static_cast<uint32_t>(key >> 32);
+                auto b = static_cast<uint32_t>(key & 0xffffffffu);
+                double cost_ab = can_move(a, b) ? collapse_cost(a, b) : std::numeric_limits<double>::max();
+                double cost_ba = can_move(b, a) ? collapse_cost(b, a) : std::numeric_limits<double>::max();
+                if(cost_ab == std::numeric_limits<double>::max() and cost_ba == std::numeric_limits<double>::max()) {
+                    continue;
+                }
+                m_candidates.push_back(cost_ab <= cost_ba ? candidate{ a, b, cost_ab } : candidate{ b, a, cost_ba });
+            }
+        }
+
+        /**
+         * Checks that every corner of p_from has exactly one corner of p_to to
+         * move to, that no remaining triangle flips and that the edge does not
+         * pinch the surface, then records the corner remap.
+         */
+        bool try_collapse(uint32_t p_from, uint32_t p_to, uint32_t& p_shared) {
+            m_pairs.clear();
+            m_from_wedges.clear();
+            m_from_neighbours.clear();
+            p_shared = 0;
+
+            for(uint32_t triangle : m_adjacency.around(p_from)) {
+                const uint32_t* corners = &m_indices[triangle * 3];
+                const uint32_t* positions = &m_corner_positions[triangle * 3];
+                uint32_t from_corner = positions[0] == p_from ? 0 : positions[1] == p_from ? 1 : 2;
+                uint32_t wedge = corners[from_corner];
+                if(std::find(m_from_wedges.begin(), m_from_wedges.end(), wedge) == m_from_wedges.end()) {
+                    m_from_wedges.push_back(wedge);
+                }
+
+                uint32_t to_corner = positions[0] == p_to ? 0 : positions[1] == p_to ? 1 : positions[2] == p_to ? 2 : 3;
+                if(to_corner != 3) {
+                    p_shared++;
+                    auto pair = std::find_if(m_pairs.begin(), m_pairs.end(), [&](const auto& p_pair) { return p_pair.first == wedge; });
+                    if(pair == m_pairs.end()) {
+                        m_pairs.emplace_back(wedge, corners[to_corner]);
+                    }
+                    else if(pair->second != corners[to_corner]) {
+                        // the corner would need two different attribute sets
+                        return false;
+                    }
+                    continue;
+                }
+
+                glm::vec3 points[3] = { m_points[positions[0]], m_points[positions[1]], m_points[positions[2]] };
+                glm::vec3 before = glm::cross(points[1] - points[0], points[2] - points[0]);
+                points[from_corner] = m_points[p_to];
+                glm::vec3 after = glm::cross(points[1] - points[0], points[2] - points[0]);
+                if(glm::dot(before, after) < 0.25f * glm::length(before) * glm::length(after) or glm::dot(after, after) <= 0.f) {
+                    return false;
+                }
+
+                for(uint32_t corner = 0; corner < 3; corner++) {
+                    if(corner != from_corner) {
+                        m_from_neighbours.push_back(positions[corner]);
+                    }
+                }
+            }
+
+            if(p_shared == 0 or !pair_remaining_wedges(p_to)) {
+                return false;
+            }
+
+            // link condition: p_to's triangles may only meet p_from's remaining neighbours at the edge's own triangles
+            for(uint32_t triangle : m_adjacency.around(p_to)) {
+                const uint32_t* positions = &m_corner_positions[triangle * 3];
+                if(positions[0] == p_from or positions[1] == p_from or positions[2] == p_from) {
+                    continue;
+                }
+                for(uint32_t corner = 0; corner < 3; corner++) {
+                    uint32_t other = positions[corner];
+                    if(other == p_to) {
+                        continue;
+                    }
+                    uint32_t shared_count = 0;
+                    for(uint32_t candidate_triangle : m_adjacency.around(p_from)) {
+                        const uint32_t* around = &m_corner_positions[candidate_triangle * 3];
+                        bool has_to = around[0] == p_to or around[1] == p_to or around[2] == p_to;
+                        bool has_other = around[0] == other or around[1] == other or around[2] == other;
+                        shared_count += has_to and has_other;
+                    }
+                    if(shared_count == 0 and std::find(m_from_neighbours.begin(), m_from_neighbours.end(), other) != m_from_neighbours.end()) {
+                        return false;
+                    }
+                }
+            }
+
+            for(const auto& [from_wedge, to_wedge] : m_pairs) {
+                m_wedge_remap[from_wedge] = to_wedge;
+            }
+
+            // the neighbourhood changed, its costs and flip checks are stale until the next pass
+            m_touched[p_from] = 1;
+            m_touched[p_to] = 1;
+            for(uint32_t triangle : m_adjacency.around(p_from)) {
+                for(uint32_t corner = 0; corner < 3; corner++) {
+                    m_touched[m_corner_positions[triangle * 3 + corner]] = 1;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Corners of the collapsing vertex that are not on the edge's triangles
+         * only differ from a paired one by their normal, as on hard edges. They
+         * take the corner of the target with the same other attributes whose
+         * normal is closest, as long as it is within 60 degrees.
+         */
+        bool pair_remaining_wedges(uint32_t p_to) {
+            size_t paired = m_pairs.size();
+            for(uint32_t wedge : m_from_wedges) {
+                if(std::any_of(m_pairs.begin(), m_pairs.begin() + paired, [&](const auto& p_pair) { return p_pair.first == wedge; })) {
+                    continue;
+                }
+
+                const mesh_vertex& from = m_vertices[wedge];
+                uint32_t best = invalid_index;
+                float best_alignment = 0.5f;
+                for(size_t i = 0; i < paired; i++) {
+                    const mesh_vertex& sibling = m_vertices[m_pairs[i].first];
+                    if(sibling.uv != from.uv or sibling.color != from.color) {
+                        continue;
+                    }
+                    const mesh_vertex& sibling_target = m_vertices[m_pairs[i].second];
+                    for(uint32_t triangle : m_adjacency.around(p_to)) {
+                        for(uint32_t corner = 0; corner < 3; corner++) {
+                            uint32_t target = m_indices[triangle * 3 + corner];
+                            if(m_corner_positions[triangle * 3 + corner] != p_to) {
+                                continue;
+                            }
+                            const mesh_vertex& candidate_vertex = m_vertices[target];
+                            if(candidate_vertex.uv != sibling_target.uv or candidate_vertex.color != sibling_target.color) {
+                                continue;
+                            }
+                            float alignment = glm::dot(candidate_vertex.normal, from.normal);
+                            if(alignment >= best_alignment) {
+                                best_alignment = alignment;
+                                best = target;
+                            }
+                        }
+                    }
+                }
+
+                if(best == invalid_index) {
+                    return false;
+                }
+                m_pairs.emplace_back(wedge, best);
+            }
+            return true;
+        }
+
+        //! applies the pass's corner remap and drops the triangles that collapsed
+        void rewrite() {
+            size_t write = 0;
+            for(size_t i = 0; i < m_indices.size(); i += 3) {
+                uint32_t a = m_wedge_remap[m_indices[i]];
+                uint32_t b = m_wedge_remap[m_indices[i + 1]];
+                uint32_t c = m_wedge_remap[m_indices[i + 2]];
+                uint32_t pa = m_position_of[a];
+                uint32_t pb = m_position_of[b];
+                uint32_t pc = m_position_of[c];
+                if(pa == pb or pb == pc or pa == pc) {
+                    continue;
+                }
+                m_indices[write++] = a;
+                m_indices[write++] = b;
+                m_indices[write++] = c;
+            }
+            m_indices.resize(write);
+
+            for(size_t i = 0; i < m_wedge_remap.size(); i++) {
+                m_wedge_remap[i] = static_cast<uint32_t>(i);
+            }
+        }
+
+    private:
+        static constexpr double border_weight = 10.0;
+
+        std::span<const mesh_vertex> m_vertices;
+        std::vector<uint32_t> m_position_of;
+        //! one per distinct position, scaled into the unit box
+        std::vector<glm::vec3> m_points;
+        std::vector<quadric> m_quadrics;
+        std::vector<uint32_t> m_indices;
+        std::vector<uint32_t> m_wedge_remap;
+        uint32_t m_passes=0;
+
+        // rebuilt every pass
+        std::vector<uint32_t> m_corner_positions;
+        triangle_adjacency m_adjacency;
+        std::unordered_map<uint64_t, uint32_t> m_edges;
+        std::unordered_map<uint64_t, uint32_t> m_border_edges;
+        std::vector<position_kind> m_kinds;
+        std::vector<uint64_t> m_edge_list;
+        std::vector<candidate> m_candidates;
+        std::vector<uint8_t> m_touched;
+
+        // scratch for try_collapse
+        std::vector<std::pair<uint32_t, uint32_t>> m_pairs;
+        std::vector<uint32_t> m_from_wedges;
+        std::vector<uint32_t> m_from_neighbours;
+    };
+}
+
+uint32_t weld_vertices(mesh_geometry& p_geometry) {
+    std::unordered_map<mesh_vertex, uint32_t, vertex_bits_hash, vertex_bits_equal> unique;
+    unique.reserve(p_geometry.vertices.size());
+    std::vector<uint32_t> remap(p_geometry.vertices.size());
+    std::vector<mesh_vertex> welded;
+    welded.reserve(p_geometry.vertices.size());
+
+    for(size_t i = 0; i < p_geometry.vertices.size(); i++) {
+        auto [it, inserted] = unique.try_emplace(p_geometry.vertices[i], static_cast<uint32_t>(welded.size()));
+        if(inserted) {
+            welded.push_back(p_geometry.vertices[i]);
+        }
+        remap[i] = it->second;
+    }
+
+    for(uint32_t& index : p_geometry.indices) {
+        index = remap[index];
+    }
+
+    auto removed = static_cast<uint32_t>(p_geometry.vertices.size() - welded.size());
+    p_geometry.vertices = std::move(welded);
+    return removed;
+}
+
+float compute_acmr(std::span<const uint32_t> p_indices, size_t p_vertex_count, uint32_t p_cache_size) {
+    if(p_indices.size() < 3) {
+        return 0.f;
+    }
+
+    // a vertex stays cached until p_cache_size other vertices were loaded after it
+    std::vector<uint32_t> loaded_at(p_vertex_count, 0);
+    uint32_t time = p_cache_size + 1;
+    uint32_t misses = 0;
+    for(uint32_t index : p_indices) {
+        if(time - loaded_at[index] > p_cache_size) {
+            loaded_at[index] = time++;
+            misses++;
+        }
+    }
+    return static_cast<float>(misses) / static_cast<float>(p_indices.size() / 3);
+}
+
+void optimize_vertex_cache(std::span<uint32_t> p_indices, size_t p_vertex_count, uint32_t p_cache_size) {
+    size_t triangle_count = p_indices.size() / 3;
+    if(triangle_count == 0) {
+        return;
+    }
+
+    triangle_adjacency adjacency;
+    adjacency.build(p_indices.first(triangle_count * 3), p_vertex_count);
+
+    std::vector<uint32_t> live(p_vertex_count);
+    for(size_t i = 0; i < p_vertex_count; i++) {
+        live[i] = adjacency.offsets[i + 1] - adjacency.offsets[i];
+    }
+    std::vector<uint32_t> loaded_at(p_vertex_count, 0);
+    uint32_t time = p_cache_size + 1;
+    std::vector<uint8_t> emitted(triangle_count, 0);
+
+    std::vector<uint32_t> result;
+    result.reserve(triangle_count * 3);
+    std::vector<uint32_t> dead_ends;
+    std::vector<uint32_t> candidates;
+    uint32_t cursor = 0;
+
+    // recently emitted vertices first, then the lowest unfinished vertex in index order
+    auto next_unfinished = [&]() -> uint32_t {
+        while(!dead_ends.empty()) {
+            uint32_t vertex = dead_ends.back();
+            dead_ends.pop_back();
+            if(live[vertex] > 0) {
+                return vertex;
+            }
+        }
+        while(cursor < p_vertex_count) {
+            uint32_t vertex = cursor++;
+            if(live[vertex] > 0) {
+                return vertex;
+            }
+        }
+        return invalid_index;
+    };
+
+    uint32_t fan = next_unfinished();
+    while(fan != invalid_index) {
+        candidates.clear();
+        for(uint32_t triangle : adjacency.around(fan)) {
+            if(emitted[triangle]) {
+                continue;
+            }
+            emitted[triangle] = 1;
+
+            for(uint32_t corner = 0; corner < 3; corner++) {
+                uint32_t vertex = p_indices[triangle * 3 + corner];
+                result.push_back(vertex);
+                dead_ends.push_back(vertex);
+                candidates.push_back(vertex);
+                live[vertex]--;
+                if(time - loaded_at[vertex] > p_cache_size) {
+                    loaded_at[vertex] = time++;
+                }
+            }
+        }
+
+        // the oldest candidate that stays cached while its remaining triangles are emitted
+        uint32_t best = invalid_index;
+        int64_t best_priority = -1;
+        for(uint32_t vertex : candidates) {
+            if(live[vertex] == 0) {
+                continue;
+            }
+            int64_t priority = 0;
+            uint32_t age = time - loaded_at[vertex];
+            if(age + 2 * live[vertex] <= p_cache_size) {
+                priority = age;
+            }
+            if(priority > best_priority) {
+                best_priority = priority;
+                best = vertex;
+            }
+        }
+        fan = best != invalid_index ? best : next_unfinished();
+    }
+
+    std::copy(result.begin(), result.end(), p_indices.begin());
+}
+
+void optimize_overdraw(std::span<uint32_t> p_indices, std::span<const mesh_vertex> p_vertices, uint32_t p_cache_size, float p_threshold) {
+    size_t triangle_count = p_indices.size() / 3;
+    if(triangle_count < 2) {
+        return;
+    }
+
+    float mesh_acmr = compute_acmr(p_indices, p_vertices.size(), p_cache_size);
+
+    // hard cuts where all three corners miss, the cache is cold there anyway
+    std::vector<uint32_t> loaded_at(p_vertices.size(), 0);
+    uint32_t time = p_cache_size + 1;
+    std::vector<uint32_t> hard_starts;
+    for(size_t triangle = 0; triangle < triangle_count; triangle++) {
+        uint32_t misses = 0;
+        for(uint32_t corner = 0; corner < 3; corner++) {
+            uint32_t vertex = p_indices[triangle * 3 + corner];
+            if(time - loaded_at[vertex] > p_cache_size) {
+                loaded_at[vertex] = time++;
+                misses++;
+            }
+        }
+        if(triangle == 0 or misses == 3) {
+            hard_starts.push_back(static_cast<uint32_t>(triangle));
+        }
+    }
+    hard_starts.push_back(static_cast<uint32_t>(triangle_count));
+
+    // soft cuts inside them, wherever a cluster restarting with a cold cache has paid for itself
+    std::vector<uint32_t> starts;
+    std::fill(loaded_at.begin(), loaded_at.end(), 0);
+    time = p_cache_size + 1;
+    for(size_t hard = 0; hard + 1 < hard_starts.size(); hard++) {
+        uint32_t start = hard_starts[hard];
+        uint32_t misses = 0;
+        starts.push_back(start);
+        time += p_cache_size + 1;
+        for(uint32_t triangle = start; triangle < hard_starts[hard + 1]; triangle++) {
+            for(uint32_t corner = 0; corner < 3; corner++) {
+                uint32_t vertex = p_indices[triangle * 3 + corner];
+                if(time - loaded_at[vertex] > p_cache_size) {
+                    loaded_at[vertex] = time++;
+                    misses++;
+                }
+            }
+
+            uint32_t length = triangle - start + 1;
+            if(triangle + 1 < hard_starts[hard + 1] and static_cast<float>(misses) <= p_threshold * mesh_acmr * static_cast<float>(length)) {
+                start = triangle + 1;
+                misses = 0;
+                starts.push_back(start);
+                time += p_cache_size + 1;
+            }
+        }
+    }
+    starts.push_back(static_cast<uint32_t>(triangle_count));
+
+    // area-weighted centroid and normal per cluster
+    struct cluster {
+        uint32_t start;
+        uint32_t end;
+        glm::vec3 centroid;
+        glm::vec3 normal;
+        float sort_key;
+    };
+    std::vector<cluster> clusters(starts.size() - 1);
+    glm::vec3 mesh_centroid(0.f);
+    float mesh_area = 0.f;
+    for(size_t i = 0; i < clusters.size(); i++) {
+        cluster& current = clusters[i];
+        current.start = starts[i];
+        current.end = starts[i + 1];
+        current.centroid = glm::vec3(0.f);
+        current.normal = glm::vec3(0.f);
+
+        float area = 0.f;
+        for(uint32_t triangle = current.start; triangle < current.end; triangle++) {
+            const glm::vec3& a = p_vertices[p_indices[triangle * 3]].position;
+            const glm::vec3& b = p_vertices[p_indices[triangle * 3 + 1]].position;
+            const glm::vec3& c = p_vertices[p_indices[triangle * 3 + 2]].position;
+            glm::vec3 normal = glm::cross(b - a, c - a);
+            float weight = glm::length(normal);
+            current.centroid += (a + b + c) * (weight / 3.f);
+            current.normal += normal;
+            area += weight;
+        }
+
+        mesh_centroid += current.centroid;
+        mesh_area += area;
+        current.centroid = area > 0.f ? current.centroid / area : glm::vec3(0.f);
+    }
+    if(mesh_area > 0.f) {
+        mesh_centroid = mesh_centroid / mesh_area;
+    }
+
+    for(cluster& current : clusters) {
+        float length = glm::length(current.normal);
+        current.sort_key = length > 0.f ? glm::dot(current.centroid - mesh_centroid, current.normal / length) : 0.f;
+    }
+    std::stable_sort(clusters.begin(), clusters.end(), [](const cluster& p_a, const cluster& p_b) { return p_a.sort_key > p_b.sort_key; });
+
+    std::vector<uint32_t> result;
+    result.reserve(triangle_count * 3);
+    for(const cluster& current : clusters) {
+        result.insert(result.end(), p_indices.begin() + current.start * 3, p_indices.begin() + current.end * 3);
+    }
+    std::copy(result.begin(), result.end(), p_indices.begin());
+}
+
+void optimize_vertex_fetch(mesh_geometry& p_geometry) {
+    std::vector<uint32_t> remap(p_geometry.vertices.size(), invalid_index);
+    std::vector<mesh_vertex> ordered;
+    ordered.reserve(p_geometry.vertices.size());
+
+    for(uint32_t& index : p_geometry.indices) {
+        if(remap[index] == invalid_index) {
+            remap[index] = static_cast<uint32_t>(ordered.size());
+            ordered.push_back(p_geometry.vertices[index]);
+        }
+        index = remap[index];
+    }
+    p_geometry.vertices = std::move(ordered);
+}
+
+float simplify_mesh(std::span<const mesh_vertex> p_vertices, std::span<const uint32_t> p_indices, size_t p_target_index_count,
+                    float p_max_error, std::vector<uint32_t>& p_out) {
+    edge_collapse collapse(p_vertices, p_indices);
+    double error = collapse.run(p_target_index_count, p_max_error);
+    p_out = std::move(collapse.indices());
+    return static_cast<float>(std::sqrt(error));
+}
+
+mesh_optimize_report optimize_mesh(mesh_geometry& p_geometry, const mesh_optimize_settings& p_settings) {
+    mesh_optimize_report report;
+    report.vertices_before = static_cast<uint32_t>(p_geometry.vertices.size());
+    weld_vertices(p_geometry);
+
+    // level 0 is the imported triangles, every other level is simplified from the one before it
+    std::vector<std::vector<uint32_t>> levels;
+    std::vector<float> errors;
+    if(p_geometry.lods.empty()) {
+        levels.push_back(p_geometry.indices);
+    }
+    else {
+        const mesh_lod& full = p_geometry.lods.front();
+        levels.emplace_back(p_geometry.indices.begin() + full.index_offset, p_geometry.indices.begin() + full.index_offset + full.index_count);
+    }
+    errors.push_back(0.f);
+
+    size_t full_count = levels.front().size();
+    for(float ratio : p_settings.lod_ratios) {
+        size_t target = static_cast<size_t>(static_cast<float>(full_count / 3) * ratio) * 3;
+        if(target < 3) {
+            break;
+        }
+
+        // errors add up along the chain, so every level only gets what the previous ones left of the budget
+        float budget = p_settings.max_error - errors.back();
+        if(budget <= 0.f) {
+            break;
+        }
+
+        std::vector<uint32_t> simplified;
+        float error = simplify_mesh(p_geometry.vertices, levels.back(), target, budget, simplified);
+        // a level that barely shrinks is not worth its memory, and the ones after it would not shrink either
+        if(simplified.size() * 10 > levels.back().size() * 9) {
+            break;
+        }
+        levels.push_back(std::move(simplified));
+        errors.push_back(errors.back() + error);
+    }
+
+    p_geometry.indices.clear();
+    p_geometry.lods.clear();
+    for(size_t level = 0; level < levels.size(); level++) {
+        std::vector<uint32_t>& indices = levels[level];
+        mesh_lod_report& lod = report.lods.emplace_back();
+        lod.triangles = static_cast<uint32_t>(indices.size() / 3);
+        lod.error = errors[level];
+        lod.acmr_before = compute_acmr(indices, p_geometry.vertices.size(), p_settings.cache_size);
+
+        optimize_vertex_cache(indices, p_geometry.vertices.size(), p_settings.cache_size);
+        optimize_overdraw(indices, p_geometry.vertices, p_settings.cache_size, p_settings.overdraw_threshold);
+        lod.acmr_after = compute_acmr(indices, p_geometry.vertices.size(), p_settings.cache_size);
+
+        p_geometry.lods.push_back({ static_cast<uint32_t>(p_geometry.indices.size()), static_cast<uint32_t>(indices.size()), errors[level] });
+        p_geometry.indices.insert(p_geometry.indices.end(), indices.begin(), indices.end());
+    }
+
+    optimize_vertex_fetch(p_geometry);
+    report.vertices_after = static_cast<uint32_t>(p_geometry.vertices.size());
+    return report;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "mesh_cache.hpp"
+
+/**
+ * @brief Import-time mesh processing: welding, triangle and vertex
+ * reordering and LOD generation
+ *
+ * optimize_mesh runs the whole chain on freshly imported geometry, the
+ * other functions are the individual steps. All of them work on indexed
+ * triangle lists and keep the winding of every triangle.
+ */
+
+struct mesh_optimize_settings {
+    //! triangle count of each extra level as a share of the full mesh
+    std::vector<float> lod_ratios{ 0.5f, 0.25f, 0.125f };
+    //! largest simplification error of any level, relative to the mesh's largest extent, levels add up their errors
+    float max_error = 0.05f;
+    //! post-transform cache size the orderings and the reported ACMR assume
+    uint32_t cache_size = 16;
+    //! overdraw clusters are only split where the cache miss ratio stays within this factor of the whole mesh's
+    float overdraw_threshold = 1.05f;
+};
+
+struct mesh_lod_report {
+    uint32_t triangles=0;
+    float error=0.f;
+    //! average cache misses per triangle before and after reordering
+    float acmr_before=0.f;
+    float acmr_after=0.f;
+};
+
+struct mesh_optimize_report {
+    uint32_t vertices_before=0;
+    uint32_t vertices_after=0;
+    std::vector<mesh_lod_report> lods;
+};
+
+/**
+ * @brief Merges vertices whose position, color, normal and uv are bit-identical
+ *
+ * @return the number of vertices removed
+ */
+uint32_t weld_vertices(mesh_geometry& p_geometry);
+
+//! @brief Average cache misses per triangle for a FIFO post-transform cache of p_cache_size entries
+float compute_acmr(std::span<const uint32_t> p_indices, size_t p_vertex_count, uint32_t p_cache_size = 16);
+
+/**
+ * @brief Reorders triangles for the post-transform cache (Tipsify)
+ *
+ * Emits the triangle fan around one vertex at a time and picks the next fan
+ * among the vertices just emitted that will still be cached once their
+ * remaining triangles are, which runs in linear time.
+ */
+void optimize_vertex_cache(std::span<uint32_t> p_indices, size_t p_vertex_count, uint32_t p_cache_size = 16);
+
+/**
+ * @brief Reorders clusters of triangles so outward-facing ones come first
+ *
+ * Expects a cache-optimized order. It is cut into clusters where the cache
+ * runs cold, and where a cut costs at most p_threshold times the mesh's
+ * ACMR. Clusters are then sorted by how far they face away from the mesh's
+ * center, so from most viewpoints nearer surfaces are drawn before the ones
+ * behind them.
+ */
+void optimize_overdraw(std::span<uint32_t> p_indices, std::span<const mesh_vertex> p_vertices, uint32_t p_cache_size = 16,
+                       float p_threshold = 1.05f);
+
+//! @brief Reorders vertices by first use in the index buffer and drops unreferenced ones
+void optimize_vertex_fetch(mesh_geometry& p_geometry);
+
+/**
+ * @brief Quadric edge collapse down to about p_target_index_count indices
+ *
+ * Vertices only ever move onto a neighbour, so the result indexes
+ * p_vertices and needs no new vertex data. Vertices sharing a position are
+ * collapsed together; attribute seams are kept by mapping every corner to
+ * the neighbour's corner on the same side, open borders only collapse
+ * along the border and non-manifold vertices stay locked. Collapses that
+ * would flip a triangle or pinch the surface are skipped.
+ *
+ * @param p_max_error stops early once the next collapse would move the
+ * surface further than this, relative to the mesh's largest extent
+ * @return the error reached, relative to the mesh's largest extent
+ */
+float simplify_mesh(std::span<const mesh_vertex> p_vertices, std::span<const uint32_t> p_indices, size_t p_target_index_count,
+                    float p_max_error, std::vector<uint32_t>& p_out);
+
+/**
+ * @brief Welds p_geometry, generates its LOD chain and reorders every level
+ *
+ * Each extra level is simplified from the previous one, a level that would
+ * not drop at least a tenth of the previous level's triangles ends the chain.
+ * Every level is ordered for the vertex cache and then for overdraw, and the
+ * vertices are finally ordered by first use. p_geometry.indices then holds
+ * the levels back to back with p_geometry.lods describing them.
+ */
+mesh_optimize_report optimize_mesh(mesh_geometry& p_geometry, const mesh_optimize_settings& p_settings = {});
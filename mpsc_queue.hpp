@@ -0,0 +1,76 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * @name mpsc_queue
+ * @brief Bounded lock-free queue for many producers and one consumer
+ *
+ * Cells carry a sequence number (Vyukov's bounded queue) so producers only
+ * contend on a single atomic increment. Storage is allocated inline, pushing
+ * and popping never allocate. try_push fails instead of blocking when full.
+ */
+template<typename T, size_t Capacity>
+class mpsc_queue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "mpsc_queue capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>, "mpsc_queue only stores trivially copyable commands");
+
+public:
+    mpsc_queue() {
+        for(size_t i = 0; i < Capacity; i++) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool try_push(const T& p_value) {
+        size_t position = m_enqueue.load(std::memory_order_relaxed);
+        while(true) {
+            cell& slot = m_cells[position & (Capacity - 1)];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+            if(difference == 0) {
+                if(m_enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.value = p_value;
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if(difference < 0) {
+                return false;
+            }
+            else {
+                position = m_enqueue.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    //! @note only the consumer thread may call this
+    bool try_pop(T& p_value) {
+        size_t position = m_dequeue.load(std::memory_order_relaxed);
+        cell& slot = m_cells[position & (Capacity - 1)];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+        if(static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1) < 0) {
+            return false;
+        }
+
+        p_value = slot.value;
+        slot.sequence.store(position + Capacity, std::memory_order_release);
+        m_dequeue.store(position + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    struct cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    // producer and consumer counters live on separate cache lines
+    alignas(64) std::atomic<size_t> m_enqueue{ 0 };
+    alignas(64) std::atomic<size_t> m_dequeue{ 0 };
+    alignas(64) std::array<cell, Capacity> m_cells;
+};
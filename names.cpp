@@ -0,0 +1,125 @@
+#include "names.hpp"
+#include <algorithm>
+
+name_table::name_table() {
+    // slot 0 backs invalid_name
+    m_names.emplace_back();
+}
+
+name_id name_table::intern(std::string_view p_name) {
+    if(p_name.empty()) {
+        return invalid_name;
+    }
+
+    auto it = m_ids.find(p_name);
+    if(it != m_ids.end()) {
+        return it->second;
+    }
+
+    auto id = static_cast<name_id>(m_names.size());
+    const std::string& stored = m_names.emplace_back(p_name);
+    m_ids.emplace(stored, id);
+    return id;
+}
+
+name_id name_table::find(std::string_view p_name) const {
+    auto it = m_ids.find(p_name);
+    return it != m_ids.end() ? it->second : invalid_name;
+}
+
+std::string_view name_table::view(name_id p_id) const {
+    return p_id < m_names.size() ? std::string_view(m_names[p_id]) : std::string_view();
+}
+
+name_table& interned_names() {
+    static name_table s_names;
+    return s_names;
+}
+
+name_index::~name_index() {
+    detach();
+}
+
+void name_index::attach(flecs::world& p_registry, name_table& p_names) {
+    detach();
+    m_names = &p_names;
+
+    p_registry.query_builder().with<flecs::Identifier>(flecs::Name).build().each([this](flecs::entity p_entity) {
+        set_name(p_entity.id(), p_entity.name().c_str());
+    });
+
+    m_observers.push_back(p_registry.observer().with<flecs::Identifier>(flecs::Name).event(flecs::OnSet).each([this](flecs::entity p_entity) {
+        set_name(p_entity.id(), p_entity.name().c_str());
+    }));
+
+    m_observers.push_back(
+      p_registry.observer().with<flecs::Identifier>(flecs::Name).event(flecs::OnRemove).each([this](flecs::entity p_entity) {
+          erase(p_entity.id());
+      }));
+}
+
+void name_index::detach() {
+    for(flecs::observer& observer : m_observers) {
+        observer.destruct();
+    }
+    m_observers.clear();
+    m_holders.clear();
+    m_entity_names.clear();
+    m_names = nullptr;
+}
+
+void name_index::set_name(flecs::entity_t p_entity, std::string_view p_name) {
+    name_id id = m_names->intern(p_name);
+    auto [it, inserted] = m_entity_names.try_emplace(p_entity, id);
+    if(!inserted) {
+        if(it->second == id) {
+            return;
+        }
+        // renamed, the old name falls back to whoever else still has it
+        release(p_entity, it->second);
+        it->second = id;
+    }
+
+    if(id >= m_holders.size()) {
+        m_holders.resize(id + 1);
+    }
+    m_holders[id].push_back(p_entity);
+}
+
+void name_index::erase(flecs::entity_t p_entity) {
+    auto it = m_entity_names.find(p_entity);
+    if(it == m_entity_names.end()) {
+        return;
+    }
+    release(p_entity, it->second);
+    m_entity_names.erase(it);
+}
+
+void name_index::release(flecs::entity_t p_entity, name_id p_name) {
+    if(p_name >= m_holders.size()) {
+        return;
+    }
+    // almost always a single holder, order is kept so find() stays on the last one named
+    std::vector<flecs::entity_t>& holders = m_holders[p_name];
+    auto holder = std::find(holders.begin(), holders.end(), p_entity);
+    if(holder != holders.end()) {
+        holders.erase(holder);
+    }
+}
+
+flecs::entity_t name_index::find(name_id p_name) const {
+    return p_name < m_holders.size() and !m_holders[p_name].empty() ? m_holders[p_name].back() : 0;
+}
+
+flecs::entity_t name_index::find(std::string_view p_name) const {
+    return m_names != nullptr ? find(m_names->find(p_name)) : 0;
+}
+
+name_id name_index::name_of(flecs::entity_t p_entity) const {
+    auto it = m_entity_names.find(p_entity);
+    return it != m_entity_names.end() ? it->second : invalid_name;
+}
+
+std::string_view name_index::view(flecs::entity_t p_entity) const {
+    return m_names != nullptr ? m_names->view(name_of(p_entity)) : std::string_view();
+}
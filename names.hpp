@@ -0,0 +1,93 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <flecs.h>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+//! Interned string, equal names always get equal ids
+using name_id = uint32_t;
+constexpr name_id invalid_name = 0;
+
+/**
+ * @name name_table
+ * @brief Stores every distinct name once and hands out integer ids for them
+ *
+ * Comparing two name_ids is an integer compare, and interning a name that is
+ * already in the table does not allocate. Ids stay valid for the lifetime of
+ * the table, names are never removed.
+ *
+ * Not thread-safe, intern from the main thread.
+ */
+class name_table {
+public:
+    name_table();
+
+    //! @brief Id of p_name, adding it to the table if it is new
+    name_id intern(std::string_view p_name);
+
+    //! @brief Id of p_name, or invalid_name if it was never interned
+    [[nodiscard]] name_id find(std::string_view p_name) const;
+
+    [[nodiscard]] std::string_view view(name_id p_id) const;
+
+    [[nodiscard]] size_t size() const { return m_names.size() - 1; }
+
+private:
+    // deque so views handed out and used as map keys stay valid as it grows
+    std::deque<std::string> m_names;
+    std::unordered_map<std::string_view, name_id> m_ids;
+};
+
+//! @brief Table shared by the editor and gameplay code
+name_table& interned_names();
+
+/**
+ * @name name_index
+ * @brief O(1) lookups between entities and their interned names
+ *
+ * Kept current by observers on the flecs entity name, so renames and deletes
+ * update it without polling. Flecs allows the same name under different
+ * parents, in that case find() returns the entity that was named last, and
+ * the one named before it once that entity is renamed or deleted.
+ *
+ * The observers capture this, so the object must not move while attached.
+ */
+class name_index {
+public:
+    name_index() = default;
+    ~name_index();
+
+    name_index(const name_index&) = delete;
+    name_index& operator=(const name_index&) = delete;
+
+    void attach(flecs::world& p_registry, name_table& p_names = interned_names());
+
+    //! @brief Removes the observers, call while the world is alive
+    void detach();
+
+    [[nodiscard]] flecs::entity_t find(name_id p_name) const;
+
+    [[nodiscard]] flecs::entity_t find(std::string_view p_name) const;
+
+    [[nodiscard]] name_id name_of(flecs::entity_t p_entity) const;
+
+    [[nodiscard]] std::string_view view(flecs::entity_t p_entity) const;
+
+private:
+    void set_name(flecs::entity_t p_entity, std::string_view p_name);
+
+    void erase(flecs::entity_t p_entity);
+
+    //! @brief Drops p_entity from the holders of p_name
+    void release(flecs::entity_t p_entity, name_id p_name);
+
+private:
+    name_table* m_names=nullptr;
+    std::vector<flecs::observer> m_observers;
+    //! entities holding each name_id in the order they were named, the table hands out dense ids so a vector is enough
+    std::vector<std::vector<flecs::entity_t>> m_holders;
+    std::unordered_map<flecs::entity_t, name_id> m_entity_names;
+};
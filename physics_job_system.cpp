@@ -0,0 +1,75 @@
+#include "physics_job_system.hpp"
+#include <thread>
+
+physics_job_system::physics_job_system(thread_pool& p_pool, const physics_job_settings& p_settings)
+  : JPH::JobSystemWithBarrier(p_settings.max_barriers)
+  , m_pool(p_pool) {
+    m_jobs.Init(p_settings.max_jobs, p_settings.max_jobs);
+}
+
+physics_job_system::~physics_job_system() {
+    // a job the barrier already ran can still be queued on the pool holding a reference
+    std::unique_lock<std::mutex> lock(m_drain_mutex);
+    m_drained.wait(lock, [this]() { return m_in_flight.load(std::memory_order_acquire) == 0; });
+}
+
+int physics_job_system::GetMaxConcurrency() const {
+    return static_cast<int>(m_pool.worker_count()) + 1;
+}
+
+JPH::JobHandle physics_job_system::CreateJob(const char* p_name, JPH::ColorArg p_color, const JobFunction& p_job_function,
+                                             JPH::uint32 p_dependency_count) {
+    JPH::uint32 index;
+    while(true) {
+        index = m_jobs.ConstructObject(p_name, p_color, this, p_job_function, p_dependency_count);
+        if(index != job_list::cInvalidObjectIndex) {
+            break;
+        }
+        // out of job slots, wait for running jobs to free some
+        std::this_thread::yield();
+    }
+
+    Job* job = &m_jobs.Get(index);
+    JPH::JobHandle handle(job);
+    if(p_dependency_count == 0) {
+        QueueJob(job);
+    }
+    return handle;
+}
+
+void physics_job_system::QueueJob(Job* p_job) {
+    p_job->AddRef();
+    m_in_flight.fetch_add(1, std::memory_order_relaxed);
+    m_pool.post([this, p_job]() {
+        // no-op when the barrier already picked the job up
+        p_job->Execute();
+        p_job->Release();
+        release_in_flight();
+    });
+}
+
+void physics_job_system::release_in_flight() {
+    // all but the last release stay lock free
+    uint32_t count = m_in_flight.load(std::memory_order_relaxed);
+    while(count > 1 and !m_in_flight.compare_exchange_weak(count, count - 1, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+    if(count > 1) {
+        return;
+    }
+
+    // dropping to zero under the lock keeps the destructor from returning, and freeing the
+    // mutex, between the decrement and the notify
+    std::lock_guard<std::mutex> lock(m_drain_mutex);
+    m_in_flight.fetch_sub(1, std::memory_order_release);
+    m_drained.notify_all();
+}
+
+void physics_job_system::QueueJobs(Job** p_jobs, JPH::uint p_job_count) {
+    for(JPH::uint i = 0; i < p_job_count; i++) {
+        QueueJob(p_jobs[i]);
+    }
+}
+
+void physics_job_system::FreeJob(Job* p_job) {
+    m_jobs.DestructObject(p_job);
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/FixedSizeFreeList.h>
+#include <Jolt/Core/JobSystemWithBarrier.h>
+#include <Jolt/Physics/PhysicsSettings.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread_pool.hpp>
+
+struct physics_job_settings {
+    //! jobs that can be alive at once, a physics step allocates a few per island batch
+    uint32_t max_jobs = JPH::cMaxPhysicsJobs;
+    uint32_t max_barriers = JPH::cMaxPhysicsBarriers;
+};
+
+/**
+ * @name physics_job_system
+ * @brief Runs Jolt's physics jobs on a thread_pool instead of Jolt's own threads
+ *
+ * Mirrors JPH::JobSystemThreadPool, except that queued jobs are posted to
+ * p_pool, so a physics step and gameplay fan-out can share one set of
+ * workers.
+ *
+ * The thread calling PhysicsSystem::Update also runs jobs while it waits on
+ * the step's barrier, so the concurrency is the pool's workers plus one.
+ *
+ * Only benchmarks/physics_step_bench.cpp drives Jolt through it today.
+ * atlas::physics::physics_engine builds its own job system and
+ * jolt_settings has no way to pass one in, so main_scene's physics still
+ * runs on Jolt's threads.
+ */
+class physics_job_system final : public JPH::JobSystemWithBarrier {
+public:
+    physics_job_system(thread_pool& p_pool, const physics_job_settings& p_settings = {});
+    ~physics_job_system() override;
+
+    physics_job_system(const physics_job_system&) = delete;
+    physics_job_system& operator=(const physics_job_system&) = delete;
+
+    int GetMaxConcurrency() const override;
+
+    JPH::JobHandle CreateJob(const char* p_name, JPH::ColorArg p_color, const JobFunction& p_job_function,
+                             JPH::uint32 p_dependency_count = 0) override;
+
+protected:
+    void QueueJob(Job* p_job) override;
+
+    void QueueJobs(Job** p_jobs, JPH::uint p_job_count) override;
+
+    void FreeJob(Job* p_job) override;
+
+private:
+    //! @brief Drops a pool task's hold on the job system, waking the destructor on the last one
+    void release_in_flight();
+
+private:
+    using job_list = JPH::FixedSizeFreeList<Job>;
+
+    thread_pool& m_pool;
+    job_list m_jobs;
+    //! jobs posted to the pool that have not released their reference yet
+    std::atomic<uint32_t> m_in_flight{ 0 };
+    // the last release happens under m_drain_mutex, see release_in_flight()
+    std::mutex m_drain_mutex;
+    std::condition_variable m_drained;
+};
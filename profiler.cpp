@@ -0,0 +1,234 @@
+#include "profiler.hpp"
+
+#if GAME_TEMPLATE_PROFILER
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <mutex>
+
+namespace profiler {
+    namespace {
+        constexpr uint32_t invalid_slot = std::numeric_limits<uint32_t>::max();
+
+        //! a slot is reused once the ring wraps, so snapshot() can read it while it is rewritten
+        struct record {
+            //! odd while begin_zone rewrites the slot, snapshot() drops a read that saw it change
+            std::atomic<uint32_t> sequence;
+            std::atomic<const char*> name;
+            std::atomic<uint64_t> begin_ns;
+            //! 0 until the zone closes
+            std::atomic<uint64_t> end_ns;
+            std::atomic<uint32_t> depth;
+        };
+
+        struct thread_buffer {
+            std::string name;
+            std::unique_ptr<record[]> records = std::make_unique<record[]>(zone_capacity);
+            //! zones opened so far, the ring slot is written % zone_capacity
+            std::atomic<uint64_t> written{ 0 };
+            uint32_t depth = 0;
+        };
+
+        std::mutex s_threads_mutex;
+        // buffers outlive their threads so a capture can still read them
+        std::vector<std::unique_ptr<thread_buffer>> s_threads;
+
+        std::atomic<bool> s_paused{ false };
+        std::array<std::atomic<uint64_t>, frame_capacity> s_frames{};
+        std::atomic<uint64_t> s_frame_count{ 0 };
+
+        thread_local thread_buffer* t_buffer = nullptr;
+
+        thread_buffer& local_buffer() {
+            if(t_buffer == nullptr) {
+                std::lock_guard<std::mutex> lock(s_threads_mutex);
+                s_threads.push_back(std::make_unique<thread_buffer>());
+                t_buffer = s_threads.back().get();
+                t_buffer->name = "thread " + std::to_string(s_threads.size() - 1);
+            }
+            return *t_buffer;
+        }
+
+        void write_escaped(std::FILE* p_file, const char* p_text) {
+            for(const char* c = p_text; *c != '\0'; c++) {
+                if(*c == '"' or *c == '\\') {
+                    std::fputc('\\', p_file);
+                }
+                std::fputc(*c, p_file);
+            }
+        }
+    }
+
+    uint64_t now_ns() {
+        return static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    uint32_t begin_zone(const char* p_name, uint64_t p_begin_ns) {
+        if(s_paused.load(std::memory_order_relaxed)) {
+            return invalid_slot;
+        }
+
+        thread_buffer& buffer = local_buffer();
+        uint64_t index = buffer.written.load(std::memory_order_relaxed);
+        auto slot = static_cast<uint32_t>(index % zone_capacity);
+        record& entry = buffer.records[slot];
+        uint32_t sequence = entry.sequence.load(std::memory_order_relaxed);
+        entry.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        entry.name.store(p_name, std::memory_order_relaxed);
+        entry.begin_ns.store(p_begin_ns, std::memory_order_relaxed);
+        entry.end_ns.store(0, std::memory_order_relaxed);
+        entry.depth.store(buffer.depth++, std::memory_order_relaxed);
+        entry.sequence.store(sequence + 2, std::memory_order_release);
+        buffer.written.store(index + 1, std::memory_order_release);
+        return slot;
+    }
+
+    void end_zone(uint32_t p_slot, uint64_t p_end_ns) {
+        if(p_slot == invalid_slot) {
+            return;
+        }
+        thread_buffer& buffer = *t_buffer;
+        buffer.records[p_slot].end_ns.store(p_end_ns, std::memory_order_release);
+        buffer.depth--;
+    }
+
+    void frame_mark() {
+        if(s_paused.load(std::memory_order_relaxed)) {
+            return;
+        }
+        uint64_t index = s_frame_count.load(std::memory_order_relaxed);
+        s_frames[index % frame_capacity].store(now_ns(), std::memory_order_relaxed);
+        s_frame_count.store(index + 1, std::memory_order_release);
+    }
+
+    void set_thread_name(const char* p_name) {
+        thread_buffer& buffer = local_buffer();
+        std::lock_guard<std::mutex> lock(s_threads_mutex);
+        buffer.name = p_name;
+    }
+
+    void set_paused(bool p_paused) {
+        s_paused.store(p_paused, std::memory_order_relaxed);
+    }
+
+    bool paused() {
+        return s_paused.load(std::memory_order_relaxed);
+    }
+
+    capture snapshot(uint64_t p_from_ns, uint64_t p_to_ns) {
+        capture result;
+        snapshot(result, p_from_ns, p_to_ns);
+        return result;
+    }
+
+    void snapshot(capture& p_result, uint64_t p_from_ns, uint64_t p_to_ns) {
+        p_result.frame_starts.clear();
+
+        uint64_t frame_count = s_frame_count.load(std::memory_order_acquire);
+        uint64_t first_frame = frame_count > frame_capacity ? frame_count - frame_capacity : 0;
+        for(uint64_t i = first_frame; i < frame_count; i++) {
+            p_result.frame_starts.push_back(s_frames[i % frame_capacity].load(std::memory_order_relaxed));
+        }
+
+        std::lock_guard<std::mutex> lock(s_threads_mutex);
+        p_result.threads.resize(s_threads.size());
+        for(size_t t = 0; t < s_threads.size(); t++) {
+            const thread_buffer* buffer = s_threads[t].get();
+            thread_capture& thread = p_result.threads[t];
+            thread.name = buffer->name;
+            thread.zones.clear();
+
+            // newest first, zones open in begin order so the walk can stop at p_from_ns
+            uint64_t written = buffer->written.load(std::memory_order_acquire);
+            uint64_t oldest = written > zone_capacity ? written - zone_capacity : 0;
+            for(uint64_t i = written; i > oldest; i--) {
+                const record& entry = buffer->records[(i - 1) % zone_capacity];
+                uint32_t sequence = entry.sequence.load(std::memory_order_acquire);
+                if(sequence & 1) {
+                    continue;
+                }
+                zone copy{ entry.name.load(std::memory_order_relaxed), entry.begin_ns.load(std::memory_order_relaxed),
+                           entry.end_ns.load(std::memory_order_acquire), entry.depth.load(std::memory_order_relaxed) };
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if(entry.sequence.load(std::memory_order_relaxed) != sequence) {
+                    // the ring wrapped onto this slot while it was copied
+                    continue;
+                }
+
+                if(copy.begin_ns < p_from_ns) {
+                    break;
+                }
+                if(copy.end_ns == 0 or copy.begin_ns >= p_to_ns) {
+                    continue;
+                }
+                thread.zones.push_back(copy);
+            }
+            std::reverse(thread.zones.begin(), thread.zones.end());
+        }
+    }
+
+    bool write_chrome_trace(const std::string& p_path, const capture& p_capture) {
+        std::FILE* file = std::fopen(p_path.c_str(), "w");
+        if(file == nullptr) {
+            return false;
+        }
+
+        uint64_t origin = std::numeric_limits<uint64_t>::max();
+        for(const thread_capture& thread : p_capture.threads) {
+            if(!thread.zones.empty()) {
+                origin = std::min(origin, thread.zones.front().begin_ns);
+            }
+        }
+        if(!p_capture.frame_starts.empty()) {
+            origin = std::min(origin, p_capture.frame_starts.front());
+        }
+
+        auto micros = [origin](uint64_t p_ns) { return static_cast<double>(p_ns - origin) / 1000.0; };
+
+        std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        bool first = true;
+        auto separator = [&]() {
+            if(!first) {
+                std::fprintf(file, ",\n");
+            }
+            first = false;
+        };
+
+        for(size_t tid = 0; tid < p_capture.threads.size(); tid++) {
+            const thread_capture& thread = p_capture.threads[tid];
+            separator();
+            std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"", tid);
+            write_escaped(file, thread.name.c_str());
+            std::fprintf(file, "\"}}");
+
+            for(const zone& entry : thread.zones) {
+                // a hand-built capture can hold one, the unsigned duration would wrap
+                if(entry.end_ns < entry.begin_ns) {
+                    continue;
+                }
+                separator();
+                std::fprintf(file, "{\"name\":\"");
+                write_escaped(file, entry.name);
+                std::fprintf(file, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f}", tid, micros(entry.begin_ns),
+                             static_cast<double>(entry.end_ns - entry.begin_ns) / 1000.0);
+            }
+        }
+
+        // frame boundaries show up as instant events across the whole process
+        for(uint64_t frame_start : p_capture.frame_starts) {
+            separator();
+            std::fprintf(file, "{\"name\":\"frame\",\"ph\":\"i\",\"s\":\"p\",\"pid\":1,\"tid\":0,\"ts\":%.3f}", micros(frame_start));
+        }
+
+        std::fprintf(file, "\n]}\n");
+        return std::fclose(file) == 0;
+    }
+}
+
+#endif
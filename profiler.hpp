@@ -0,0 +1,105 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Scoped-zone frame profiler
+ *
+ * PROFILE_ZONE("name") times the enclosing scope, PROFILE_FRAME() marks the
+ * start of a new frame on the main thread. Zones are written into a ring
+ * buffer owned by the thread that recorded them, so recording takes no locks
+ * and never allocates after the thread's first zone.
+ *
+ * Only Debug and RelWithDebInfo builds record zones. Other configurations,
+ * or -DGAME_TEMPLATE_PROFILER=OFF, compile every macro, the recorder and
+ * the panel out of the build.
+ */
+
+#if GAME_TEMPLATE_PROFILER
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+//! @brief Times the rest of the enclosing scope, p_name must be a string literal
+#define PROFILE_ZONE(p_name) profiler::scoped_zone PROFILE_CONCAT(profile_zone_, __LINE__)(p_name)
+#define PROFILE_FRAME() profiler::frame_mark()
+#define PROFILE_THREAD_NAME(p_name) profiler::set_thread_name(p_name)
+
+namespace profiler {
+    struct zone {
+        //! string literal passed to PROFILE_ZONE
+        const char* name;
+        uint64_t begin_ns;
+        uint64_t end_ns;
+        uint32_t depth;
+    };
+
+    //! zones kept per thread, older zones are overwritten
+    constexpr uint32_t zone_capacity = 1u << 16;
+    //! frame starts kept for the panel
+    constexpr uint32_t frame_capacity = 256;
+
+    uint64_t now_ns();
+
+    //! @brief Index of the zone about to be written, -1 while the profiler is paused
+    uint32_t begin_zone(const char* p_name, uint64_t p_begin_ns);
+
+    void end_zone(uint32_t p_slot, uint64_t p_end_ns);
+
+    void frame_mark();
+
+    void set_thread_name(const char* p_name);
+
+    //! @brief Stops recording zones and frames, recorded data stays for inspection
+    void set_paused(bool p_paused);
+
+    bool paused();
+
+    class scoped_zone {
+    public:
+        scoped_zone(const char* p_name) : m_slot(begin_zone(p_name, now_ns())) {}
+
+        ~scoped_zone() { end_zone(m_slot, now_ns()); }
+
+        scoped_zone(const scoped_zone&) = delete;
+        scoped_zone& operator=(const scoped_zone&) = delete;
+
+    private:
+        uint32_t m_slot;
+    };
+
+    struct thread_capture {
+        std::string name;
+        std::vector<zone> zones;
+    };
+
+    struct capture {
+        //! start of every recorded frame, oldest first
+        std::vector<uint64_t> frame_starts;
+        std::vector<thread_capture> threads;
+    };
+
+    /**
+     * @brief Copies the closed zones that began between p_from_ns and p_to_ns
+     *
+     * Only walks back as far as p_from_ns, so grabbing one frame is cheap
+     * even with full buffers. Zones written while the copy runs may be
+     * skipped, pause first for an exact snapshot.
+     */
+    capture snapshot(uint64_t p_from_ns = 0, uint64_t p_to_ns = UINT64_MAX);
+
+    //! @brief Same as snapshot() but fills p_result, reusing its storage so repeated calls do not allocate
+    void snapshot(capture& p_result, uint64_t p_from_ns = 0, uint64_t p_to_ns = UINT64_MAX);
+
+    //! @brief Writes p_capture as Chrome trace event JSON, open with chrome://tracing or Perfetto
+    bool write_chrome_trace(const std::string& p_path, const capture& p_capture);
+}
+
+#else
+
+#define PROFILE_ZONE(p_name) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#define PROFILE_THREAD_NAME(p_name) ((void)0)
+
+#endif
@@ -0,0 +1,119 @@
+#include "profiler_panel.hpp"
+
+#if GAME_TEMPLATE_PROFILER
+
+#include <algorithm>
+#include <cstdio>
+#include <frame_arena.hpp>
+#include <hash.hpp>
+#include <imgui.h>
+
+namespace {
+    constexpr float lane_row_height = 18.f;
+
+    //! stable color per zone name so the same zone looks the same every frame
+    ImU32 zone_color(const char* p_name) {
+        uint64_t hash = fnv1a(p_name);
+        auto channel = [hash](int p_shift) { return static_cast<int>(96 + ((hash >> p_shift) & 0x7f)); };
+        return IM_COL32(channel(0), channel(8), channel(16), 255);
+    }
+}
+
+void profiler_panel::render() {
+    // the panel draws once per frame, so the count between two calls is one frame's worth
+    m_allocations.frame_mark();
+
+    if(ImGui::Begin("Profiler")) {
+        bool paused = profiler::paused();
+        if(ImGui::Checkbox("Pause", &paused)) {
+            profiler::set_paused(paused);
+            m_frames_back = 0;
+        }
+
+        // only the frame starts are needed to pick a frame, zones are fetched for that frame alone
+        profiler::snapshot(m_frames, UINT64_MAX);
+        int complete_frames = static_cast<int>(m_frames.frame_starts.size()) - 1;
+        if(complete_frames > 0) {
+            if(paused) {
+                ImGui::SameLine();
+                ImGui::SliderInt("Frames back", &m_frames_back, 0, complete_frames - 1);
+            }
+            m_frames_back = std::clamp(m_frames_back, 0, complete_frames - 1);
+
+            size_t end_index = m_frames.frame_starts.size() - 1 - static_cast<size_t>(m_frames_back);
+            uint64_t frame_begin = m_frames.frame_starts[end_index - 1];
+            uint64_t frame_end = m_frames.frame_starts[end_index];
+            ImGui::Text("Frame: %.3f ms", static_cast<double>(frame_end - frame_begin) / 1e6);
+
+            profiler::snapshot(m_frame, frame_begin, frame_end);
+            draw_flame(m_frame, frame_begin, frame_end);
+        }
+        else {
+            ImGui::TextUnformatted("Waiting for frames...");
+        }
+
+        if(allocation_counter::enabled()) {
+            ImGui::Text("Heap allocations (main thread): %llu last frame, %llu peak",
+                        static_cast<unsigned long long>(m_allocations.last_frame()), static_cast<unsigned long long>(m_allocations.peak()));
+        }
+        const frame_arena& arena = frame_memory();
+        ImGui::Text("Frame arena: %.1f KB peak of %.1f KB", static_cast<double>(arena.peak()) / 1024.0, static_cast<double>(arena.capacity()) / 1024.0);
+
+        if(ImGui::Button("Export Chrome Trace")) {
+            bool written = profiler::write_chrome_trace(m_trace_path, profiler::snapshot());
+            m_status = written ? "Wrote " + m_trace_path : "Could not write " + m_trace_path;
+        }
+        if(!m_status.empty()) {
+            ImGui::SameLine();
+            ImGui::TextUnformatted(m_status.c_str());
+        }
+    }
+    ImGui::End();
+}
+
+void profiler_panel::draw_flame(const profiler::capture& p_capture, uint64_t p_frame_begin, uint64_t p_frame_end) {
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    float width = std::max(ImGui::GetContentRegionAvail().x, 1.f);
+    double scale = static_cast<double>(width) / static_cast<double>(std::max<uint64_t>(p_frame_end - p_frame_begin, 1));
+
+    for(const profiler::thread_capture& thread : p_capture.threads) {
+        if(thread.zones.empty()) {
+            continue;
+        }
+
+        ImGui::TextUnformatted(thread.name.c_str());
+        uint32_t max_depth = 0;
+        for(const profiler::zone& entry : thread.zones) {
+            max_depth = std::max(max_depth, entry.depth);
+        }
+
+        ImVec2 origin = ImGui::GetCursorScreenPos();
+        for(const profiler::zone& entry : thread.zones) {
+            // zones straddling the frame edges are clamped to the view
+            uint64_t begin = std::max(entry.begin_ns, p_frame_begin);
+            uint64_t end = std::min(entry.end_ns, p_frame_end);
+            if(end <= begin) {
+                continue;
+            }
+
+            ImVec2 min(origin.x + static_cast<float>(static_cast<double>(begin - p_frame_begin) * scale),
+                       origin.y + static_cast<float>(entry.depth) * lane_row_height);
+            ImVec2 max(origin.x + static_cast<float>(static_cast<double>(end - p_frame_begin) * scale), min.y + lane_row_height - 1.f);
+            max.x = std::max(max.x, min.x + 1.f);
+            draw_list->AddRectFilled(min, max, zone_color(entry.name));
+
+            // labels only where they fit
+            if(max.x - min.x > ImGui::CalcTextSize(entry.name).x + 4.f) {
+                draw_list->AddText(ImVec2(min.x + 2.f, min.y + 1.f), IM_COL32(0, 0, 0, 255), entry.name);
+            }
+
+            if(ImGui::IsMouseHoveringRect(min, max)) {
+                ImGui::SetTooltip("%s\n%.3f ms", entry.name, static_cast<double>(entry.end_ns - entry.begin_ns) / 1e6);
+            }
+        }
+
+        ImGui::Dummy(ImVec2(width, static_cast<float>(max_depth + 1) * lane_row_height));
+    }
+}
+
+#endif
@@ -0,0 +1,37 @@
+#pragma once
+#include "profiler.hpp"
+
+#if GAME_TEMPLATE_PROFILER
+
+#include <string>
+#include "allocation_counter.hpp"
+
+/**
+ * @name profiler_panel
+ * @brief ImGui window with a flame view of one recorded frame
+ *
+ * Shows the last complete frame while recording. Pausing freezes the
+ * recording so older frames can be picked with the slider, and the whole
+ * capture can be written out as a Chrome trace. Also shows the main
+ * thread's heap allocations per frame and how much of the frame arena is
+ * in use.
+ */
+class profiler_panel {
+public:
+    void render();
+
+private:
+    void draw_flame(const profiler::capture& p_capture, uint64_t p_frame_begin, uint64_t p_frame_end);
+
+private:
+    //! frames back from the newest complete frame
+    int m_frames_back=0;
+    std::string m_trace_path = "profile_capture.json";
+    std::string m_status;
+    // refilled every frame, keeping them around means drawing the panel does not allocate
+    profiler::capture m_frames;
+    profiler::capture m_frame;
+    allocation_counter::frame_meter m_allocations;
+};
+
+#endif
@@ -0,0 +1,145 @@
+#include "render_batches.hpp"
+#include <core/engine_logger.hpp>
+#include <core/math/utilities.hpp>
+#include <algorithm>
+
+namespace {
+    //! translation * rotation * scale, built from the rotation's columns instead of three matrix products
+    glm::mat4 model_matrix(const atlas::transform& p_transform) {
+        glm::mat3 rotation = glm::mat3_cast(atlas::to_quat(p_transform.quaternion));
+        glm::mat4 model(1.f);
+        model[0] = glm::vec4(rotation[0] * p_transform.scale.x, 0.f);
+        model[1] = glm::vec4(rotation[1] * p_transform.scale.y, 0.f);
+        model[2] = glm::vec4(rotation[2] * p_transform.scale.z, 0.f);
+        model[3] = glm::vec4(p_transform.position, 1.f);
+        return model;
+    }
+}
+
+render_batcher::~render_batcher() {
+    detach();
+}
+
+void render_batcher::attach(flecs::world& p_registry, name_table& p_names) {
+    detach();
+    m_world = p_registry.c_ptr();
+    m_names = &p_names;
+    m_new_query = p_registry.query_builder<const atlas::transform, const atlas::material>().without<render_batch_key>().build();
+    m_query = p_registry.query_builder<const atlas::transform, const atlas::material, const render_batch_key>().build();
+
+    // a material that switches model or texture moves to another group
+    m_on_material = p_registry.observer<const atlas::material, render_batch_key>().event(flecs::OnSet).each(
+      [this](flecs::entity, const atlas::material& p_material, render_batch_key& p_key) { p_key.group = group_of(p_material); });
+}
+
+void render_batcher::detach() {
+    if(m_world == nullptr) {
+        return;
+    }
+
+    m_on_material.destruct();
+    m_new_query.destruct();
+    m_query.destruct();
+    m_world = nullptr;
+
+    m_groups.clear();
+    m_group_ids.clear();
+    m_batches.clear();
+    m_instances.clear();
+    m_stats = {};
+}
+
+uint32_t render_batcher::group_of(const atlas::material& p_material) {
+    name_id model_path = m_names->intern(p_material.model_path);
+    name_id texture_path = m_names->intern(p_material.texture_path);
+    uint64_t pair = (static_cast<uint64_t>(model_path) << 32) | texture_path;
+
+    auto [it, inserted] = m_group_ids.try_emplace(pair, static_cast<uint32_t>(m_groups.size()));
+    if(inserted) {
+        m_groups.push_back({ model_path, texture_path });
+    }
+    return it->second;
+}
+
+void render_batcher::assign_keys() {
+    // components are only added after the query finished iterating
+    m_pending.clear();
+    m_new_query.each([this](flecs::entity p_entity, const atlas::transform&, const atlas::material&) { m_pending.push_back(p_entity); });
+    for(flecs::entity entity : m_pending) {
+        entity.set<render_batch_key>({ group_of(*entity.get<atlas::material>()) });
+    }
+    m_pending.clear();
+}
+
+void render_batcher::add(uint32_t p_group, uint32_t p_lod, const atlas::transform& p_transform, const atlas::material& p_material) {
+    m_unsorted.push_back({ model_matrix(p_transform), p_material.color });
+    m_buckets.push_back(p_group * max_lods + std::min(p_lod, max_lods - 1));
+}
+
+void render_batcher::build(flecs::world& p_registry) {
+    if(m_world != p_registry.c_ptr()) {
+        console_log_error("render_batcher::build called on a world it is not attached to");
+        return;
+    }
+
+    assign_keys();
+    m_unsorted.clear();
+    m_buckets.clear();
+    m_query.each([this](flecs::entity, const atlas::transform& p_transform, const atlas::material& p_material, const render_batch_key& p_key) {
+        add(p_key.group, 0, p_transform, p_material);
+    });
+    finish();
+}
+
+void render_batcher::build(flecs::world& p_registry, std::span<const visible_entity> p_visible) {
+    if(m_world != p_registry.c_ptr()) {
+        console_log_error("render_batcher::build called on a world it is not attached to");
+        return;
+    }
+
+    assign_keys();
+    m_unsorted.clear();
+    m_buckets.clear();
+    for(const visible_entity& visible : p_visible) {
+        flecs::entity entity = p_registry.entity(visible.entity);
+        const atlas::transform* transform = entity.get<atlas::transform>();
+        const atlas::material* material = entity.get<atlas::material>();
+        const render_batch_key* key = entity.get<render_batch_key>();
+        if(transform == nullptr or material == nullptr or key == nullptr) {
+            continue;
+        }
+        add(key->group, visible.lod, *transform, *material);
+    }
+    finish();
+}
+
+void render_batcher::finish() {
+    m_offsets.assign(m_groups.size() * max_lods, 0);
+    for(uint32_t bucket : m_buckets) {
+        m_offsets[bucket]++;
+    }
+
+    // one batch per non-empty bucket, the counts turn into each bucket's write position
+    m_batches.clear();
+    uint32_t first = 0;
+    for(size_t bucket = 0; bucket < m_offsets.size(); bucket++) {
+        uint32_t count = m_offsets[bucket];
+        m_offsets[bucket] = first;
+        if(count == 0) {
+            continue;
+        }
+
+        const group& pair = m_groups[bucket / max_lods];
+        m_batches.push_back({ pair.model_path, pair.texture_path, static_cast<uint32_t>(bucket % max_lods), first, count });
+        first += count;
+    }
+
+    m_instances.resize(m_unsorted.size());
+    for(size_t i = 0; i < m_unsorted.size(); i++) {
+        m_instances[m_offsets[m_buckets[i]]++] = m_unsorted[i];
+    }
+
+    m_stats.instances = static_cast<uint32_t>(m_instances.size());
+    m_stats.batches = static_cast<uint32_t>(m_batches.size());
+    m_stats.groups = static_cast<uint32_t>(m_groups.size());
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <flecs.h>
+#include <glm/glm.hpp>
+#include <core/scene/components.hpp>
+#include "names.hpp"
+#include "visibility.hpp"
+
+/**
+ * @brief One instance as experimental-shaders/instanced.vert reads it
+ *
+ * Matches the std430 layout of the shader's Instance struct, the same model
+ * matrix and color MaterialSource holds per object.
+ */
+struct instance_data {
+    glm::mat4 model;
+    glm::vec4 color;
+};
+static_assert(sizeof(instance_data) == 80, "instance_data must match the std430 Instance struct");
+
+//! One instanced draw: every instance in the range shares the model, texture and LOD
+struct draw_batch {
+    name_id model_path=invalid_name;
+    name_id texture_path=invalid_name;
+    uint32_t lod=0;
+    //! first instance in render_batcher::instances(), passed as the draw's firstInstance
+    uint32_t first_instance=0;
+    uint32_t instance_count=0;
+};
+
+//! The entity's (model_path, texture_path) pair, managed by render_batcher
+struct render_batch_key {
+    uint32_t group=0;
+};
+
+/**
+ * @name render_batcher
+ * @brief Groups entities with an atlas::material into instanced draws
+ *
+ * Entities that use the same model, texture and LOD become one draw_batch,
+ * and every instance's model matrix and color is packed into one array laid
+ * out for a storage buffer, so the number of draws grows with the distinct
+ * (model, texture, LOD) triples instead of the entity count.
+ *
+ * Paths are interned once per material change into a render_batch_key, so
+ * build() does no string work. Instances are bucketed with a counting sort,
+ * which keeps a batch's instances in the order they were visited.
+ *
+ * The observer captures this, so the object must not move while attached.
+ */
+class render_batcher {
+public:
+    struct frame_stats {
+        uint32_t instances=0;
+        uint32_t batches=0;
+        //! distinct (model, texture) pairs seen since attach
+        uint32_t groups=0;
+    };
+
+    render_batcher() = default;
+
+    ~render_batcher();
+
+    render_batcher(const render_batcher&) = delete;
+    render_batcher& operator=(const render_batcher&) = delete;
+
+    //! @brief Starts batching p_registry, detaching from any previous world
+    void attach(flecs::world& p_registry, name_table& p_names = interned_names());
+
+    //! @brief Removes the observer and queries, call while the world is still alive
+    void detach();
+
+    //! @brief Batches every entity with a transform and a material at LOD 0
+    void build(flecs::world& p_registry);
+
+    //! @brief Batches only p_visible, at the LOD visibility_system picked for each
+    void build(flecs::world& p_registry, std::span<const visible_entity> p_visible);
+
+    //! @brief Batches of one (model, texture) pair are adjacent, ordered by LOD
+    [[nodiscard]] std::span<const draw_batch> batches() const { return m_batches; }
+
+    //! @brief Every batch's instances back to back, ready to upload as the instance storage buffer
+    [[nodiscard]] std::span<const instance_data> instances() const { return m_instances; }
+
+    [[nodiscard]] const frame_stats& stats() const { return m_stats; }
+
+private:
+    struct group {
+        name_id model_path;
+        name_id texture_path;
+    };
+
+    //! @brief Group of a material's paths, adding a group for new pairs
+    uint32_t group_of(const atlas::material& p_material);
+
+    //! @brief Gives entities that have none yet their render_batch_key
+    void assign_keys();
+
+    void add(uint32_t p_group, uint32_t p_lod, const atlas::transform& p_transform, const atlas::material& p_material);
+
+    //! @brief Sorts the instances added since the last build into batches
+    void finish();
+
+private:
+    static constexpr uint32_t max_lods = visibility_system::lod_count;
+
+    name_table* m_names=nullptr;
+    std::vector<group> m_groups;
+    std::unordered_map<uint64_t, uint32_t> m_group_ids;
+
+    // instances in visiting order and their bucket, group * max_lods + lod
+    std::vector<instance_data> m_unsorted;
+    std::vector<uint32_t> m_buckets;
+    //! instance count per bucket, then where each bucket's next instance goes
+    std::vector<uint32_t> m_offsets;
+
+    std::vector<draw_batch> m_batches;
+    std::vector<instance_data> m_instances;
+    frame_stats m_stats;
+    std::vector<flecs::entity> m_pending;
+
+    flecs::world_t* m_world=nullptr;
+    flecs::query<const atlas::transform, const atlas::material> m_new_query;
+    flecs::query<const atlas::transform, const atlas::material, const render_batch_key> m_query;
+    flecs::observer m_on_material;
+};
@@ -0,0 +1,267 @@
+#include "scene_document.hpp"
+#include <core/engine_logger.hpp>
+#include <fstream>
+#include <yaml-cpp/yaml.h>
+
+namespace {
+    glm::vec2 read_vec2(const YAML::Node& p_node, glm::vec2 p_default = glm::vec2(0.f)) {
+        if(!p_node or !p_node.IsSequence() or p_node.size() != 2) {
+            return p_default;
+        }
+        return { p_node[0].as<float>(), p_node[1].as<float>() };
+    }
+
+    glm::vec3 read_vec3(const YAML::Node& p_node, glm::vec3 p_default = glm::vec3(0.f)) {
+        if(!p_node or !p_node.IsSequence() or p_node.size() != 3) {
+            return p_default;
+        }
+        return { p_node[0].as<float>(), p_node[1].as<float>(), p_node[2].as<float>() };
+    }
+
+    glm::vec4 read_vec4(const YAML::Node& p_node, glm::vec4 p_default = glm::vec4(0.f)) {
+        if(!p_node or !p_node.IsSequence() or p_node.size() != 4) {
+            return p_default;
+        }
+        return { p_node[0].as<float>(), p_node[1].as<float>(), p_node[2].as<float>(), p_node[3].as<float>() };
+    }
+
+    template<typename T>
+    T read_value(const YAML::Node& p_node, T p_default) {
+        return p_node ? p_node.as<T>() : p_default;
+    }
+
+    YAML::Emitter& write_vec(YAML::Emitter& p_out, const float* p_values, int p_count) {
+        p_out << YAML::Flow << YAML::BeginSeq;
+        for(int i = 0; i < p_count; i++) {
+            p_out << p_values[i];
+        }
+        return p_out << YAML::EndSeq;
+    }
+
+    YAML::Emitter& operator<<(YAML::Emitter& p_out, const glm::vec2& p_value) {
+        return write_vec(p_out, &p_value.x, 2);
+    }
+
+    YAML::Emitter& operator<<(YAML::Emitter& p_out, const glm::vec3& p_value) {
+        return write_vec(p_out, &p_value.x, 3);
+    }
+
+    YAML::Emitter& operator<<(YAML::Emitter& p_out, const glm::vec4& p_value) {
+        return write_vec(p_out, &p_value.x, 4);
+    }
+
+    scene_entity_desc read_entity(const YAML::Node& p_node) {
+        scene_entity_desc entity;
+        entity.name = p_node["Entity"].as<std::string>();
+
+        if(auto transform = p_node["Transform"]) {
+            entity.transform = scene_format::transform_record{
+                .position = read_vec3(transform["Position"]),
+                .rotation = read_vec3(transform["Rotation"]),
+                .scale = read_vec3(transform["Scale"], glm::vec3(1.f)),
+                .quaternion = read_vec4(transform["Quaternion"], { 0.f, 0.f, 0.f, 1.f }),
+            };
+        }
+
+        if(auto camera = p_node["PerspectiveCamera"]) {
+            entity.perspective_camera = scene_format::perspective_camera_record{
+                .plane = read_vec2(camera["Plane"], { 0.1f, 5000.f }),
+                .field_of_view = read_value(camera["Field of View"], 45.f),
+                .is_active = read_value(camera["Active"], false) ? 1u : 0u,
+            };
+        }
+
+        if(auto material = p_node["Material"]) {
+            entity.material = scene_material_desc{
+                .color = read_vec4(material["Color"], glm::vec4(1.f)),
+                .model_path = read_value<std::string>(material["Model Path"], ""),
+                .texture_path = read_value<std::string>(material["Texture Path"], ""),
+            };
+        }
+
+        if(auto body = p_node["Physics Body"]) {
+            entity.physics_body = scene_format::physics_body_record{
+                .linear_velocity = read_vec3(body["Linear Velocity"]),
+                .angular_velocity = read_vec3(body["Angular Velocity"]),
+                .cumulative_force = read_vec3(body["Cumulative Force"]),
+                .cumulative_torque = read_vec3(body["Cumulative Torque"]),
+                .center_mass_position = read_vec3(body["Center Mass Position"]),
+                .mass_factor = read_value(body["Mass Factor"], 1.f),
+                .friction = read_value(body["Friction"], 0.8f),
+                .restitution = read_value(body["Restitution"], 0.2f),
+                .body_movement_type = read_value(body["Body Movement Type"], 0u),
+                .body_layer_type = read_value(body["Body Layer Type"], 0u),
+            };
+        }
+
+        if(auto collider = p_node["Box Collider"]) {
+            entity.box_collider = scene_format::box_collider_record{
+                .half_extent = read_vec3(collider["Half Extent"], glm::vec3(0.5f)),
+            };
+        }
+
+        if(auto collider = p_node["Sphere Collider"]) {
+            entity.sphere_collider = scene_format::sphere_collider_record{
+                .radius = read_value(collider["Radius"], 0.5f),
+            };
+        }
+
+        if(auto collider = p_node["Capsule Collider"]) {
+            entity.capsule_collider = scene_format::capsule_collider_record{
+                .half_height = read_value(collider["Half Height"], 0.5f),
+                .radius = read_value(collider["Radius"], 0.5f),
+            };
+        }
+
+        return entity;
+    }
+
+    void write_entity(YAML::Emitter& p_out, const scene_entity_desc& p_entity) {
+        p_out << YAML::BeginMap;
+        p_out << YAML::Key << "Entity" << YAML::Value << p_entity.name;
+
+        if(p_entity.transform) {
+            const auto& transform = *p_entity.transform;
+            p_out << YAML::Key << "Transform" << YAML::BeginMap;
+            p_out << YAML::Key << "Position" << YAML::Value << transform.position;
+            p_out << YAML::Key << "Scale" << YAML::Value << transform.scale;
+            p_out << YAML::Key << "Rotation" << YAML::Value << transform.rotation;
+            p_out << YAML::Key << "Quaternion" << YAML::Value << transform.quaternion;
+            p_out << YAML::EndMap;
+        }
+
+        if(p_entity.perspective_camera) {
+            const auto& camera = *p_entity.perspective_camera;
+            p_out << YAML::Key << "PerspectiveCamera" << YAML::BeginMap;
+            p_out << YAML::Key << "Plane" << YAML::Value << camera.plane;
+            p_out << YAML::Key << "Active" << YAML::Value << (camera.is_active != 0);
+            p_out << YAML::Key << "Field of View" << YAML::Value << camera.field_of_view;
+            p_out << YAML::EndMap;
+        }
+
+        if(p_entity.material) {
+            const auto& material = *p_entity.material;
+            p_out << YAML::Key << "Material" << YAML::BeginMap;
+            p_out << YAML::Key << "Color" << YAML::Value << material.color;
+            p_out << YAML::Key << "Model Path" << YAML::Value << material.model_path;
+            p_out << YAML::Key << "Texture Path" << YAML::Value << material.texture_path;
+            p_out << YAML::EndMap;
+        }
+
+        if(p_entity.physics_body) {
+            const auto& body = *p_entity.physics_body;
+            p_out << YAML::Key << "Physics Body" << YAML::BeginMap;
+            p_out << YAML::Key << "Linear Velocity" << YAML::Value << body.linear_velocity;
+            p_out << YAML::Key << "Angular Velocity" << YAML::Value << body.angular_velocity;
+            p_out << YAML::Key << "Cumulative Force" << YAML::Value << body.cumulative_force;
+            p_out << YAML::Key << "Cumulative Torque" << YAML::Value << body.cumulative_torque;
+            p_out << YAML::Key << "Mass Factor" << YAML::Value << body.mass_factor;
+            p_out << YAML::Key << "Center Mass Position" << YAML::Value << body.center_mass_position;
+            p_out << YAML::Key << "Friction" << YAML::Value << body.friction;
+            p_out << YAML::Key << "Restitution" << YAML::Value << body.restitution;
+            p_out << YAML::Key << "Body Movement Type" << YAML::Value << body.body_movement_type;
+            p_out << YAML::Key << "Body Layer Type" << YAML::Value << body.body_layer_type;
+            p_out << YAML::EndMap;
+        }
+
+        if(p_entity.box_collider) {
+            p_out << YAML::Key << "Box Collider" << YAML::BeginMap;
+            p_out << YAML::Key << "Half Extent" << YAML::Value << p_entity.box_collider->half_extent;
+            p_out << YAML::EndMap;
+        }
+
+        if(p_entity.sphere_collider) {
+            p_out << YAML::Key << "Sphere Collider" << YAML::BeginMap;
+            p_out << YAML::Key << "Radius" << YAML::Value << p_entity.sphere_collider->radius;
+            p_out << YAML::EndMap;
+        }
+
+        if(p_entity.capsule_collider) {
+            p_out << YAML::Key << "Capsule Collider" << YAML::BeginMap;
+            p_out << YAML::Key << "Half Height" << YAML::Value << p_entity.capsule_collider->half_height;
+            p_out << YAML::Key << "Radius" << YAML::Value << p_entity.capsule_collider->radius;
+            p_out << YAML::EndMap;
+        }
+
+        p_out << YAML::EndMap;
+    }
+}
+
+bool read_yaml_scene(const std::filesystem::path& p_path, scene_document& p_document) {
+    YAML::Node root;
+    try {
+        root = YAML::LoadFile(p_path.string());
+    }
+    catch(const YAML::Exception& e) {
+        console_log_error("Could not parse scene {}: {}", p_path.string(), e.what());
+        return false;
+    }
+
+    p_document.name = read_value<std::string>(root["Scene"], p_path.stem().string());
+    p_document.entities.clear();
+
+    auto entities = root["Entities"];
+    if(!entities) {
+        return true;
+    }
+
+    p_document.entities.reserve(entities.size());
+    try {
+        for(const auto& node : entities) {
+            p_document.entities.push_back(read_entity(node));
+        }
+    }
+    catch(const YAML::Exception& e) {
+        console_log_error("Malformed entity in scene {}: {}", p_path.string(), e.what());
+        return false;
+    }
+
+    return true;
+}
+
+bool read_yaml_entities(std::string_view p_text, std::vector<scene_entity_desc>& p_entities) {
+    try {
+        YAML::Node root = YAML::Load(std::string(p_text));
+        if(!root or root.IsNull()) {
+            return true;
+        }
+        if(!root.IsSequence()) {
+            console_log_error("Expected a sequence of entities");
+            return false;
+        }
+
+        p_entities.reserve(p_entities.size() + root.size());
+        for(const auto& node : root) {
+            p_entities.push_back(read_entity(node));
+        }
+    }
+    catch(const YAML::Exception& e) {
+        console_log_error("Malformed entity: {}", e.what());
+        return false;
+    }
+
+    return true;
+}
+
+bool write_yaml_scene(const std::filesystem::path& p_path, const scene_document& p_document) {
+    YAML::Emitter out;
+    out << YAML::BeginMap;
+    out << YAML::Key << "Scene" << YAML::Value << p_document.name;
+    out << YAML::Key << "Entities" << YAML::Value << YAML::BeginSeq;
+
+    for(const auto& entity : p_document.entities) {
+        write_entity(out, entity);
+    }
+
+    out << YAML::EndSeq;
+    out << YAML::EndMap;
+
+    std::ofstream file(p_path);
+    if(!file) {
+        console_log_error("Could not open {} for writing", p_path.string());
+        return false;
+    }
+
+    file << out.c_str();
+    return static_cast<bool>(file);
+}
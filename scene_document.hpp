@@ -0,0 +1,50 @@
+#pragma once
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "scene_format.hpp"
+
+/**
+ * @name scene_document
+ * @brief Engine-independent in-memory form of a scene file
+ *
+ * Used as the meeting point between the YAML scene files written by
+ * atlas::serializer and the binary scene format. Components reuse the
+ * on-disk records from scene_format.hpp, only the strings are owned here.
+ */
+struct scene_material_desc {
+    glm::vec4 color{1.f};
+    std::string model_path;
+    std::string texture_path;
+};
+
+struct scene_entity_desc {
+    std::string name;
+    bool serialize=true;
+    std::optional<scene_format::transform_record> transform;
+    std::optional<scene_format::perspective_camera_record> perspective_camera;
+    std::optional<scene_material_desc> material;
+    std::optional<scene_format::physics_body_record> physics_body;
+    std::optional<scene_format::box_collider_record> box_collider;
+    std::optional<scene_format::sphere_collider_record> sphere_collider;
+    std::optional<scene_format::capsule_collider_record> capsule_collider;
+};
+
+struct scene_document {
+    std::string name;
+    std::vector<scene_entity_desc> entities;
+};
+
+//! @brief Parses a YAML scene (same layout atlas::serializer writes)
+bool read_yaml_scene(const std::filesystem::path& p_path, scene_document& p_document);
+
+/**
+ * @brief Parses a fragment of a scene's Entities list, e.g. a few
+ * "  - Entity: ..." blocks cut out of the file, appending to p_entities
+ */
+bool read_yaml_entities(std::string_view p_text, std::vector<scene_entity_desc>& p_entities);
+
+//! @brief Writes a scene back out as YAML that atlas::serializer can load
+bool write_yaml_scene(const std::filesystem::path& p_path, const scene_document& p_document);
@@ -0,0 +1,141 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+#include <glm/glm.hpp>
+
+/**
+ * @brief On-disk layout of the binary scene format (.bin next to the YAML scene)
+ *
+ * A file is laid out as:
+ *
+ *  [file_header]
+ *  [entity_entry x entity_count]
+ *  [section_entry x section_count]
+ *  [component blobs, one per section, 16-byte aligned]
+ *  [string table]
+ *
+ * Each component blob stores `count` entity indices followed by `count`
+ * records of that component. Records are plain floats/integers so they can be
+ * read straight out of the mapped file without any parsing.
+ *
+ * Strings (entity names, asset paths) live in the string table and are
+ * referenced by byte offset. Every string is null-terminated so it can be
+ * handed to flecs without copying.
+ */
+namespace scene_format {
+    static_assert(std::endian::native == std::endian::little, "binary scenes are stored little-endian");
+
+    //! "ATSC"
+    constexpr uint32_t magic = 0x43535441;
+    //! Bump the major version whenever a record layout changes
+    constexpr uint16_t version_major = 1;
+    constexpr uint16_t version_minor = 0;
+
+    constexpr uint32_t no_string = UINT32_MAX;
+    constexpr uint64_t blob_alignment = 16;
+
+    enum class component_id : uint32_t {
+        transform = 1,
+        perspective_camera,
+        material,
+        physics_body,
+        box_collider,
+        sphere_collider,
+        capsule_collider,
+    };
+
+    struct file_header {
+        uint32_t magic=0;
+        uint16_t version_major=0;
+        uint16_t version_minor=0;
+        uint32_t entity_count=0;
+        uint32_t section_count=0;
+        uint32_t scene_name=0;
+        uint32_t reserved=0;
+        uint64_t entity_table_offset=0;
+        uint64_t section_table_offset=0;
+        uint64_t string_table_offset=0;
+        uint64_t string_table_size=0;
+    };
+
+    struct entity_entry {
+        uint32_t name=0;
+        uint32_t flags=0;
+    };
+
+    //! entity_entry::flags
+    constexpr uint32_t entity_serialize = 1 << 0;
+
+    struct section_entry {
+        component_id id{};
+        uint32_t stride=0;
+        uint32_t count=0;
+        uint32_t reserved=0;
+        //! offset of the entity index array, records follow at record_offset
+        uint64_t index_offset=0;
+        uint64_t record_offset=0;
+    };
+
+    struct transform_record {
+        glm::vec3 position;
+        glm::vec3 rotation;
+        glm::vec3 scale;
+        glm::vec4 quaternion;
+    };
+
+    struct perspective_camera_record {
+        glm::vec2 plane;
+        float field_of_view;
+        uint32_t is_active;
+    };
+
+    struct material_record {
+        glm::vec4 color;
+        uint32_t model_path;
+        uint32_t texture_path;
+    };
+
+    struct physics_body_record {
+        glm::vec3 linear_velocity;
+        glm::vec3 angular_velocity;
+        glm::vec3 cumulative_force;
+        glm::vec3 cumulative_torque;
+        glm::vec3 center_mass_position;
+        float mass_factor;
+        float friction;
+        float restitution;
+        uint32_t body_movement_type;
+        uint32_t body_layer_type;
+    };
+
+    struct box_collider_record {
+        glm::vec3 half_extent;
+    };
+
+    struct sphere_collider_record {
+        float radius;
+    };
+
+    struct capsule_collider_record {
+        float half_height;
+        float radius;
+    };
+
+    template<typename T>
+    struct record_traits;
+
+    template<> struct record_traits<transform_record> { static constexpr component_id id = component_id::transform; };
+    template<> struct record_traits<perspective_camera_record> { static constexpr component_id id = component_id::perspective_camera; };
+    template<> struct record_traits<material_record> { static constexpr component_id id = component_id::material; };
+    template<> struct record_traits<physics_body_record> { static constexpr component_id id = component_id::physics_body; };
+    template<> struct record_traits<box_collider_record> { static constexpr component_id id = component_id::box_collider; };
+    template<> struct record_traits<sphere_collider_record> { static constexpr component_id id = component_id::sphere_collider; };
+    template<> struct record_traits<capsule_collider_record> { static constexpr component_id id = component_id::capsule_collider; };
+
+    static_assert(std::is_trivially_copyable_v<file_header>);
+    static_assert(std::is_trivially_copyable_v<transform_record>);
+    static_assert(std::is_trivially_copyable_v<physics_body_record>);
+    static_assert(sizeof(transform_record) == 13 * sizeof(float));
+    static_assert(sizeof(physics_body_record) == 20 * sizeof(float));
+}
@@ -0,0 +1,308 @@
+#include "scene_hierarchy.hpp"
+#include "frame_arena.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <cctype>
+#include <imgui.h>
+#include <core/scene/components.hpp>
+
+namespace {
+    template<typename String>
+    String to_lower(std::string_view p_text, String p_lower = {}) {
+        p_lower.assign(p_text);
+        std::transform(p_lower.begin(), p_lower.end(), p_lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return p_lower;
+    }
+}
+
+scene_hierarchy::~scene_hierarchy() {
+    detach();
+}
+
+void scene_hierarchy::attach(flecs::world& p_registry) {
+    detach();
+    m_registry = &p_registry;
+
+    // existing entities are read once here, after that only observers touch the model
+    p_registry.query_builder<const atlas::transform>().build().each(
+      [this](flecs::entity p_entity, const atlas::transform&) { add_node(p_entity); });
+
+    m_observers.push_back(p_registry.observer().with<atlas::transform>().event(flecs::OnAdd).each([this](flecs::entity p_entity) {
+        add_node(p_entity);
+    }));
+
+    m_observers.push_back(p_registry.observer().with<atlas::transform>().event(flecs::OnRemove).each([this](flecs::entity p_entity) {
+        remove_node(p_entity.id());
+    }));
+
+    m_observers.push_back(
+      p_registry.observer().with(flecs::ChildOf, flecs::Wildcard).event(flecs::OnAdd).each([this](flecs::iter& p_it, size_t p_row) {
+          set_parent(p_it.entity(p_row).id(), p_it.pair(0).second().id());
+      }));
+
+    m_observers.push_back(
+      p_registry.observer().with(flecs::ChildOf, flecs::Wildcard).event(flecs::OnRemove).each([this](flecs::iter& p_it, size_t p_row) {
+          // a reparent can report the new ChildOf before removing the old one
+          node* item = find(p_it.entity(p_row).id());
+          if(item != nullptr and item->parent == p_it.pair(0).second().id()) {
+              set_parent(item->entity, 0);
+          }
+      }));
+
+    m_observers.push_back(p_registry.observer().with<flecs::Identifier>(flecs::Name).event(flecs::OnSet).each([this](flecs::entity p_entity) {
+        rename(p_entity);
+    }));
+}
+
+void scene_hierarchy::detach() {
+    for(flecs::observer& observer : m_observers) {
+        observer.destruct();
+    }
+    m_observers.clear();
+    m_registry = nullptr;
+
+    m_nodes.clear();
+    m_lookup.clear();
+    m_rows.clear();
+    m_child_order.clear();
+    m_child_ranges.clear();
+    m_name_index.clear();
+    m_rows_dirty = true;
+    m_name_index_dirty = true;
+}
+
+scene_hierarchy::node* scene_hierarchy::find(flecs::entity_t p_entity) {
+    auto it = m_lookup.find(p_entity);
+    return it != m_lookup.end() ? &m_nodes[it->second] : nullptr;
+}
+
+void scene_hierarchy::add_node(flecs::entity p_entity) {
+    if(m_lookup.contains(p_entity.id())) {
+        return;
+    }
+
+    m_lookup.emplace(p_entity.id(), static_cast<uint32_t>(m_nodes.size()));
+    m_nodes.push_back({
+      .entity = p_entity.id(),
+      .parent = p_entity.parent().id(),
+      .name = interned_names().intern(p_entity.name().c_str()),
+    });
+    m_rows_dirty = true;
+    m_name_index_dirty = true;
+}
+
+void scene_hierarchy::remove_node(flecs::entity_t p_entity) {
+    auto it = m_lookup.find(p_entity);
+    if(it == m_lookup.end()) {
+        return;
+    }
+
+    uint32_t index = it->second;
+    m_lookup.erase(it);
+    if(index != m_nodes.size() - 1) {
+        m_nodes[index] = std::move(m_nodes.back());
+        m_lookup[m_nodes[index].entity] = index;
+    }
+    m_nodes.pop_back();
+    m_rows_dirty = true;
+    m_name_index_dirty = true;
+}
+
+void scene_hierarchy::set_parent(flecs::entity_t p_entity, flecs::entity_t p_parent) {
+    node* item = find(p_entity);
+    if(item == nullptr or item->parent == p_parent) {
+        return;
+    }
+    item->parent = p_parent;
+    m_rows_dirty = true;
+}
+
+void scene_hierarchy::rename(flecs::entity p_entity) {
+    node* item = find(p_entity.id());
+    if(item == nullptr) {
+        return;
+    }
+
+    name_id name = interned_names().intern(p_entity.name().c_str());
+    if(item->name == name) {
+        return;
+    }
+    item->name = name;
+    m_name_index_dirty = true;
+    m_rows_dirty = m_rows_dirty or m_filter[0] != '\0';
+}
+
+void scene_hierarchy::rebuild_name_index() {
+    m_name_index.clear();
+    m_name_index.reserve(m_nodes.size());
+    for(const node& item : m_nodes) {
+        m_name_index.emplace_back(to_lower<std::string>(interned_names().view(item.name)), item.entity);
+    }
+    std::sort(m_name_index.begin(), m_name_index.end());
+    m_name_index_dirty = false;
+}
+
+void scene_hierarchy::push_rows(uint32_t p_node, uint32_t p_depth, const std::pmr::unordered_set<flecs::entity_t>* p_filtered) {
+    const node& item = m_nodes[p_node];
+    auto range = m_child_ranges.find(item.entity);
+    bool has_children = range != m_child_ranges.end();
+    m_rows.push_back({ p_node, p_depth, has_children });
+
+    bool descend = p_filtered != nullptr or item.expanded;
+    if(!has_children or !descend) {
+        return;
+    }
+
+    for(uint32_t i = range->second.first; i < range->second.second; i++) {
+        uint32_t child = m_child_order[i];
+        if(p_filtered == nullptr or p_filtered->contains(m_nodes[child].entity)) {
+            push_rows(child, p_depth + 1, p_filtered);
+        }
+    }
+}
+
+void scene_hierarchy::rebuild_rows() {
+    PROFILE_ZONE("scene_hierarchy::rebuild_rows");
+    m_rows.clear();
+    m_rows_dirty = false;
+
+    // group nodes by parent, parents outside the model make their children roots
+    m_child_order.resize(m_nodes.size());
+    for(uint32_t i = 0; i < m_nodes.size(); i++) {
+        m_child_order[i] = i;
+    }
+    auto parent_of = [this](uint32_t p_index) {
+        flecs::entity_t parent = m_nodes[p_index].parent;
+        return m_lookup.contains(parent) ? parent : flecs::entity_t(0);
+    };
+    std::stable_sort(m_child_order.begin(), m_child_order.end(),
+                     [&](uint32_t p_a, uint32_t p_b) { return parent_of(p_a) < parent_of(p_b); });
+
+    m_child_ranges.clear();
+    for(uint32_t begin = 0; begin < m_child_order.size();) {
+        flecs::entity_t parent = parent_of(m_child_order[begin]);
+        uint32_t end = begin;
+        while(end < m_child_order.size() and parent_of(m_child_order[end]) == parent) {
+            end++;
+        }
+        m_child_ranges.emplace(parent, std::make_pair(begin, end));
+        begin = end;
+    }
+
+    auto roots = m_child_ranges.find(0);
+    if(roots == m_child_ranges.end()) {
+        return;
+    }
+
+    if(m_filter[0] == '\0') {
+        for(uint32_t i = roots->second.first; i < roots->second.second; i++) {
+            push_rows(m_child_order[i], 0, nullptr);
+        }
+        return;
+    }
+
+    if(m_name_index_dirty) {
+        rebuild_name_index();
+    }
+
+    // both only live for this rebuild, so they come from the frame arena instead of the heap
+    frame_string prefix = to_lower(m_filter.data(), frame_string(&frame_memory()));
+    std::pmr::unordered_set<flecs::entity_t> visible(&frame_memory());
+
+    // matches and every ancestor of a match stay visible so the match keeps its context
+    std::string_view prefix_view = prefix;
+    auto match = std::lower_bound(m_name_index.begin(), m_name_index.end(), prefix_view,
+                                  [](const std::pair<std::string, flecs::entity_t>& p_entry, std::string_view p_prefix) { return p_entry.first < p_prefix; });
+    for(; match != m_name_index.end() and match->first.starts_with(prefix_view); ++match) {
+        for(flecs::entity_t entity = match->second; entity != 0 and visible.insert(entity).second;) {
+            node* item = find(entity);
+            entity = item != nullptr and m_lookup.contains(item->parent) ? item->parent : 0;
+        }
+    }
+
+    for(uint32_t i = roots->second.first; i < roots->second.second; i++) {
+        if(visible.contains(m_nodes[m_child_order[i]].entity)) {
+            push_rows(m_child_order[i], 0, &visible);
+        }
+    }
+}
+
+void scene_hierarchy::update_rows() {
+    if(m_rows_dirty) {
+        rebuild_rows();
+    }
+}
+
+void scene_hierarchy::render(flecs::entity& p_selected_entity) {
+    PROFILE_ZONE("scene_hierarchy::render");
+    if(m_registry == nullptr) {
+        return;
+    }
+
+    ImGui::SetNextItemWidth(-1.f);
+    if(ImGui::InputTextWithHint("##hierarchy_filter", "Filter by name", m_filter.data(), m_filter.size())) {
+        m_rows_dirty = true;
+    }
+
+    update_rows();
+
+    bool filtering = m_filter[0] != '\0';
+    flecs::entity_t delete_request = 0;
+    float indent_spacing = ImGui::GetStyle().IndentSpacing;
+
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(m_rows.size()));
+    while(clipper.Step()) {
+        for(int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+            const row& current = m_rows[i];
+            node& item = m_nodes[current.node];
+
+            ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+            if(!current.has_children) {
+                flags |= ImGuiTreeNodeFlags_Leaf;
+            }
+            if(p_selected_entity.id() == item.entity) {
+                flags |= ImGuiTreeNodeFlags_Selected;
+            }
+
+            // rows are flat, depth is shown through indentation instead of nested tree pushes
+            float indent = static_cast<float>(current.depth) * indent_spacing;
+            if(indent > 0.f) {
+                ImGui::Indent(indent);
+            }
+            ImGui::PushID(reinterpret_cast<const void*>(static_cast<uintptr_t>(item.entity)));
+
+            ImGui::SetNextItemOpen(filtering or item.expanded);
+            // interned names are backed by std::string, so the view is null terminated
+            std::string_view name = interned_names().view(item.name);
+            bool opened = ImGui::TreeNodeEx(name.empty() ? "<unnamed>" : name.data(), flags);
+            if(!filtering and current.has_children and opened != item.expanded) {
+                item.expanded = opened;
+                m_rows_dirty = true;
+            }
+
+            if(ImGui::IsItemClicked() and !ImGui::IsItemToggledOpen()) {
+                p_selected_entity = m_registry->entity(item.entity);
+            }
+
+            if(ImGui::BeginPopupContextItem()) {
+                if(ImGui::MenuItem("Delete Entity")) {
+                    delete_request = item.entity;
+                }
+                ImGui::EndPopup();
+            }
+
+            ImGui::PopID();
+            if(indent > 0.f) {
+                ImGui::Unindent(indent);
+            }
+        }
+    }
+
+    if(delete_request != 0) {
+        if(p_selected_entity.id() == delete_request) {
+            p_selected_entity = flecs::entity::null();
+        }
+        m_registry->entity(delete_request).destruct();
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <flecs.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "names.hpp"
+
+/**
+ * @name scene_hierarchy
+ * @brief Scene hierarchy model kept up to date by flecs observers
+ *
+ * Holds a node per entity with an atlas::transform, its name and its
+ * children. Observers on transform, ChildOf and the entity name keep the
+ * model in sync, so nothing is queried while drawing. The rows currently
+ * shown (expanded nodes or filter matches plus their ancestors) are
+ * flattened into a list only when the model, the expanded state or the
+ * filter changes, and drawn through ImGuiListClipper so a frame only pays
+ * for the rows on screen.
+ *
+ * Names are kept as interned ids, a rename that does not change the name
+ * costs an integer compare. The name filter is a case-insensitive prefix
+ * match served by a sorted index of lowercase names.
+ *
+ * The observers capture this, so the object must not move while attached.
+ */
+class scene_hierarchy {
+public:
+    scene_hierarchy() = default;
+    ~scene_hierarchy();
+
+    scene_hierarchy(const scene_hierarchy&) = delete;
+    scene_hierarchy& operator=(const scene_hierarchy&) = delete;
+
+    void attach(flecs::world& p_registry);
+
+    //! @brief Removes the observers and drops the model, call while the world is alive
+    void detach();
+
+    //! @brief Draws the filter box and the visible rows into the current window
+    void render(flecs::entity& p_selected_entity);
+
+    //! @brief Rebuilds the visible rows if the model changed since the last call, render() does this before drawing
+    void update_rows();
+
+    [[nodiscard]] size_t node_count() const { return m_nodes.size(); }
+
+    [[nodiscard]] size_t row_count() const { return m_rows.size(); }
+
+private:
+    struct node {
+        flecs::entity_t entity;
+        flecs::entity_t parent;
+        name_id name;
+        bool expanded=false;
+    };
+
+    struct row {
+        uint32_t node;
+        uint32_t depth;
+        bool has_children;
+    };
+
+    void add_node(flecs::entity p_entity);
+
+    void remove_node(flecs::entity_t p_entity);
+
+    void set_parent(flecs::entity_t p_entity, flecs::entity_t p_parent);
+
+    void rename(flecs::entity p_entity);
+
+    node* find(flecs::entity_t p_entity);
+
+    void rebuild_rows();
+
+    void rebuild_name_index();
+
+    //! appends p_node and, when it is expanded or p_filtered is set, its children in p_filtered
+    void push_rows(uint32_t p_node, uint32_t p_depth, const std::pmr::unordered_set<flecs::entity_t>* p_filtered);
+
+private:
+    flecs::world* m_registry=nullptr;
+    std::vector<flecs::observer> m_observers;
+
+    std::vector<node> m_nodes;
+    std::unordered_map<flecs::entity_t, uint32_t> m_lookup;
+
+    std::vector<row> m_rows;
+    bool m_rows_dirty=true;
+    // children of each parent as ranges into m_child_order, rebuilt with the rows
+    std::vector<uint32_t> m_child_order;
+    std::unordered_map<flecs::entity_t, std::pair<uint32_t, uint32_t>> m_child_ranges;
+
+    //! (lowercase name, entity) sorted by name
+    std::vector<std::pair<std::string, flecs::entity_t>> m_name_index;
+    bool m_name_index_dirty=true;
+    std::array<char, 128> m_filter{};
+};
@@ -0,0 +1,195 @@
+#include "scene_loader.hpp"
+#include "binary_scene.hpp"
+#include <core/engine_logger.hpp>
+#include <core/scene/components.hpp>
+#include <chrono>
+#include <optional>
+#include <unordered_set>
+
+namespace {
+    template<typename Record>
+    void set_if_present(flecs::entity p_entity, const std::optional<Record>& p_record) {
+        if(p_record) {
+            set_scene_component(p_entity, *p_record);
+        }
+    }
+
+    template<typename T>
+    bool is_finished(const std::future<T>& p_future) {
+        return p_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+}
+
+scene_loader::scene_loader(thread_pool& p_pool, mesh_cache& p_meshes, texture_cache& p_textures)
+  : m_pool(&p_pool), m_meshes(&p_meshes), m_textures(&p_textures) {}
+
+scene_loader::~scene_loader() {
+    if(m_parse.valid()) {
+        m_parse.wait();
+    }
+    for(auto& load : m_model_loads) {
+        if(load.valid()) {
+            load.wait();
+        }
+    }
+}
+
+void scene_loader::start(const std::filesystem::path& p_source, const std::filesystem::path& p_binary) {
+    if(busy()) {
+        console_log_warn("Already loading {}, ignoring {}", m_source.string(), p_source.string());
+        return;
+    }
+
+    m_source = p_source;
+    m_stage = scene_load_stage::parsing;
+    m_parse = m_pool->submit([p_source, p_binary]() -> std::unique_ptr<scene_document> {
+        auto document = std::make_unique<scene_document>();
+        if(bake_binary_scene(p_source, p_binary)) {
+            binary_scene scene(p_binary);
+            if(scene.is_valid()) {
+                *document = scene.to_document();
+                return document;
+            }
+        }
+
+        console_log_warn("Binary {} unavailable, falling back to YAML", p_source.string());
+        if(!read_yaml_scene(p_source, *document)) {
+            return nullptr;
+        }
+        return document;
+    });
+}
+
+void scene_loader::begin_resolving() {
+    m_stage = scene_load_stage::resolving;
+
+    std::unordered_set<std::string> models;
+    for(const scene_entity_desc& entity : m_document->entities) {
+        if(!entity.material) {
+            continue;
+        }
+
+        const scene_material_desc& material = *entity.material;
+        if(m_resolve_meshes and !material.model_path.empty() and models.insert(material.model_path).second) {
+            m_model_paths.push_back(material.model_path);
+        }
+        // texture_cache decodes on the pool by itself, asking now overlaps it with the model loads
+        if(m_resolve_textures and !material.texture_path.empty() and !m_texture_handles.contains(material.texture_path)) {
+            m_texture_handles.emplace(material.texture_path, m_textures->get(material.texture_path));
+        }
+    }
+
+    // one task per model, each loads or imports inline instead of waiting on another task
+    m_model_loads.reserve(m_model_paths.size());
+    for(const std::string& path : m_model_paths) {
+        m_model_loads.push_back(m_pool->submit([meshes = m_meshes, path]() { return meshes->get(path); }));
+    }
+}
+
+scene_load_stage scene_loader::update() {
+    if(m_stage == scene_load_stage::parsing) {
+        if(!is_finished(m_parse)) {
+            return m_stage;
+        }
+
+        m_document = m_parse.get();
+        if(!m_document) {
+            console_log_error("Cannot load {}", m_source.string());
+            m_stage = scene_load_stage::failed;
+            return m_stage;
+        }
+        begin_resolving();
+    }
+
+    if(m_stage == scene_load_stage::resolving) {
+        for(size_t i = 0; i < m_model_loads.size(); i++) {
+            if(m_model_loads[i].valid() and is_finished(m_model_loads[i])) {
+                m_models.emplace(m_model_paths[i], m_model_loads[i].get());
+            }
+        }
+
+        if(m_models.size() == m_model_paths.size()) {
+            m_model_loads.clear();
+            m_stage = scene_load_stage::ready;
+        }
+    }
+
+    return m_stage;
+}
+
+scene_load_stage scene_loader::wait() {
+    if(m_stage == scene_load_stage::parsing) {
+        m_parse.wait();
+    }
+    update();
+
+    for(auto& load : m_model_loads) {
+        if(load.valid()) {
+            load.wait();
+        }
+    }
+    return update();
+}
+
+float scene_loader::progress() const {
+    switch(m_stage) {
+        case scene_load_stage::parsing:
+            return 0.f;
+        case scene_load_stage::resolving:
+            if(m_model_paths.empty()) {
+                return 0.5f;
+            }
+            return 0.5f + 0.5f * static_cast<float>(m_models.size()) / static_cast<float>(m_model_paths.size());
+        case scene_load_stage::ready:
+            return 1.f;
+        default:
+            return 0.f;
+    }
+}
+
+std::vector<flecs::entity> scene_loader::commit(flecs::world& p_registry) {
+    std::vector<flecs::entity> entities;
+    if(m_stage != scene_load_stage::ready) {
+        return entities;
+    }
+
+    // handles are created before deferring, same as binary_scene::apply
+    entities.reserve(m_document->entities.size());
+    for(const scene_entity_desc& entity : m_document->entities) {
+        entities.push_back(p_registry.entity(entity.name.c_str()));
+    }
+
+    p_registry.defer_begin();
+    for(size_t i = 0; i < entities.size(); i++) {
+        const scene_entity_desc& desc = m_document->entities[i];
+        flecs::entity entity = entities[i];
+
+        if(desc.serialize) {
+            entity.add<atlas::tag::serialize>();
+        }
+        set_if_present(entity, desc.transform);
+        set_if_present(entity, desc.perspective_camera);
+        set_if_present(entity, desc.physics_body);
+        set_if_present(entity, desc.box_collider);
+        set_if_present(entity, desc.sphere_collider);
+        set_if_present(entity, desc.capsule_collider);
+
+        if(desc.material) {
+            set_scene_component(entity, *desc.material);
+            if(auto it = m_models.find(desc.material->model_path); it != m_models.end() and it->second) {
+                entity.set<cached_mesh>({ it->second });
+            }
+            if(auto it = m_texture_handles.find(desc.material->texture_path); it != m_texture_handles.end()) {
+                entity.set<cached_texture>({ it->second });
+            }
+        }
+    }
+    p_registry.defer_end();
+
+    m_document.reset();
+    m_model_paths.clear();
+    m_models.clear();
+    m_texture_handles.clear();
+    m_stage = scene_load_stage::idle;
+    return entities;
+}
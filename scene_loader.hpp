@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <flecs.h>
+#include "scene_document.hpp"
+#include "thread_pool.hpp"
+#include "mesh_cache.hpp"
+#include "texture_cache.hpp"
+
+enum class scene_load_stage { idle, parsing, resolving, ready, failed };
+
+/**
+ * @name scene_loader
+ * @brief Loads a scene on the thread pool and commits it to the world in one step
+ *
+ * start() parses the scene on a worker (through the binary scene cache when
+ * it is up to date), then every distinct model is loaded or imported in its
+ * own task. Nothing touches the world until commit(), which creates the
+ * entities and sets every component, cached_mesh and cached_texture
+ * included, in a single deferred block on the calling thread.
+ *
+ * update() only checks finished tasks and never blocks, so the main thread
+ * keeps rendering frames while a large level loads. Textures are not waited
+ * for, commit() hands out texture_cache handles that finish decoding on
+ * their own.
+ */
+class scene_loader {
+public:
+    scene_loader(thread_pool& p_pool, mesh_cache& p_meshes, texture_cache& p_textures);
+
+    //! @brief Waits for tasks still in flight, they reference the caches
+    ~scene_loader();
+
+    scene_loader(const scene_loader&) = delete;
+    scene_loader& operator=(const scene_loader&) = delete;
+
+    /**
+     * @brief Starts loading p_source in the background
+     *
+     * p_binary is (re)baked from p_source when it is missing or older, the
+     * same way bake_binary_scene does for a synchronous load.
+     */
+    void start(const std::filesystem::path& p_source, const std::filesystem::path& p_binary);
+
+    //! @brief Moves the load on as far as finished tasks allow, call once per frame
+    scene_load_stage update();
+
+    //! @brief Blocks until the load is ready or failed
+    scene_load_stage wait();
+
+    /**
+     * @brief Whether start() loads every model into mesh_cache and commit()
+     * sets cached_mesh, on by default
+     *
+     * Only code that reads cached_mesh needs it; the renderer parses the
+     * .obj files itself.
+     */
+    void resolve_meshes(bool p_enabled) { m_resolve_meshes = p_enabled; }
+
+    //! @brief Whether start() asks texture_cache for every texture and commit() sets cached_texture, on by default
+    void resolve_textures(bool p_enabled) { m_resolve_textures = p_enabled; }
+
+    [[nodiscard]] scene_load_stage stage() const { return m_stage; }
+
+    //! @brief true from start() until the staged scene is committed or the load failed
+    [[nodiscard]] bool busy() const { return m_stage == scene_load_stage::parsing or m_stage == scene_load_stage::resolving or m_stage == scene_load_stage::ready; }
+
+    //! @brief 0 to 1, parsing counts as the first half and model loads as the second
+    [[nodiscard]] float progress() const;
+
+    [[nodiscard]] const std::filesystem::path& source() const { return m_source; }
+
+    /**
+     * @brief Writes the staged scene into p_registry and releases the staging
+     *
+     * @return entity handles in the order of the scene file, empty unless
+     * stage() is ready
+     */
+    std::vector<flecs::entity> commit(flecs::world& p_registry);
+
+private:
+    void begin_resolving();
+
+private:
+    thread_pool* m_pool=nullptr;
+    mesh_cache* m_meshes=nullptr;
+    texture_cache* m_textures=nullptr;
+    bool m_resolve_meshes=true;
+    bool m_resolve_textures=true;
+
+    scene_load_stage m_stage=scene_load_stage::idle;
+    std::filesystem::path m_source;
+    std::future<std::unique_ptr<scene_document>> m_parse;
+
+    // staging, owned until commit()
+    std::unique_ptr<scene_document> m_document;
+    std::vector<std::string> m_model_paths;
+    std::vector<std::future<std::shared_ptr<const mesh_data>>> m_model_loads;
+    std::unordered_map<std::string, std::shared_ptr<const mesh_data>> m_models;
+    std::unordered_map<std::string, std::shared_ptr<streamed_texture>> m_texture_handles;
+};
@@ -0,0 +1,296 @@
+#include "scene_reload.hpp"
+#include "binary_scene.hpp"
+#include "mapped_file.hpp"
+#include "scene_document.hpp"
+#include <core/engine_logger.hpp>
+#include <core/scene/components.hpp>
+#include <physics/components.hpp>
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+    //! start of every entity block atlas::serializer writes
+    constexpr std::string_view entity_marker = "\n  - Entity:";
+    constexpr size_t compare_block = 4096;
+
+    bool read_text(const std::filesystem::path& p_path, std::string& p_text) {
+        mapped_file file(p_path);
+        if(!file.is_open()) {
+            return false;
+        }
+        p_text.assign(reinterpret_cast<const char*>(file.data()), file.size());
+        return true;
+    }
+
+    size_t common_prefix(std::string_view p_a, std::string_view p_b) {
+        size_t limit = std::min(p_a.size(), p_b.size());
+        size_t length = 0;
+        // whole blocks through memcmp first, the byte loop only walks the block that differs
+        while(length + compare_block <= limit and std::memcmp(p_a.data() + length, p_b.data() + length, compare_block) == 0) {
+            length += compare_block;
+        }
+        while(length < limit and p_a[length] == p_b[length]) {
+            length++;
+        }
+        return length;
+    }
+
+    size_t common_suffix(std::string_view p_a, std::string_view p_b, size_t p_limit) {
+        size_t length = 0;
+        while(length + compare_block <= p_limit and
+              std::memcmp(p_a.data() + p_a.size() - length - compare_block, p_b.data() + p_b.size() - length - compare_block, compare_block) == 0) {
+            length += compare_block;
+        }
+        while(length < p_limit and p_a[p_a.size() - 1 - length] == p_b[p_b.size() - 1 - length]) {
+            length++;
+        }
+        return length;
+    }
+
+    struct entity_block {
+        //! the "  - Entity: name" line
+        std::string_view key;
+        std::string_view text;
+    };
+
+    //! cuts [p_begin, p_end) into entity blocks, both ends must sit on a block boundary (or the ends of the text)
+    void split_entities(std::string_view p_text, size_t p_begin, size_t p_end, std::vector<entity_block>& p_blocks) {
+        size_t marker = p_text.find(entity_marker, p_begin == 0 ? 0 : p_begin - 1);
+        while(marker != std::string_view::npos and marker + 1 < p_end) {
+            size_t start = marker + 1;
+            size_t next = p_text.find(entity_marker, start);
+            size_t stop = std::min(next == std::string_view::npos ? p_text.size() : next + 1, p_end);
+            size_t line_end = std::min(p_text.find('\n', start), stop);
+            p_blocks.push_back({ p_text.substr(start, line_end - start), p_text.substr(start, stop - start) });
+            marker = next;
+        }
+    }
+
+    void append_block(std::string& p_out, std::string_view p_block) {
+        p_out += p_block;
+        if(!p_block.empty() and p_block.back() != '\n') {
+            p_out += '\n';
+        }
+    }
+
+    template<typename Record>
+    bool same(const std::optional<Record>& p_a, const std::optional<Record>& p_b) {
+        if(p_a.has_value() != p_b.has_value()) {
+            return false;
+        }
+        // records are plain floats and integers, no padding to compare
+        return !p_a or std::memcmp(&*p_a, &*p_b, sizeof(Record)) == 0;
+    }
+
+    bool same(const std::optional<scene_material_desc>& p_a, const std::optional<scene_material_desc>& p_b) {
+        if(p_a.has_value() != p_b.has_value()) {
+            return false;
+        }
+        return !p_a or (p_a->color == p_b->color and p_a->model_path == p_b->model_path and p_a->texture_path == p_b->texture_path);
+    }
+
+    template<typename Component, typename Record>
+    uint32_t patch_component(flecs::entity p_entity, const std::optional<Record>& p_old, const std::optional<Record>& p_new) {
+        if(same(p_old, p_new)) {
+            return 0;
+        }
+
+        if(p_new) {
+            set_scene_component(p_entity, *p_new);
+        }
+        else {
+            p_entity.remove<Component>();
+        }
+        return 1;
+    }
+
+    uint32_t patch_entity(flecs::entity p_entity, const scene_entity_desc& p_old, const scene_entity_desc& p_new, scene_patch& p_patch) {
+        uint32_t patched = 0;
+        if(p_old.serialize != p_new.serialize) {
+            if(p_new.serialize) {
+                p_entity.add<atlas::tag::serialize>();
+            }
+            else {
+                p_entity.remove<atlas::tag::serialize>();
+            }
+        }
+
+        patched += patch_component<atlas::transform>(p_entity, p_old.transform, p_new.transform);
+        patched += patch_component<atlas::perspective_camera>(p_entity, p_old.perspective_camera, p_new.perspective_camera);
+        patched += patch_component<atlas::physics_body>(p_entity, p_old.physics_body, p_new.physics_body);
+        patched += patch_component<atlas::box_collider>(p_entity, p_old.box_collider, p_new.box_collider);
+        patched += patch_component<atlas::sphere_collider>(p_entity, p_old.sphere_collider, p_new.sphere_collider);
+        patched += patch_component<atlas::capsule_collider>(p_entity, p_old.capsule_collider, p_new.capsule_collider);
+
+        uint32_t material = patch_component<atlas::material>(p_entity, p_old.material, p_new.material);
+        if(material != 0) {
+            p_patch.materials.push_back(p_entity);
+        }
+        return patched + material;
+    }
+}
+
+bool scene_reloader::track(const std::filesystem::path& p_path) {
+    m_path = p_path;
+    m_text.clear();
+    if(!read_text(p_path, m_text)) {
+        console_log_error("Could not read scene {}", p_path.string());
+        return false;
+    }
+    return true;
+}
+
+bool scene_reloader::reload(flecs::world& p_registry, scene_patch& p_patch) {
+    p_patch = {};
+
+    // compared straight out of the mapping, only the changed range is copied into m_text afterwards
+    mapped_file file(m_path);
+    if(!file.is_open()) {
+        console_log_error("Could not read scene {}", m_path.string());
+        return false;
+    }
+
+    std::string_view before = m_text;
+    std::string_view after(reinterpret_cast<const char*>(file.data()), file.size());
+    size_t prefix = common_prefix(before, after);
+    if(prefix == before.size() and prefix == after.size()) {
+        return true;
+    }
+    size_t suffix = common_suffix(before, after, std::min(before.size(), after.size()) - prefix);
+
+    // Widen the edit to whole entity blocks. A boundary only counts when its
+    // marker lies entirely in the unchanged prefix or suffix, then it is at
+    // the same place relative to either end of both versions.
+    size_t begin = 0;
+    if(prefix >= entity_marker.size()) {
+        size_t marker = before.rfind(entity_marker, prefix - entity_marker.size());
+        begin = marker == std::string_view::npos ? 0 : marker + 1;
+    }
+
+    size_t before_end = before.size();
+    size_t after_end = after.size();
+    size_t marker = before.find(entity_marker, before.size() - suffix);
+    if(marker != std::string_view::npos) {
+        before_end = marker + 1;
+        after_end = marker + 1 + after.size() - before.size();
+    }
+
+    std::vector<entity_block> old_blocks;
+    std::vector<entity_block> new_blocks;
+    split_entities(before, begin, before_end, old_blocks);
+    split_entities(after, begin, after_end, new_blocks);
+
+    if(old_blocks.empty() and new_blocks.empty() and
+       (before.find(entity_marker) == std::string_view::npos or after.find(entity_marker) == std::string_view::npos)) {
+        console_log_warn("{} is not laid out the way atlas::serializer writes it, reload the level to pick up the change", m_path.string());
+        return false;
+    }
+
+    // Only blocks whose text changed get parsed. Both lists are walked in
+    // step from either end first, which covers edits far apart without
+    // hashing every block in between, whatever is left (renames, reordered
+    // blocks) is matched by key.
+    std::string old_source;
+    std::string new_source;
+    auto take_pair = [&](const entity_block& p_old, const entity_block& p_new) {
+        if(p_old.text != p_new.text) {
+            append_block(old_source, p_old.text);
+            append_block(new_source, p_new.text);
+        }
+    };
+
+    size_t old_first = 0;
+    size_t new_first = 0;
+    while(old_first < old_blocks.size() and new_first < new_blocks.size() and old_blocks[old_first].key == new_blocks[new_first].key) {
+        take_pair(old_blocks[old_first++], new_blocks[new_first++]);
+    }
+
+    size_t old_last = old_blocks.size();
+    size_t new_last = new_blocks.size();
+    while(old_last > old_first and new_last > new_first and old_blocks[old_last - 1].key == new_blocks[new_last - 1].key) {
+        take_pair(old_blocks[--old_last], new_blocks[--new_last]);
+    }
+
+    std::unordered_map<std::string_view, std::string_view> unmatched;
+    for(size_t i = old_first; i < old_last; i++) {
+        unmatched.emplace(old_blocks[i].key, old_blocks[i].text);
+    }
+    for(size_t i = new_first; i < new_last; i++) {
+        auto it = unmatched.find(new_blocks[i].key);
+        if(it != unmatched.end() and it->second == new_blocks[i].text) {
+            unmatched.erase(it);
+            continue;
+        }
+        append_block(new_source, new_blocks[i].text);
+    }
+    for(size_t i = old_first; i < old_last; i++) {
+        if(unmatched.contains(old_blocks[i].key)) {
+            append_block(old_source, old_blocks[i].text);
+        }
+    }
+
+    std::vector<scene_entity_desc> old_entities;
+    std::vector<scene_entity_desc> new_entities;
+    if(!read_yaml_entities(old_source, old_entities) or !read_yaml_entities(new_source, new_entities)) {
+        console_log_error("Could not parse the edited entities of {}", m_path.string());
+        return false;
+    }
+
+    std::unordered_map<std::string_view, const scene_entity_desc*> previous;
+    for(const scene_entity_desc& entity : old_entities) {
+        previous.emplace(entity.name, &entity);
+    }
+
+    // handles are resolved before deferring, the same way binary_scene::apply does
+    scene_entity_desc none;
+    none.serialize = false;
+    std::vector<std::pair<flecs::entity, const scene_entity_desc*>> targets;
+    targets.reserve(new_entities.size());
+    std::unordered_set<std::string_view> kept;
+    for(const scene_entity_desc& entity : new_entities) {
+        kept.insert(entity.name);
+        flecs::entity existing = p_registry.lookup(entity.name.c_str());
+        auto it = previous.find(entity.name);
+        if(existing and it != previous.end()) {
+            targets.emplace_back(existing, it->second);
+        }
+        else {
+            // new in the file, or deleted from the world since it was loaded
+            targets.emplace_back(p_registry.entity(entity.name.c_str()), &none);
+        }
+    }
+
+    std::vector<flecs::entity> removed;
+    for(const scene_entity_desc& entity : old_entities) {
+        if(!kept.contains(entity.name)) {
+            if(flecs::entity existing = p_registry.lookup(entity.name.c_str())) {
+                removed.push_back(existing);
+            }
+        }
+    }
+
+    p_registry.defer_begin();
+    for(size_t i = 0; i < new_entities.size(); i++) {
+        auto [entity, old] = targets[i];
+        uint32_t patched = patch_entity(entity, *old, new_entities[i], p_patch);
+        if(old == &none) {
+            p_patch.created++;
+        }
+        else if(patched != 0) {
+            p_patch.changed++;
+        }
+        p_patch.components += patched;
+    }
+    for(flecs::entity entity : removed) {
+        entity.destruct();
+        p_patch.destroyed++;
+    }
+    p_registry.defer_end();
+
+    m_text.replace(prefix, before.size() - prefix - suffix, after.substr(prefix, after.size() - prefix - suffix));
+    return true;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <flecs.h>
+
+//! @brief What scene_reloader::reload changed in the world
+struct scene_patch {
+    uint32_t created=0;
+    uint32_t destroyed=0;
+    //! entities that existed before and had at least one component patched
+    uint32_t changed=0;
+    //! components set or removed across created and changed entities
+    uint32_t components=0;
+    //! entities whose material was set or removed, their cached mesh and texture are stale
+    std::vector<flecs::entity> materials;
+
+    [[nodiscard]] bool empty() const { return created == 0 and destroyed == 0 and components == 0; }
+};
+
+/**
+ * @name scene_reloader
+ * @brief Applies edits to a YAML scene file to the world loaded from it
+ *
+ * Keeps the text the world was loaded from. On reload() the new file is
+ * compared against it byte for byte, the changed range is widened to whole
+ * "  - Entity:" blocks and only those blocks are parsed, from both
+ * versions. Entities are matched by name: new names are created, missing
+ * ones destroyed, and of the rest only components whose values differ
+ * between the two versions are set or removed, inside one deferred batch.
+ * Entities outside the edit are never touched, so a running simulation
+ * keeps their current state.
+ *
+ * Relies on the block layout atlas::serializer writes (entities as a
+ * sequence indented by two spaces). The "Scene" name is not reloaded.
+ */
+class scene_reloader {
+public:
+    //! @brief Remembers the current contents of p_path as what the world holds
+    bool track(const std::filesystem::path& p_path);
+
+    [[nodiscard]] const std::filesystem::path& path() const { return m_path; }
+
+    /**
+     * @brief Patches p_registry with whatever changed in the file since the
+     * last track() or successful reload()
+     *
+     * @return false if the file could not be read or the changed entities
+     * could not be parsed, the world is left untouched and the next reload
+     * diffs against the same text again
+     */
+    bool reload(flecs::world& p_registry, scene_patch& p_patch);
+
+private:
+    std::filesystem::path m_path;
+    std::string m_text;
+};
@@ -0,0 +1,136 @@
+#include "scene_snapshot.hpp"
+#include <cstring>
+
+namespace {
+    //! component structs are plain data, so a byte compare is enough to detect
+    //! edits. At worst differing padding causes an unchanged component to be rewritten
+    template<typename T>
+    bool same_bytes(const T& p_lhs, const T& p_rhs) {
+        return std::memcmp(&p_lhs, &p_rhs, sizeof(T)) == 0;
+    }
+
+    bool same_material(const atlas::material& p_lhs, const atlas::material& p_rhs) {
+        return same_bytes(p_lhs.color, p_rhs.color) and p_lhs.model_path == p_rhs.model_path and
+               p_lhs.texture_path == p_rhs.texture_path;
+    }
+
+    template<typename T, typename Compare>
+    uint32_t restore_component(flecs::entity p_entity, bool p_captured, const T& p_saved, Compare&& p_compare) {
+        const T* current = p_entity.get<T>();
+
+        if(!p_captured) {
+            if(current != nullptr) {
+                p_entity.remove<T>();
+                return 1;
+            }
+            return 0;
+        }
+
+        if(current == nullptr or !p_compare(*current, p_saved)) {
+            p_entity.set<T>(p_saved);
+            return 1;
+        }
+        return 0;
+    }
+
+    template<typename T>
+    uint32_t restore_component(flecs::entity p_entity, bool p_captured, const T& p_saved) {
+        return restore_component(p_entity, p_captured, p_saved, same_bytes<T>);
+    }
+
+    template<typename T>
+    bool capture_component(flecs::entity p_entity, T& p_out) {
+        const T* component = p_entity.get<T>();
+        if(component == nullptr) {
+            return false;
+        }
+        p_out = *component;
+        return true;
+    }
+}
+
+void scene_snapshot::capture(flecs::world& p_registry) {
+    clear();
+
+    auto query = p_registry.query_builder().with<atlas::tag::serialize>().build();
+    m_entries.reserve(static_cast<size_t>(query.count()));
+
+    query.each([&](flecs::entity p_entity) {
+        entry captured;
+        captured.entity = p_entity.id();
+
+        if(capture_component(p_entity, captured.transform)) {
+            captured.components |= has_transform;
+        }
+        if(capture_component(p_entity, captured.physics_body)) {
+            captured.components |= has_physics_body;
+        }
+        if(capture_component(p_entity, captured.box_collider)) {
+            captured.components |= has_box_collider;
+        }
+        if(capture_component(p_entity, captured.sphere_collider)) {
+            captured.components |= has_sphere_collider;
+        }
+        if(capture_component(p_entity, captured.capsule_collider)) {
+            captured.components |= has_capsule_collider;
+        }
+        if(const atlas::material* material = p_entity.get<atlas::material>()) {
+            captured.components |= has_material;
+            captured.material_index = static_cast<uint32_t>(m_materials.size());
+            m_materials.push_back(*material);
+        }
+
+        m_lookup.emplace(captured.entity, static_cast<uint32_t>(m_entries.size()));
+        m_entries.push_back(captured);
+    });
+}
+
+uint32_t scene_snapshot::restore_entry(flecs::entity p_entity, const entry& p_entry) const {
+    uint32_t written = 0;
+    written += restore_component(p_entity, p_entry.components & has_transform, p_entry.transform);
+    written += restore_component(p_entity, p_entry.components & has_physics_body, p_entry.physics_body);
+    written += restore_component(p_entity, p_entry.components & has_box_collider, p_entry.box_collider);
+    written += restore_component(p_entity, p_entry.components & has_sphere_collider, p_entry.sphere_collider);
+    written += restore_component(p_entity, p_entry.components & has_capsule_collider, p_entry.capsule_collider);
+
+    if(p_entry.components & has_material) {
+        written += restore_component(p_entity, true, m_materials[p_entry.material_index], same_material);
+    }
+    else {
+        written += restore_component(p_entity, false, atlas::material{}, same_material);
+    }
+    return written;
+}
+
+uint32_t scene_snapshot::restore(flecs::world& p_registry) const {
+    uint32_t written = 0;
+
+    p_registry.defer_begin();
+    for(const entry& saved : m_entries) {
+        flecs::entity entity = p_registry.entity(saved.entity);
+        if(!entity.is_alive()) {
+            continue;
+        }
+        written += restore_entry(entity, saved);
+    }
+    p_registry.defer_end();
+
+    return written;
+}
+
+bool scene_snapshot::restore_transform(flecs::entity p_entity) const {
+    auto it = m_lookup.find(p_entity.id());
+    if(it == m_lookup.end()) {
+        return false;
+    }
+
+    const entry& saved = m_entries[it->second];
+    restore_component(p_entity, saved.components & has_transform, saved.transform);
+    return true;
+}
+
+void scene_snapshot::clear() {
+    m_entries.clear();
+    m_materials.clear();
+    m_lookup.clear();
+}
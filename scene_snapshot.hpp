@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <flecs.h>
+#include <core/scene/components.hpp>
+#include <physics/components.hpp>
+
+/**
+ * @name scene_snapshot
+ * @brief In-memory copy of every atlas::tag::serialize entity's components
+ *
+ * capture() copies transform, physics_body, colliders and material of each
+ * serialized entity into one contiguous array. restore() compares the live
+ * components against that copy and only writes back the ones that differ, so
+ * stopping the simulation never has to go back to disk.
+ */
+class scene_snapshot {
+public:
+    scene_snapshot() = default;
+
+    void capture(flecs::world& p_registry);
+
+    /**
+     * @brief Writes every changed component back to its captured value
+     *
+     * Components that were added after capture() are removed again and
+     * components that were removed are re-added.
+     *
+     * @return number of components that were written or removed
+     */
+    uint32_t restore(flecs::world& p_registry) const;
+
+    //! @brief Puts a single entity's transform back, returns false when it was not captured
+    bool restore_transform(flecs::entity p_entity) const;
+
+    [[nodiscard]] bool empty() const { return m_entries.empty(); }
+
+    [[nodiscard]] size_t size() const { return m_entries.size(); }
+
+    void clear();
+
+private:
+    enum component_bits : uint32_t {
+        has_transform = 1 << 0,
+        has_physics_body = 1 << 1,
+        has_box_collider = 1 << 2,
+        has_sphere_collider = 1 << 3,
+        has_capsule_collider = 1 << 4,
+        has_material = 1 << 5,
+    };
+
+    struct entry {
+        flecs::entity_t entity=0;
+        uint32_t components=0;
+        uint32_t material_index=0;
+        atlas::transform transform;
+        atlas::physics_body physics_body;
+        atlas::box_collider box_collider;
+        atlas::sphere_collider sphere_collider;
+        atlas::capsule_collider capsule_collider;
+    };
+
+    uint32_t restore_entry(flecs::entity p_entity, const entry& p_entry) const;
+
+private:
+    std::vector<entry> m_entries;
+    // materials own strings so they are kept out of the trivially copyable entries
+    std::vector<atlas::material> m_materials;
+    std::unordered_map<flecs::entity_t, uint32_t> m_lookup;
+};
@@ -0,0 +1,353 @@
+#include "sound_bank.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <string>
+#include <core/engine_logger.hpp>
+
+namespace {
+    ma_decoder_config engine_decoder_config(ma_engine& p_engine) {
+        return ma_decoder_config_init(ma_format_f32, ma_engine_get_channels(&p_engine), ma_engine_get_sample_rate(&p_engine));
+    }
+}
+
+const ma_data_source_vtable streamed_sound::s_vtable = {
+    streamed_sound::on_read,
+    streamed_sound::on_seek,
+    streamed_sound::on_get_data_format,
+    streamed_sound::on_get_cursor,
+    streamed_sound::on_get_length,
+    nullptr,
+    0,
+};
+
+streamed_sound::~streamed_sound() {
+    if(m_sound_ready) {
+        ma_sound_uninit(&m_sound);
+    }
+    if(m_source_ready) {
+        ma_data_source_uninit(&m_source.base);
+    }
+    if(m_ring_ready) {
+        ma_pcm_rb_uninit(&m_ring);
+    }
+    if(m_decoder_ready) {
+        ma_decoder_uninit(&m_decoder);
+    }
+}
+
+bool streamed_sound::initialize(ma_engine& p_engine, const char* p_path, bool p_looping, std::function<void()> p_request_refill) {
+    m_channels = ma_engine_get_channels(&p_engine);
+    m_sample_rate = ma_engine_get_sample_rate(&p_engine);
+    m_looping = p_looping;
+    m_request_refill = std::move(p_request_refill);
+
+    // the decoder converts to the engine format so the device thread only copies
+    ma_decoder_config decoder_config = engine_decoder_config(p_engine);
+    if(ma_decoder_init_file(p_path, &decoder_config, &m_decoder) != MA_SUCCESS) {
+        return false;
+    }
+    m_decoder_ready = true;
+
+    m_ring_frames = m_sample_rate * ring_buffer_seconds;
+    if(ma_pcm_rb_init(ma_format_f32, m_channels, m_ring_frames, nullptr, nullptr, &m_ring) != MA_SUCCESS) {
+        return false;
+    }
+    m_ring_ready = true;
+
+    ma_data_source_config source_config = ma_data_source_config_init();
+    source_config.vtable = &s_vtable;
+    if(ma_data_source_init(&source_config, &m_source.base) != MA_SUCCESS) {
+        return false;
+    }
+    m_source.owner = this;
+    m_source_ready = true;
+
+    refill();
+
+    if(ma_sound_init_from_data_source(&p_engine, &m_source.base, 0, nullptr, &m_sound) != MA_SUCCESS) {
+        return false;
+    }
+    m_sound_ready = true;
+    return true;
+}
+
+void streamed_sound::rewind() {
+    m_fence.close();
+
+    ma_decoder_seek_to_pcm_frame(&m_decoder, 0);
+    ma_pcm_rb_reset(&m_ring);
+    m_cursor.store(0, std::memory_order_relaxed);
+    m_decoder_finished.store(false, std::memory_order_release);
+    refill();
+    m_fence.open();
+}
+
+void streamed_sound::refill() {
+    m_needs_refill.store(false, std::memory_order_release);
+    if(m_decoder_finished.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    while(ma_pcm_rb_available_write(&m_ring) > 0) {
+        ma_uint32 chunk = ma_pcm_rb_available_write(&m_ring);
+        void* buffer = nullptr;
+        if(ma_pcm_rb_acquire_write(&m_ring, &chunk, &buffer) != MA_SUCCESS or chunk == 0) {
+            break;
+        }
+
+        auto* frames = static_cast<float*>(buffer);
+        ma_uint64 written = 0;
+        bool wrapped = false;
+        while(written < chunk) {
+            ma_uint64 decoded = 0;
+            ma_decoder_read_pcm_frames(&m_decoder, frames + written * m_channels, chunk - written, &decoded);
+            written += decoded;
+
+            if(written < chunk) {
+                // a looping track that decodes nothing right after a rewind is empty, stop instead of spinning
+                if(!m_looping or (wrapped and decoded == 0)) {
+                    break;
+                }
+                ma_decoder_seek_to_pcm_frame(&m_decoder, 0);
+                wrapped = true;
+            }
+        }
+
+        ma_pcm_rb_commit_write(&m_ring, static_cast<ma_uint32>(written));
+        if(written < chunk) {
+            m_decoder_finished.store(true, std::memory_order_release);
+            break;
+        }
+    }
+}
+
+ma_result streamed_sound::on_read(ma_data_source* p_source, void* p_frames_out, ma_uint64 p_frame_count, ma_uint64* p_frames_read) {
+    streamed_sound& self = *reinterpret_cast<source*>(p_source)->owner;
+    auto* output = static_cast<float*>(p_frames_out);
+
+    if(!self.m_fence.try_enter()) {
+        std::memset(output, 0, static_cast<size_t>(p_frame_count) * self.m_channels * sizeof(float));
+        if(p_frames_read != nullptr) {
+            *p_frames_read = p_frame_count;
+        }
+        return MA_SUCCESS;
+    }
+
+    ma_result result = self.read_ring(output, p_frame_count, p_frames_read);
+    self.m_fence.leave();
+    return result;
+}
+
+ma_result streamed_sound::read_ring(float* p_output, ma_uint64 p_frame_count, ma_uint64* p_frames_read) {
+    ma_uint64 total = 0;
+    while(total < p_frame_count) {
+        auto chunk = static_cast<ma_uint32>(std::min<ma_uint64>(p_frame_count - total, m_ring_frames));
+        void* buffer = nullptr;
+        if(ma_pcm_rb_acquire_read(&m_ring, &chunk, &buffer) != MA_SUCCESS or chunk == 0) {
+            break;
+        }
+
+        std::memcpy(p_output + total * m_channels, buffer, static_cast<size_t>(chunk) * m_channels * sizeof(float));
+        ma_pcm_rb_commit_read(&m_ring, chunk);
+        total += chunk;
+    }
+
+    bool finished = m_decoder_finished.load(std::memory_order_acquire);
+    ma_uint32 buffered = ma_pcm_rb_available_read(&m_ring);
+
+    // wake the worker once per drop below half, the flag keeps us from signalling every callback
+    if(!finished and buffered < m_ring_frames / 2 and !m_needs_refill.exchange(true, std::memory_order_acq_rel)) {
+        m_request_refill();
+    }
+
+    if(total < p_frame_count and finished and buffered == 0) {
+        m_cursor.fetch_add(total, std::memory_order_relaxed);
+        if(p_frames_read != nullptr) {
+            *p_frames_read = total;
+        }
+        return total == 0 ? MA_AT_END : MA_SUCCESS;
+    }
+
+    // the worker fell behind, play silence rather than ending the sound
+    if(total < p_frame_count) {
+        std::memset(p_output + total * m_channels, 0, static_cast<size_t>(p_frame_count - total) * m_channels * sizeof(float));
+        m_underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    m_cursor.fetch_add(p_frame_count, std::memory_order_relaxed);
+    if(p_frames_read != nullptr) {
+        *p_frames_read = p_frame_count;
+    }
+    return MA_SUCCESS;
+}
+
+ma_result streamed_sound::on_seek(ma_data_source*, ma_uint64 p_frame_index) {
+    // ma_sound_start seeks to 0 after the sound reached its end. The worker
+    // already rewound the decoder before starting, anything else is unsupported
+    return p_frame_index == 0 ? MA_SUCCESS : MA_NOT_IMPLEMENTED;
+}
+
+ma_result streamed_sound::on_get_data_format(ma_data_source* p_source, ma_format* p_format, ma_uint32* p_channels, ma_uint32* p_sample_rate,
+                                             ma_channel* p_channel_map, size_t p_channel_map_capacity) {
+    const streamed_sound& self = *reinterpret_cast<source*>(p_source)->owner;
+    *p_format = ma_format_f32;
+    *p_channels = self.m_channels;
+    *p_sample_rate = self.m_sample_rate;
+    if(p_channel_map != nullptr) {
+        ma_channel_map_init_standard(ma_standard_channel_map_default, p_channel_map, p_channel_map_capacity, self.m_channels);
+    }
+    return MA_SUCCESS;
+}
+
+ma_result streamed_sound::on_get_cursor(ma_data_source* p_source, ma_uint64* p_cursor) {
+    const streamed_sound& self = *reinterpret_cast<source*>(p_source)->owner;
+    *p_cursor = self.m_cursor.load(std::memory_order_relaxed);
+    return MA_SUCCESS;
+}
+
+ma_result streamed_sound::on_get_length(ma_data_source*, ma_uint64* p_length) {
+    // unknown while streaming, mp3 lengths are only estimates anyway
+    *p_length = 0;
+    return MA_NOT_IMPLEMENTED;
+}
+
+void sound_bank::initialize(ma_engine& p_engine, uint32_t p_capacity, std::function<void()> p_request_refill) {
+    m_engine = &p_engine;
+    // keep the table at most half full so probes stay short
+    m_capacity = std::bit_ceil(std::max(p_capacity, 1u) * 2);
+    m_entries = std::make_unique<entry[]>(m_capacity);
+    m_count = 0;
+    m_request_refill = std::move(p_request_refill);
+}
+
+void sound_bank::clear() {
+    for(uint32_t i = 0; i < m_capacity; i++) {
+        m_entries[i].id.store(invalid_sound, std::memory_order_relaxed);
+        m_entries[i].decoded.reset();
+        m_entries[i].streamed.reset();
+    }
+    m_count = 0;
+}
+
+sound_id sound_bank::load(std::string_view p_path, const sound_load_desc& p_desc) {
+    sound_id id = make_sound_id(p_path);
+    if(m_engine == nullptr or id == invalid_sound) {
+        return invalid_sound;
+    }
+
+    if(find(id) != nullptr) {
+        return id;
+    }
+
+    if((m_count + 1) * 2 > m_capacity) {
+        console_log_error("Sound bank is full, could not load {}", p_path);
+        return invalid_sound;
+    }
+
+    std::string path(p_path);
+    sound_load_desc::load_mode mode = p_desc.mode;
+    if(mode == sound_load_desc::load_mode::automatic) {
+        mode = duration_seconds(path.c_str()) > stream_threshold_seconds ? sound_load_desc::load_mode::streamed
+                                                                          : sound_load_desc::load_mode::decoded;
+    }
+
+    std::unique_ptr<decoded_sound> decoded;
+    std::unique_ptr<streamed_sound> streamed;
+    if(mode == sound_load_desc::load_mode::streamed) {
+        streamed = std::make_unique<streamed_sound>();
+        if(!streamed->initialize(*m_engine, path.c_str(), p_desc.looping, m_request_refill)) {
+            console_log_error("Could not open sound stream {}", path);
+            return invalid_sound;
+        }
+    }
+    else {
+        decoded = decode(path.c_str(), p_desc.max_instances);
+        if(decoded == nullptr) {
+            console_log_error("Could not decode sound {}", path);
+            return invalid_sound;
+        }
+    }
+
+    uint32_t slot = static_cast<uint32_t>(id) & (m_capacity - 1);
+    while(m_entries[slot].id.load(std::memory_order_relaxed) != invalid_sound) {
+        slot = (slot + 1) & (m_capacity - 1);
+    }
+
+    // the id is stored last, the worker only reads the sound once it sees the id
+    m_entries[slot].decoded = std::move(decoded);
+    m_entries[slot].streamed = std::move(streamed);
+    m_entries[slot].id.store(id, std::memory_order_release);
+    m_count++;
+    return id;
+}
+
+const sound_bank::entry* sound_bank::find(sound_id p_id) const {
+    if(m_capacity == 0 or p_id == invalid_sound) {
+        return nullptr;
+    }
+
+    uint32_t slot = static_cast<uint32_t>(p_id) & (m_capacity - 1);
+    for(uint32_t probe = 0; probe < m_capacity; probe++) {
+        sound_id stored = m_entries[slot].id.load(std::memory_order_acquire);
+        if(stored == p_id) {
+            return &m_entries[slot];
+        }
+        if(stored == invalid_sound) {
+            return nullptr;
+        }
+        slot = (slot + 1) & (m_capacity - 1);
+    }
+    return nullptr;
+}
+
+std::unique_ptr<decoded_sound> sound_bank::decode(const char* p_path, uint32_t p_max_instances) const {
+    ma_decoder decoder;
+    ma_decoder_config config = engine_decoder_config(*m_engine);
+    if(ma_decoder_init_file(p_path, &config, &decoder) != MA_SUCCESS) {
+        return nullptr;
+    }
+
+    uint32_t channels = ma_engine_get_channels(m_engine);
+    auto sound = std::make_unique<decoded_sound>();
+    sound->max_instances = p_max_instances;
+
+    ma_uint64 expected = 0;
+    if(ma_decoder_get_length_in_pcm_frames(&decoder, &expected) == MA_SUCCESS) {
+        sound->pcm.reserve(expected * channels);
+    }
+
+    // mp3 lengths are estimates, read until the decoder runs dry instead of trusting them
+    constexpr ma_uint64 chunk_frames = 4096;
+    while(true) {
+        size_t offset = sound->pcm.size();
+        sound->pcm.resize(offset + chunk_frames * channels);
+        ma_uint64 decoded = 0;
+        ma_decoder_read_pcm_frames(&decoder, sound->pcm.data() + offset, chunk_frames, &decoded);
+        sound->pcm.resize(offset + decoded * channels);
+        if(decoded < chunk_frames) {
+            break;
+        }
+    }
+    ma_decoder_uninit(&decoder);
+
+    sound->pcm.shrink_to_fit();
+    sound->frame_count = sound->pcm.size() / channels;
+    if(sound->frame_count == 0) {
+        return nullptr;
+    }
+    return sound;
+}
+
+float sound_bank::duration_seconds(const char* p_path) const {
+    ma_decoder decoder;
+    ma_decoder_config config = engine_decoder_config(*m_engine);
+    if(ma_decoder_init_file(p_path, &config, &decoder) != MA_SUCCESS) {
+        return 0.f;
+    }
+
+    ma_uint64 length = 0;
+    ma_decoder_get_length_in_pcm_frames(&decoder, &length);
+    ma_decoder_uninit(&decoder);
+    return static_cast<float>(length) / static_cast<float>(ma_engine_get_sample_rate(m_engine));
+}
@@ -0,0 +1,211 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <miniaudio/miniaudio.h>
+#include "hash.hpp"
+
+/**
+ * @brief Sounds are identified by the hash of their path so gameplay code can
+ * keep a precomputed constant instead of a path string
+ *
+ * constexpr sound_id contact_sound = make_sound_id("Resources/rolling_ball_on_wood.mp3");
+ */
+using sound_id = uint64_t;
+constexpr sound_id invalid_sound = 0;
+
+constexpr sound_id make_sound_id(std::string_view p_path) {
+    return fnv1a(p_path);
+}
+
+struct sound_load_desc {
+    enum class load_mode : uint8_t {
+        //! decoded when shorter than sound_bank::stream_threshold_seconds, streamed otherwise
+        automatic,
+        decoded,
+        streamed,
+    };
+
+    load_mode mode = load_mode::automatic;
+    //! how many voices may play a decoded sound at once, streamed sounds always have one
+    uint32_t max_instances = 1;
+    bool looping = false;
+};
+
+/**
+ * @name device_read_fence
+ * @brief Keeps the audio device thread out of a data source while the worker changes it
+ *
+ * The device thread wraps every read in try_enter()/leave() and plays silence
+ * when try_enter() fails. close() returns once no read is in progress, until
+ * open() the source's state belongs to the caller. Stopping an ma_sound does
+ * not give that guarantee, the device thread may still be inside a read.
+ */
+class device_read_fence {
+public:
+    //! @brief Device thread, false while the fence is closed
+    bool try_enter() {
+        // seq_cst pairs with close(): either it sees m_reading and waits, or this sees m_closed
+        m_reading.store(true, std::memory_order_seq_cst);
+        if(m_closed.load(std::memory_order_seq_cst)) {
+            m_reading.store(false, std::memory_order_release);
+            return false;
+        }
+        return true;
+    }
+
+    void leave() { m_reading.store(false, std::memory_order_release); }
+
+    //! @brief Worker thread, waits for a read in progress, which is one device period at most
+    void close() {
+        m_closed.store(true, std::memory_order_seq_cst);
+        while(m_reading.load(std::memory_order_seq_cst)) {
+            std::this_thread::yield();
+        }
+    }
+
+    void open() { m_closed.store(false, std::memory_order_release); }
+
+private:
+    std::atomic<bool> m_closed{ false };
+    std::atomic<bool> m_reading{ false };
+};
+
+//! Short effect decoded once into PCM in the engine's output format, shared by every voice that plays it
+struct decoded_sound {
+    std::vector<float> pcm;
+    uint64_t frame_count=0;
+    uint32_t max_instances=1;
+};
+
+/**
+ * @name streamed_sound
+ * @brief Long track decoded incrementally into a ring buffer
+ *
+ * The audio device thread reads from the ring buffer through a custom
+ * ma_data_source. When the buffer drops below half full it raises the refill
+ * callback so the audio worker decodes the next chunk; the device thread
+ * never decodes.
+ */
+class streamed_sound {
+public:
+    static constexpr uint32_t ring_buffer_seconds = 2;
+
+    streamed_sound() = default;
+    ~streamed_sound();
+
+    streamed_sound(const streamed_sound&) = delete;
+    streamed_sound& operator=(const streamed_sound&) = delete;
+
+    bool initialize(ma_engine& p_engine, const char* p_path, bool p_looping, std::function<void()> p_request_refill);
+
+    /**
+     * @brief Rewinds the decoder and refills the ring buffer, worker thread only
+     *
+     * Keeps the device thread out of the ring buffer while it is reset: reads
+     * play silence from here on, and it waits for a read already in progress.
+     */
+    void rewind();
+
+    //! @brief Decodes until the ring buffer is full, worker thread only
+    void refill();
+
+    [[nodiscard]] bool needs_refill() const { return m_needs_refill.load(std::memory_order_acquire); }
+
+    [[nodiscard]] ma_sound* sound() { return &m_sound; }
+
+    //! @brief Times the device thread ran out of decoded frames and played silence
+    [[nodiscard]] uint32_t underruns() const { return m_underruns.load(std::memory_order_relaxed); }
+
+private:
+    static ma_result on_read(ma_data_source* p_source, void* p_frames_out, ma_uint64 p_frame_count, ma_uint64* p_frames_read);
+    ma_result read_ring(float* p_output, ma_uint64 p_frame_count, ma_uint64* p_frames_read);
+    static ma_result on_seek(ma_data_source* p_source, ma_uint64 p_frame_index);
+    static ma_result on_get_data_format(ma_data_source* p_source, ma_format* p_format, ma_uint32* p_channels, ma_uint32* p_sample_rate,
+                                        ma_channel* p_channel_map, size_t p_channel_map_capacity);
+    static ma_result on_get_cursor(ma_data_source* p_source, ma_uint64* p_cursor);
+    static ma_result on_get_length(ma_data_source* p_source, ma_uint64* p_length);
+
+    static const ma_data_source_vtable s_vtable;
+
+private:
+    // miniaudio hands the callbacks a pointer to base, which has to be the first member
+    struct source {
+        ma_data_source_base base;
+        streamed_sound* owner;
+    };
+
+    source m_source;
+    ma_decoder m_decoder;
+    ma_pcm_rb m_ring;
+    ma_sound m_sound;
+    uint32_t m_channels=0;
+    uint32_t m_sample_rate=0;
+    uint32_t m_ring_frames=0;
+    bool m_looping=false;
+    bool m_decoder_ready=false;
+    bool m_ring_ready=false;
+    bool m_source_ready=false;
+    bool m_sound_ready=false;
+    std::atomic<bool> m_decoder_finished{ false };
+    std::atomic<bool> m_needs_refill{ false };
+    //! closed by rewind() while the ring buffer is reset
+    device_read_fence m_fence;
+    std::atomic<uint64_t> m_cursor{ 0 };
+    std::atomic<uint32_t> m_underruns{ 0 };
+    std::function<void()> m_request_refill;
+};
+
+/**
+ * @name sound_bank
+ * @brief Fixed-capacity table of loaded sounds keyed by sound_id
+ *
+ * Sounds are added on the main thread and looked up from the audio worker.
+ * Lookups are a lock-free probe of an open addressing table and never
+ * allocate.
+ */
+class sound_bank {
+public:
+    static constexpr float stream_threshold_seconds = 10.f;
+
+    struct entry {
+        std::atomic<sound_id> id{ invalid_sound };
+        std::unique_ptr<decoded_sound> decoded;
+        std::unique_ptr<streamed_sound> streamed;
+    };
+
+    sound_bank() = default;
+
+    void initialize(ma_engine& p_engine, uint32_t p_capacity, std::function<void()> p_request_refill);
+
+    void clear();
+
+    sound_id load(std::string_view p_path, const sound_load_desc& p_desc);
+
+    [[nodiscard]] const entry* find(sound_id p_id) const;
+
+    //! @brief Calls p_callback for every streamed sound, worker thread only
+    template<typename Fn>
+    void for_each_stream(Fn&& p_callback) {
+        for(uint32_t i = 0; i < m_capacity; i++) {
+            if(m_entries[i].id.load(std::memory_order_acquire) != invalid_sound and m_entries[i].streamed) {
+                p_callback(*m_entries[i].streamed);
+            }
+        }
+    }
+
+private:
+    std::unique_ptr<decoded_sound> decode(const char* p_path, uint32_t p_max_instances) const;
+    float duration_seconds(const char* p_path) const;
+
+private:
+    ma_engine* m_engine=nullptr;
+    std::unique_ptr<entry[]> m_entries;
+    uint32_t m_capacity=0;
+    uint32_t m_count=0;
+    std::function<void()> m_request_refill;
+};
@@ -0,0 +1,312 @@
+#include "spatial_hash.hpp"
+#include <core/engine_logger.hpp>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+spatial_hash::spatial_hash(float p_cell_size)
+  : m_cell_size(std::max(p_cell_size, 0.001f))
+  , m_inverse_cell_size(1.f / m_cell_size) {
+    clear();
+}
+
+void spatial_hash::attach(flecs::world& p_registry) {
+    detach();
+    m_world = p_registry.c_ptr();
+    m_query = p_registry.query_builder<spatial_indexed, const atlas::transform>().build();
+    // OnAdd covers entities that become indexed, OnSet covers transforms written afterwards
+    m_on_transform = p_registry.observer<spatial_indexed, const atlas::transform>()
+                       .event(flecs::OnAdd)
+                       .event(flecs::OnSet)
+                       .each([this](flecs::entity p_entity, spatial_indexed& p_indexed, const atlas::transform&) { queue(p_entity, p_indexed); });
+    m_on_remove = p_registry.observer<spatial_indexed>().event(flecs::OnRemove).each([this](flecs::entity p_entity, spatial_indexed& p_indexed) {
+        if(p_indexed.slot == invalid_slot) {
+            return;
+        }
+
+        flecs::entity_t moved = erase(p_indexed.slot);
+        if(moved != 0 and moved != p_entity.id()) {
+            p_entity.world().entity(moved).get_mut<spatial_indexed>()->slot = p_indexed.slot;
+        }
+        p_indexed.slot = invalid_slot;
+    });
+
+    // observers only see what happens from now on, entities already indexed go in with the first sync
+    m_query.each([this](flecs::entity p_entity, spatial_indexed& p_indexed, const atlas::transform&) { queue(p_entity, p_indexed); });
+}
+
+void spatial_hash::queue(flecs::entity p_entity, spatial_indexed& p_indexed) {
+    if(p_indexed.queued) {
+        return;
+    }
+    p_indexed.queued = true;
+    m_dirty.push_back(p_entity.id());
+}
+
+void spatial_hash::detach() {
+    if(m_world == nullptr) {
+        return;
+    }
+
+    // entities keep their component, a later attach inserts them again
+    m_query.each([](flecs::entity, spatial_indexed& p_indexed, const atlas::transform&) {
+        p_indexed.slot = invalid_slot;
+        p_indexed.queued = false;
+    });
+    m_on_transform.destruct();
+    m_on_remove.destruct();
+    m_query.destruct();
+    m_world = nullptr;
+    clear();
+}
+
+void spatial_hash::sync(flecs::world& p_registry) {
+    if(m_world != p_registry.c_ptr()) {
+        console_log_error("spatial_hash::sync called on a world it is not attached to");
+        return;
+    }
+
+    for(flecs::entity_t id : m_dirty) {
+        // deleted or unindexed since it was queued, the OnRemove observer already dropped it
+        flecs::entity entity = p_registry.entity(id);
+        if(!entity.is_alive()) {
+            continue;
+        }
+        spatial_indexed* indexed = entity.get_mut<spatial_indexed>();
+        const atlas::transform* transform = entity.get<atlas::transform>();
+        if(indexed == nullptr or transform == nullptr or !indexed->queued) {
+            continue;
+        }
+
+        indexed->queued = false;
+        if(indexed->slot == invalid_slot) {
+            indexed->slot = insert(id, transform->position);
+            continue;
+        }
+        move(indexed->slot, transform->position);
+    }
+    m_dirty.clear();
+}
+
+glm::ivec3 spatial_hash::cell_of(const glm::vec3& p_position) const {
+    return glm::ivec3(static_cast<int>(std::floor(p_position.x * m_inverse_cell_size)),
+                      static_cast<int>(std::floor(p_position.y * m_inverse_cell_size)),
+                      static_cast<int>(std::floor(p_position.z * m_inverse_cell_size)));
+}
+
+uint64_t spatial_hash::cell_key(const glm::ivec3& p_cell) {
+    // 21 bits per axis, cells wrap after about a million in each direction
+    constexpr uint64_t mask = (1ull << 21) - 1;
+    return ((static_cast<uint64_t>(static_cast<uint32_t>(p_cell.x)) & mask) << 42) |
+           ((static_cast<uint64_t>(static_cast<uint32_t>(p_cell.y)) & mask) << 21) |
+           (static_cast<uint64_t>(static_cast<uint32_t>(p_cell.z)) & mask);
+}
+
+void spatial_hash::bucket_insert(uint32_t p_slot, const glm::ivec3& p_cell) {
+    uint64_t key = cell_key(p_cell);
+    std::vector<uint32_t>& bucket = m_buckets[key];
+    m_keys[p_slot] = key;
+    m_min_cell = glm::min(m_min_cell, p_cell);
+    m_max_cell = glm::max(m_max_cell, p_cell);
+    m_bucket_index[p_slot] = static_cast<uint32_t>(bucket.size());
+    bucket.push_back(p_slot);
+}
+
+void spatial_hash::bucket_remove(uint32_t p_slot) {
+    std::vector<uint32_t>& bucket = m_buckets[m_keys[p_slot]];
+    uint32_t index = m_bucket_index[p_slot];
+    uint32_t last = bucket.back();
+    bucket[index] = last;
+    m_bucket_index[last] = index;
+    bucket.pop_back();
+}
+
+uint32_t spatial_hash::insert(flecs::entity_t p_entity, const glm::vec3& p_position) {
+    auto slot = static_cast<uint32_t>(m_entities.size());
+    m_entities.push_back(p_entity);
+    m_positions.push_back(p_position);
+    m_keys.push_back(0);
+    m_bucket_index.push_back(0);
+    bucket_insert(slot, cell_of(p_position));
+    return slot;
+}
+
+void spatial_hash::move(uint32_t p_slot, const glm::vec3& p_position) {
+    m_positions[p_slot] = p_position;
+    glm::ivec3 cell = cell_of(p_position);
+    if(cell_key(cell) == m_keys[p_slot]) {
+        return;
+    }
+    bucket_remove(p_slot);
+    bucket_insert(p_slot, cell);
+}
+
+flecs::entity_t spatial_hash::erase(uint32_t p_slot) {
+    bucket_remove(p_slot);
+
+    auto last = static_cast<uint32_t>(m_entities.size() - 1);
+    if(p_slot != last) {
+        // the last slot moves into the hole, its bucket entry has to follow
+        m_entities[p_slot] = m_entities[last];
+        m_positions[p_slot] = m_positions[last];
+        m_keys[p_slot] = m_keys[last];
+        m_bucket_index[p_slot] = m_bucket_index[last];
+        m_buckets[m_keys[p_slot]][m_bucket_index[p_slot]] = p_slot;
+    }
+
+    flecs::entity_t moved = m_entities[p_slot];
+    m_entities.pop_back();
+    m_positions.pop_back();
+    m_keys.pop_back();
+    m_bucket_index.pop_back();
+    return p_slot != last ? moved : 0;
+}
+
+void spatial_hash::clear() {
+    m_entities.clear();
+    m_positions.clear();
+    m_keys.clear();
+    m_bucket_index.clear();
+    m_buckets.clear();
+    m_min_cell = glm::ivec3(std::numeric_limits<int>::max());
+    m_max_cell = glm::ivec3(std::numeric_limits<int>::min());
+}
+
+template<typename Fn>
+void spatial_hash::for_each_in_cells(const glm::ivec3& p_min_cell, const glm::ivec3& p_max_cell, Fn&& p_fn) const {
+    // nothing lies outside the occupied bounds, so those cells are never looked up
+    glm::ivec3 min_cell = glm::max(p_min_cell, m_min_cell);
+    glm::ivec3 max_cell = glm::min(p_max_cell, m_max_cell);
+    if(min_cell.x > max_cell.x or min_cell.y > max_cell.y or min_cell.z > max_cell.z) {
+        return;
+    }
+
+    // a large query would look up more cells than there are entries, scan those instead
+    double cell_count = (static_cast<double>(max_cell.x) - min_cell.x + 1.0) * (static_cast<double>(max_cell.y) - min_cell.y + 1.0) *
+                        (static_cast<double>(max_cell.z) - min_cell.z + 1.0);
+    if(cell_count > static_cast<double>(m_entities.size())) {
+        for(uint32_t slot = 0; slot < m_entities.size(); slot++) {
+            p_fn(slot);
+        }
+        return;
+    }
+
+    for(int x = min_cell.x; x <= max_cell.x; x++) {
+        for(int y = min_cell.y; y <= max_cell.y; y++) {
+            for(int z = min_cell.z; z <= max_cell.z; z++) {
+                auto bucket = m_buckets.find(cell_key(glm::ivec3(x, y, z)));
+                if(bucket == m_buckets.end()) {
+                    continue;
+                }
+                for(uint32_t slot : bucket->second) {
+                    p_fn(slot);
+                }
+            }
+        }
+    }
+}
+
+void spatial_hash::query_radius(const glm::vec3& p_center, float p_radius, std::vector<flecs::entity_t>& p_out) const {
+    glm::vec3 extent(p_radius);
+    float radius_squared = p_radius * p_radius;
+    for_each_in_cells(cell_of(p_center - extent), cell_of(p_center + extent), [&](uint32_t p_slot) {
+        glm::vec3 offset = m_positions[p_slot] - p_center;
+        if(glm::dot(offset, offset) <= radius_squared) {
+            p_out.push_back(m_entities[p_slot]);
+        }
+    });
+}
+
+void spatial_hash::query_aabb(const glm::vec3& p_min, const glm::vec3& p_max, std::vector<flecs::entity_t>& p_out) const {
+    for_each_in_cells(cell_of(p_min), cell_of(p_max), [&](uint32_t p_slot) {
+        const glm::vec3& position = m_positions[p_slot];
+        if(position.x >= p_min.x and position.y >= p_min.y and position.z >= p_min.z and position.x <= p_max.x and
+           position.y <= p_max.y and position.z <= p_max.z) {
+            p_out.push_back(m_entities[p_slot]);
+        }
+    });
+}
+
+void spatial_hash::query_nearest(const glm::vec3& p_center, uint32_t p_count, std::vector<flecs::entity_t>& p_out,
+                                 float p_max_distance) const {
+    if(p_count == 0 or m_entities.empty()) {
+        return;
+    }
+
+    // max-heap on distance holding the best p_count so far
+    std::vector<std::pair<float, uint32_t>> best;
+    best.reserve(p_count + 1);
+    float max_distance_squared = p_max_distance * p_max_distance;
+    auto consider = [&](uint32_t p_slot) {
+        glm::vec3 offset = m_positions[p_slot] - p_center;
+        float distance_squared = glm::dot(offset, offset);
+        if(distance_squared > max_distance_squared) {
+            return;
+        }
+        if(best.size() == p_count and distance_squared >= best.front().first) {
+            return;
+        }
+        best.emplace_back(distance_squared, p_slot);
+        std::push_heap(best.begin(), best.end());
+        if(best.size() > p_count) {
+            std::pop_heap(best.begin(), best.end());
+            best.pop_back();
+        }
+    };
+
+    // grow a shell of cells around the center until nothing outside it can beat what was found,
+    // the shell stops at the occupied bounds since nothing lies past them
+    glm::ivec3 center = cell_of(p_center);
+    glm::ivec3 reach = glm::max(glm::abs(m_min_cell - center), glm::abs(m_max_cell - center));
+    int last_ring = std::max(reach.x, std::max(reach.y, reach.z));
+    size_t visited = 0;
+    size_t cells_visited = 0;
+    for(int ring = 0; ring <= last_ring; ring++) {
+        // p_center can sit on the edge of its cell, so cells in this ring are only a ring - 1 cells away
+        float ring_distance = static_cast<float>(std::max(ring - 1, 0)) * m_cell_size;
+        if(ring_distance * ring_distance > max_distance_squared) {
+            break;
+        }
+        if(best.size() == p_count and best.front().first <= ring_distance * ring_distance) {
+            break;
+        }
+        if(visited == m_entities.size()) {
+            break;
+        }
+
+        // a far or sparse query would look up more empty cells than there are entries, scan those instead
+        auto side = static_cast<size_t>(2 * ring + 1);
+        auto inner = static_cast<size_t>(std::max(2 * ring - 1, 0));
+        cells_visited += side * side * side - inner * inner * inner;
+        if(cells_visited > m_entities.size()) {
+            best.clear();
+            for(uint32_t slot = 0; slot < m_entities.size(); slot++) {
+                consider(slot);
+            }
+            break;
+        }
+
+        for(int x = -ring; x <= ring; x++) {
+            for(int y = -ring; y <= ring; y++) {
+                bool x_or_y_on_shell = std::abs(x) == ring or std::abs(y) == ring;
+                // inside the shell only the two z faces are new
+                int z_step = x_or_y_on_shell ? 1 : std::max(2 * ring, 1);
+                for(int z = -ring; z <= ring; z += z_step) {
+                    auto bucket = m_buckets.find(cell_key(center + glm::ivec3(x, y, z)));
+                    if(bucket == m_buckets.end()) {
+                        continue;
+                    }
+                    visited += bucket->second.size();
+                    for(uint32_t slot : bucket->second) {
+                        consider(slot);
+                    }
+                }
+            }
+        }
+    }
+
+    std::sort_heap(best.begin(), best.end());
+    for(const auto& [distance_squared, slot] : best) {
+        p_out.push_back(m_entities[slot]);
+    }
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <cstdint>
+#include <flecs.h>
+#include <glm/glm.hpp>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+#include <core/scene/components.hpp>
+
+//! Marks an entity for the spatial_hash attached to its world, both fields are managed by the hash
+struct spatial_indexed {
+    uint32_t slot = std::numeric_limits<uint32_t>::max();
+    //! the entity is waiting in the hash's dirty list for the next sync()
+    bool queued = false;
+};
+
+/**
+ * @name spatial_hash
+ * @brief Uniform hash grid over entity positions for proximity queries
+ *
+ * Cells are cubes of cell_size keyed by their packed integer coordinates, so
+ * only occupied cells cost memory. Entities are re-bucketed only when they
+ * cross into another cell, moving within a cell just updates the stored
+ * position.
+ *
+ * Flecs side: attach() to a world, add spatial_indexed to the entities to
+ * track, and call sync() once per step after transforms change. An observer
+ * queues entities whose atlas::transform was set, so sync() only visits
+ * what moved; code writing through get_mut has to call
+ * modified<atlas::transform>() for the hash to see it. Removing
+ * spatial_indexed or deleting the entity drops it from the hash through an
+ * observer. Only one spatial_hash can be attached to a world at a time since
+ * the slot lives on the component.
+ *
+ * Queries append to p_out and never clear it. No query looks up cells past
+ * the ones that were ever occupied, and each one scans every entry instead
+ * when it would visit more cells than there are entries.
+ */
+class spatial_hash {
+public:
+    static constexpr uint32_t invalid_slot = std::numeric_limits<uint32_t>::max();
+
+    //! @param p_cell_size a bit above the most common query radius works well
+    spatial_hash(float p_cell_size = 4.f);
+
+    spatial_hash(const spatial_hash&) = delete;
+    spatial_hash& operator=(const spatial_hash&) = delete;
+
+    //! @brief Starts tracking spatial_indexed entities of p_registry, detaching from any previous world
+    void attach(flecs::world& p_registry);
+
+    //! @brief Forgets every entity and removes the observer, call while the world is still alive
+    void detach();
+
+    //! @brief Inserts new spatial_indexed entities and re-buckets the ones whose transform was set since the last sync
+    void sync(flecs::world& p_registry);
+
+    uint32_t insert(flecs::entity_t p_entity, const glm::vec3& p_position);
+
+    void move(uint32_t p_slot, const glm::vec3& p_position);
+
+    //! @brief Removes p_slot, the last slot takes its place and is returned so the caller can patch it
+    flecs::entity_t erase(uint32_t p_slot);
+
+    void clear();
+
+    //! @brief Entities within p_radius of p_center
+    void query_radius(const glm::vec3& p_center, float p_radius, std::vector<flecs::entity_t>& p_out) const;
+
+    //! @brief Entities inside the box p_min to p_max, bounds included
+    void query_aabb(const glm::vec3& p_min, const glm::vec3& p_max, std::vector<flecs::entity_t>& p_out) const;
+
+    //! @brief Up to p_count entities closest to p_center, nearest first
+    void query_nearest(const glm::vec3& p_center, uint32_t p_count, std::vector<flecs::entity_t>& p_out,
+                       float p_max_distance = std::numeric_limits<float>::max()) const;
+
+    [[nodiscard]] size_t size() const { return m_entities.size(); }
+
+    [[nodiscard]] float cell_size() const { return m_cell_size; }
+
+    [[nodiscard]] const glm::vec3& position(uint32_t p_slot) const { return m_positions[p_slot]; }
+
+private:
+    [[nodiscard]] glm::ivec3 cell_of(const glm::vec3& p_position) const;
+
+    static uint64_t cell_key(const glm::ivec3& p_cell);
+
+    void bucket_insert(uint32_t p_slot, const glm::ivec3& p_cell);
+
+    //! @brief Queues p_entity for the next sync(), once
+    void queue(flecs::entity p_entity, spatial_indexed& p_indexed);
+
+    void bucket_remove(uint32_t p_slot);
+
+    //! calls p_fn(slot) for every entry in the cells overlapping p_min_cell to p_max_cell, or for every entry when that is cheaper
+    template<typename Fn>
+    void for_each_in_cells(const glm::ivec3& p_min_cell, const glm::ivec3& p_max_cell, Fn&& p_fn) const;
+
+private:
+    float m_cell_size;
+    float m_inverse_cell_size;
+
+    // one entry per slot
+    std::vector<flecs::entity_t> m_entities;
+    std::vector<glm::vec3> m_positions;
+    std::vector<uint64_t> m_keys;
+    //! position of the slot inside its bucket, for O(1) removal
+    std::vector<uint32_t> m_bucket_index;
+
+    std::unordered_map<uint64_t, std::vector<uint32_t>> m_buckets;
+    //! cells ever occupied since the last clear(), only grows
+    glm::ivec3 m_min_cell;
+    glm::ivec3 m_max_cell;
+
+    flecs::world_t* m_world=nullptr;
+    flecs::query<spatial_indexed, const atlas::transform> m_query;
+    flecs::observer m_on_transform;
+    flecs::observer m_on_remove;
+    //! entities added or moved since the last sync()
+    std::vector<flecs::entity_t> m_dirty;
+};
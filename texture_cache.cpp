@@ -0,0 +1,363 @@
+#include "texture_cache.hpp"
+#include "hash.hpp"
+#include <core/engine_logger.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+
+// static linkage keeps these from clashing with the engine's own copy of stb_image
+#define STB_IMAGE_STATIC
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+struct texture_data::file_header {
+    static constexpr uint32_t max_mips = 16;
+
+    struct mip_entry {
+        uint32_t width=0;
+        uint32_t height=0;
+        uint64_t offset=0;
+        uint64_t size=0;
+    };
+
+    uint32_t magic=0;
+    uint32_t version=0;
+    uint64_t source_hash=0;
+    uint64_t source_size=0;
+    uint32_t mip_count=0;
+    uint32_t reserved=0;
+    mip_entry mips[max_mips];
+};
+
+namespace {
+    //! "ATTX"
+    constexpr uint32_t texture_file_magic = 0x58545441;
+    //! 2: the source write time moved from the header to the cache file's own write time
+    constexpr uint32_t texture_file_version = 2;
+    constexpr uint32_t bytes_per_pixel = 4;
+
+    int64_t write_time_of(const std::filesystem::path& p_path) {
+        std::error_code ec;
+        auto time = std::filesystem::last_write_time(p_path, ec);
+        return ec ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+    }
+
+    //! 2x2 box filter, odd edges reuse the last row/column
+    std::vector<uint8_t> downsample(const uint8_t* p_source, uint32_t p_width, uint32_t p_height, uint32_t p_out_width, uint32_t p_out_height) {
+        std::vector<uint8_t> result(size_t(p_out_width) * p_out_height * bytes_per_pixel);
+
+        for(uint32_t y = 0; y < p_out_height; y++) {
+            uint32_t y0 = std::min(y * 2, p_height - 1);
+            uint32_t y1 = std::min(y * 2 + 1, p_height - 1);
+            for(uint32_t x = 0; x < p_out_width; x++) {
+                uint32_t x0 = std::min(x * 2, p_width - 1);
+                uint32_t x1 = std::min(x * 2 + 1, p_width - 1);
+                for(uint32_t c = 0; c < bytes_per_pixel; c++) {
+                    uint32_t sum = p_source[(size_t(y0) * p_width + x0) * bytes_per_pixel + c] +
+                                   p_source[(size_t(y0) * p_width + x1) * bytes_per_pixel + c] +
+                                   p_source[(size_t(y1) * p_width + x0) * bytes_per_pixel + c] +
+                                   p_source[(size_t(y1) * p_width + x1) * bytes_per_pixel + c];
+                    result[(size_t(y) * p_out_width + x) * bytes_per_pixel + c] = static_cast<uint8_t>((sum + 2) / 4);
+                }
+            }
+        }
+
+        return result;
+    }
+}
+
+texture_data::texture_data(const std::filesystem::path& p_cache_path) : m_file(p_cache_path), m_write_time(write_time_of(p_cache_path)) {
+    if(!m_file.is_open() or m_file.size() < sizeof(file_header)) {
+        return;
+    }
+
+    const auto* header = reinterpret_cast<const file_header*>(m_file.data());
+    if(header->magic != texture_file_magic or header->version != texture_file_version or
+       header->mip_count == 0 or header->mip_count > file_header::max_mips) {
+        return;
+    }
+
+    for(uint32_t i = 0; i < header->mip_count; i++) {
+        const auto& entry = header->mips[i];
+        if(entry.offset + entry.size > m_file.size() or entry.size != uint64_t(entry.width) * entry.height * bytes_per_pixel) {
+            return;
+        }
+    }
+
+    m_header = header;
+}
+
+uint32_t texture_data::mip_count() const {
+    return m_header->mip_count;
+}
+
+texture_mip texture_data::mip(uint32_t p_level) const {
+    const auto& entry = m_header->mips[p_level];
+    return { entry.width, entry.height, m_file.bytes().subspan(entry.offset, entry.size) };
+}
+
+uint64_t texture_data::source_hash() const {
+    return m_header->source_hash;
+}
+
+bool texture_data::matches_source_stamp(uint64_t p_size, int64_t p_write_time) const {
+    return m_header->source_size == p_size and m_write_time == p_write_time;
+}
+
+void texture_data::advise(uint32_t p_level, mapped_file::access_hint p_hint) const {
+    const auto& entry = m_header->mips[p_level];
+    m_file.advise(entry.offset, entry.size, p_hint);
+}
+
+texture_mip streamed_texture::resident(uint32_t p_level) const {
+    if(status() != state::ready) {
+        return { 0, 0, {} };
+    }
+    return m_data->mip(std::max(p_level, resident_mip()));
+}
+
+texture_cache::texture_cache(const std::filesystem::path& p_directory, thread_pool& p_pool)
+  : m_directory(p_directory), m_pool(&p_pool) {
+    std::error_code ec;
+    std::filesystem::create_directories(m_directory, ec);
+}
+
+std::filesystem::path texture_cache::cache_path(const std::string& p_source) const {
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), "-%016llx.tex", static_cast<unsigned long long>(fnv1a(p_source)));
+    return m_directory / (std::filesystem::path(p_source).stem().string() + suffix);
+}
+
+std::shared_ptr<streamed_texture> texture_cache::get(const std::string& p_path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(auto it = m_textures.find(p_path); it != m_textures.end()) {
+        return it->second;
+    }
+
+    auto texture = std::make_shared<streamed_texture>();
+    m_textures.emplace(p_path, texture);
+    m_pool->submit([this, p_path, texture]() { load(p_path, texture); });
+    return texture;
+}
+
+void texture_cache::resolve(flecs::world& p_registry) {
+    p_registry.defer_begin();
+    p_registry.query_builder<atlas::material>().build().each([&](flecs::entity p_entity, atlas::material& p_material) {
+        if(!p_material.texture_path.empty()) {
+            p_entity.set<cached_texture>({ get(p_material.texture_path) });
+        }
+    });
+    p_registry.defer_end();
+}
+
+void texture_cache::load(const std::string& p_path, const std::shared_ptr<streamed_texture>& p_texture) const {
+    std::error_code ec;
+    uint64_t source_size = std::filesystem::file_size(p_path, ec);
+    if(ec) {
+        console_log_error("Texture {} does not exist", p_path);
+        p_texture->m_state.store(streamed_texture::state::failed, std::memory_order_release);
+        return;
+    }
+
+    int64_t source_write_time = write_time_of(p_path);
+    std::filesystem::path cached_path = cache_path(p_path);
+
+    auto data = std::make_shared<texture_data>(cached_path);
+    bool up_to_date = data->is_valid() and data->matches_source_stamp(source_size, source_write_time);
+
+    if(!up_to_date) {
+        uint64_t source_hash = 0;
+        {
+            mapped_file source(p_path);
+            source_hash = fnv1a(source.bytes());
+        }
+
+        // the cached mips are still good if only the write time changed, restamping the file is enough
+        bool same_content = data->is_valid() and data->source_hash() == source_hash;
+        data.reset();
+
+        if(same_content) {
+            std::filesystem::last_write_time(cached_path, std::filesystem::last_write_time(p_path, ec), ec);
+        }
+        else {
+            std::filesystem::path staging = cached_path;
+            staging += ".tmp";
+            if(!bake(p_path, staging, source_hash, source_size, source_write_time)) {
+                p_texture->m_state.store(streamed_texture::state::failed, std::memory_order_release);
+                return;
+            }
+            // rename keeps the write time bake() gave the staging file
+            std::filesystem::rename(staging, cached_path, ec);
+        }
+        data = std::make_shared<texture_data>(cached_path);
+    }
+
+    if(!data->is_valid()) {
+        console_log_error("Could not load texture cache {}", cached_path.string());
+        p_texture->m_state.store(streamed_texture::state::failed, std::memory_order_release);
+        return;
+    }
+
+    // only the coarse levels are made resident up front
+    uint32_t resident = 0;
+    while(resident + 1 < data->mip_count() and std::max(data->mip(resident).width, data->mip(resident).height) > initial_resident_size) {
+        resident++;
+    }
+
+    for(uint32_t level = resident; level < data->mip_count(); level++) {
+        data->advise(level, mapped_file::access_hint::will_need);
+    }
+
+    p_texture->m_data = std::move(data);
+    p_texture->m_resident_mip.store(resident, std::memory_order_release);
+    p_texture->m_state.store(streamed_texture::state::ready, std::memory_order_release);
+}
+
+void texture_cache::stream_to(const std::shared_ptr<streamed_texture>& p_texture, uint32_t p_level) {
+    if(p_texture->m_streaming.exchange(true)) {
+        return;
+    }
+
+    m_pool->submit([p_texture, p_level]() {
+        const texture_data& data = *p_texture->m_data;
+        for(uint32_t level = p_texture->resident_mip(); level-- > p_level;) {
+            data.advise(level, mapped_file::access_hint::will_need);
+
+            // touch one byte per page so the level is really resident before it is published
+            texture_mip mip = data.mip(level);
+            volatile std::byte sink{};
+            for(size_t offset = 0; offset < mip.pixels.size(); offset += 4096) {
+                sink = mip.pixels[offset];
+            }
+            (void)sink;
+
+            p_texture->m_resident_mip.store(level, std::memory_order_release);
+        }
+        p_texture->m_streaming.store(false, std::memory_order_release);
+    });
+}
+
+void texture_cache::update_streaming(flecs::world& p_registry, const glm::vec3& p_camera_position, float p_field_of_view, float p_viewport_height) {
+    float projection_scale = p_viewport_height / (2.f * std::tan(glm::radians(p_field_of_view) * 0.5f));
+
+    if(m_query_world != p_registry.c_ptr()) {
+        m_streaming_query = p_registry.query_builder<const atlas::transform, const cached_texture>().build();
+        m_query_world = p_registry.c_ptr();
+    }
+
+    m_streaming_query.each(
+      [&](flecs::entity, const atlas::transform& p_transform, const cached_texture& p_texture) {
+          streamed_texture& texture = *p_texture.texture;
+          if(texture.status() != streamed_texture::state::ready) {
+              return;
+          }
+
+          // projected size of the object in pixels decides how much texel detail is useful
+          float distance = std::max(glm::length(p_transform.position - p_camera_position), 0.01f);
+          glm::vec3 scale = glm::abs(p_transform.scale);
+          float object_size = std::max({ scale.x, scale.y, scale.z }) * 2.f;
+          float screen_pixels = std::max(object_size * projection_scale / distance, 1.f);
+
+          texture_mip full = texture.m_data->mip(0);
+          float texels = static_cast<float>(std::max(full.width, full.height));
+          uint32_t level = static_cast<uint32_t>(std::max(std::floor(std::log2(texels / screen_pixels)), 0.f));
+          level = std::min(level, texture.mip_count() - 1);
+          texture.m_frame_request = std::min(texture.m_frame_request, level);
+      });
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for(auto& [path, texture] : m_textures) {
+        if(texture->status() != streamed_texture::state::ready or texture->m_frame_request == UINT32_MAX) {
+            continue;
+        }
+
+        uint32_t requested = texture->m_frame_request;
+        texture->m_frame_request = UINT32_MAX;
+        uint32_t resident = texture->resident_mip();
+
+        if(requested < resident) {
+            stream_to(texture, requested);
+        }
+        // keep one extra level around before dropping pages to avoid thrashing at the boundary
+        else if(requested > resident + 1 and !texture->m_streaming.load(std::memory_order_acquire)) {
+            uint32_t keep = requested - 1;
+            texture->m_resident_mip.store(keep, std::memory_order_release);
+            for(uint32_t level = resident; level < keep; level++) {
+                texture->m_data->advise(level, mapped_file::access_hint::dont_need);
+            }
+        }
+    }
+}
+
+bool texture_cache::bake(const std::filesystem::path& p_source, const std::filesystem::path& p_cache_path, uint64_t p_source_hash,
+                         uint64_t p_source_size, int64_t p_source_write_time) {
+    auto start = std::chrono::steady_clock::now();
+
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    stbi_uc* pixels = stbi_load(p_source.string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    if(pixels == nullptr) {
+        console_log_error("Could not decode {}: {}", p_source.string(), stbi_failure_reason());
+        return false;
+    }
+
+    texture_data::file_header header;
+    header.magic = texture_file_magic;
+    header.version = texture_file_version;
+    header.source_hash = p_source_hash;
+    header.source_size = p_source_size;
+
+    // level 0 is the decoded image, each following level halves the previous one
+    std::vector<glm::uvec2> sizes = { { static_cast<uint32_t>(width), static_cast<uint32_t>(height) } };
+    while((sizes.back().x > 1 or sizes.back().y > 1) and sizes.size() < texture_data::file_header::max_mips) {
+        sizes.push_back({ std::max(sizes.back().x / 2, 1u), std::max(sizes.back().y / 2, 1u) });
+    }
+    header.mip_count = static_cast<uint32_t>(sizes.size());
+
+    // smallest level first so the coarse mips are contiguous at the start of the file
+    uint64_t offset = sizeof(header);
+    for(size_t i = sizes.size(); i-- > 0;) {
+        uint64_t size = uint64_t(sizes[i].x) * sizes[i].y * bytes_per_pixel;
+        header.mips[i] = { sizes[i].x, sizes[i].y, offset, size };
+        offset += size;
+    }
+
+    std::ofstream file(p_cache_path, std::ios::binary | std::ios::trunc);
+    if(!file) {
+        stbi_image_free(pixels);
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // each level is written at its offset as soon as it exists, so only it and the next one are
+    // in memory at once. For an 8K image that is the 256 MB decode plus 64 MB, instead of a copy
+    // of the decode and the whole chain on top of it
+    std::vector<uint8_t> level;
+    std::vector<uint8_t> next;
+    const uint8_t* current = pixels;
+    for(size_t i = 0; i < sizes.size(); i++) {
+        file.seekp(static_cast<std::streamoff>(header.mips[i].offset));
+        file.write(reinterpret_cast<const char*>(current), static_cast<std::streamsize>(header.mips[i].size));
+        if(i + 1 < sizes.size()) {
+            next = downsample(current, sizes[i].x, sizes[i].y, sizes[i + 1].x, sizes[i + 1].y);
+        }
+        if(i == 0) {
+            stbi_image_free(pixels);
+        }
+        level.swap(next);
+        current = level.data();
+    }
+    file.close();
+
+    // the cache carries the source's write time as its own, see matches_source_stamp()
+    std::error_code ec;
+    std::filesystem::last_write_time(p_cache_path, std::filesystem::file_time_type(std::filesystem::file_time_type::duration(p_source_write_time)), ec);
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    console_log_info("Baked {} ({}x{}, {} mips) in {} ms", p_source.string(), width, height, sizes.size(), elapsed.count());
+    return !file.fail();
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <flecs.h>
+#include <glm/glm.hpp>
+#include <core/scene/components.hpp>
+#include "mapped_file.hpp"
+#include "thread_pool.hpp"
+
+struct texture_mip {
+    uint32_t width;
+    uint32_t height;
+    std::span<const std::byte> pixels;
+};
+
+/**
+ * @name texture_data
+ * @brief Memory-mapped RGBA8 texture with its full mip chain
+ *
+ * Mips are stored smallest first so the low resolution levels sit together at
+ * the front of the file. Level 0 is always the full resolution image.
+ */
+class texture_data {
+public:
+    texture_data() = default;
+    texture_data(const std::filesystem::path& p_cache_path);
+
+    [[nodiscard]] bool is_valid() const { return m_header != nullptr; }
+
+    [[nodiscard]] uint32_t mip_count() const;
+
+    [[nodiscard]] texture_mip mip(uint32_t p_level) const;
+
+    [[nodiscard]] uint64_t source_hash() const;
+
+    [[nodiscard]] bool matches_source_stamp(uint64_t p_size, int64_t p_write_time) const;
+
+    //! @brief Prefetches (or drops) the pages backing a mip level
+    void advise(uint32_t p_level, mapped_file::access_hint p_hint) const;
+
+    struct file_header;
+
+private:
+    mapped_file m_file;
+    const file_header* m_header=nullptr;
+    //! the source's write time, which the cache file takes on when it is written or restamped
+    int64_t m_write_time=0;
+};
+
+/**
+ * @name streamed_texture
+ * @brief Texture handle whose resident mip level changes over time
+ *
+ * A handle is returned immediately and stays in the loading state while the
+ * source is decoded (or the cache is mapped) on a worker thread. Once ready,
+ * only the coarse mips are resident; finer levels are streamed in on the
+ * thread pool when request_mip() asks for them and dropped again when the
+ * object moves away.
+ */
+class streamed_texture {
+public:
+    enum class state : uint8_t { loading, ready, failed };
+
+    [[nodiscard]] state status() const { return m_state.load(std::memory_order_acquire); }
+
+    //! @brief Finest mip level that can currently be read, only meaningful once ready
+    [[nodiscard]] uint32_t resident_mip() const { return m_resident_mip.load(std::memory_order_acquire); }
+
+    //! @brief 0 until the texture is ready
+    [[nodiscard]] uint32_t mip_count() const { return status() == state::ready ? m_data->mip_count() : 0; }
+
+    //! @brief Returns the finest resident level that is not finer than p_level
+    [[nodiscard]] texture_mip resident(uint32_t p_level = 0) const;
+
+private:
+    friend class texture_cache;
+
+    //! set once by the loading worker before m_state is released as ready, only read after acquiring ready
+    std::shared_ptr<const texture_data> m_data;
+    std::atomic<state> m_state{ state::loading };
+    std::atomic<uint32_t> m_resident_mip{ 0 };
+    std::atomic<bool> m_streaming{ false };
+    //! finest level asked for by any entity during the current update
+    uint32_t m_frame_request=UINT32_MAX;
+};
+
+//! flecs component attaching a streamed texture to an entity
+struct cached_texture {
+    std::shared_ptr<streamed_texture> texture;
+};
+
+/**
+ * @name texture_cache
+ * @brief Decodes images on worker threads into cached mip chains
+ *
+ * Follows the same rules as mesh_cache: cache files live next to the mesh
+ * caches, are keyed by source path and only rebuilt when the source content
+ * hash changes. A source that was only touched has the cache file's write
+ * time updated instead.
+ *
+ * Rendering does not read these mips yet, the atlas renderer still decodes
+ * a material's texture_path itself. The cache decodes a texture once, the
+ * first time it is seen, and maps the baked file afterwards.
+ */
+class texture_cache {
+public:
+    //! Levels up to this size are made resident as soon as a texture is loaded
+    static constexpr uint32_t initial_resident_size = 256;
+
+    texture_cache(const std::filesystem::path& p_directory, thread_pool& p_pool);
+
+    //! @brief Returns a handle right away, decoding happens on the thread pool
+    std::shared_ptr<streamed_texture> get(const std::string& p_path);
+
+    //! @brief Attaches a cached_texture to every entity with a material texture_path
+    void resolve(flecs::world& p_registry);
+
+    /**
+     * @brief Picks the mip level each textured entity needs from its projected
+     * size on screen, then streams finer levels in or drops unused ones
+     */
+    void update_streaming(flecs::world& p_registry, const glm::vec3& p_camera_position, float p_field_of_view, float p_viewport_height);
+
+    //! @brief Decodes p_source and writes its mip chain to p_cache_path
+    static bool bake(const std::filesystem::path& p_source, const std::filesystem::path& p_cache_path, uint64_t p_source_hash,
+                     uint64_t p_source_size, int64_t p_source_write_time);
+
+    [[nodiscard]] std::filesystem::path cache_path(const std::string& p_source) const;
+
+private:
+    void load(const std::string& p_path, const std::shared_ptr<streamed_texture>& p_texture) const;
+    void stream_to(const std::shared_ptr<streamed_texture>& p_texture, uint32_t p_level);
+
+private:
+    std::filesystem::path m_directory;
+    thread_pool* m_pool=nullptr;
+    std::mutex m_mutex;
+    std::unordered_map<std::string, std::shared_ptr<streamed_texture>> m_textures;
+    // update_streaming runs every frame, its query is built once per world
+    flecs::query<const atlas::transform, const cached_texture> m_streaming_query;
+    flecs::world_t* m_query_world=nullptr;
+};
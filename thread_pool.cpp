@@ -0,0 +1,75 @@
+#include "thread_pool.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+
+thread_pool::thread_pool(uint32_t p_worker_count) {
+    p_worker_count = std::max(p_worker_count, 1u);
+    m_workers.reserve(p_worker_count);
+    for(uint32_t i = 0; i < p_worker_count; i++) {
+        m_workers.emplace_back([this]() { worker_loop(); });
+    }
+}
+
+thread_pool::~thread_pool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_task_available.notify_all();
+
+    for(std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void thread_pool::enqueue(std::function<void()> p_task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(p_task));
+    }
+    m_task_available.notify_one();
+}
+
+void thread_pool::wait_idle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this]() { return m_tasks.empty() and m_active == 0; });
+}
+
+void thread_pool::worker_loop() {
+    PROFILE_THREAD_NAME("pool worker");
+    while(true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_task_available.wait(lock, [this]() { return m_stopping or !m_tasks.empty(); });
+
+            // remaining tasks are still drained when stopping so futures are never abandoned
+            if(m_tasks.empty()) {
+                return;
+            }
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+            m_active++;
+        }
+
+        {
+            PROFILE_ZONE("thread_pool task");
+            task();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_active--;
+            if(m_tasks.empty() and m_active == 0) {
+                m_idle.notify_all();
+            }
+        }
+    }
+}
+
+thread_pool& shared_thread_pool() {
+    // leave one core for the main thread
+    static thread_pool s_pool(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+    return s_pool;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @name thread_pool
+ * @brief Fixed set of worker threads consuming a FIFO queue of tasks
+ *
+ * Used for background work such as asset imports. Most code should go through
+ * shared_thread_pool() instead of creating its own pool.
+ */
+class thread_pool {
+public:
+    thread_pool(uint32_t p_worker_count);
+    ~thread_pool();
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    template<typename Fn>
+    auto submit(Fn&& p_task) -> std::future<std::invoke_result_t<Fn>> {
+        using result_type = std::invoke_result_t<Fn>;
+        auto task = std::make_shared<std::packaged_task<result_type()>>(std::forward<Fn>(p_task));
+        std::future<result_type> result = task->get_future();
+        enqueue([task]() { (*task)(); });
+        return result;
+    }
+
+    //! @brief Queues p_task without a future, for callers that track completion themselves
+    void post(std::function<void()> p_task) { enqueue(std::move(p_task)); }
+
+    //! @brief Blocks until the queue is empty and every worker is idle
+    void wait_idle();
+
+    [[nodiscard]] uint32_t worker_count() const { return static_cast<uint32_t>(m_workers.size()); }
+
+private:
+    void enqueue(std::function<void()> p_task);
+    void worker_loop();
+
+private:
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_task_available;
+    std::condition_variable m_idle;
+    uint32_t m_active=0;
+    bool m_stopping=false;
+};
+
+//! @brief Worker pool shared by the engine-side systems, created on first use
+thread_pool& shared_thread_pool();
@@ -0,0 +1,233 @@
+#include <game_world.hpp>
+#include <frame_input.hpp>
+#include <input_log.hpp>
+#include <profiler.hpp>
+#include <allocation_counter.hpp>
+#include <binary_scene.hpp>
+#include <scene_document.hpp>
+#include <core/event/event.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * game-template-headless builds game_world and main_scene without a window or
+ * renderer and steps the scene's update and physics callbacks at a fixed dt.
+ * Input is scripted (R is held on the first frame to start the simulation,
+ * the same key the editor uses) so two runs with the same arguments perform
+ * the same work. Prints per-phase timings and can dump the final state of
+ * every serialized entity as YAML to diff runs against each other, and the
+ * profiler zones of the run as a Chrome trace.
+ *
+ * --record saves the run's input and state checksums as an input log.
+ * --replay plays an input log back instead of the script (recorded here or
+ * in the editor), at the recorded frame times, and compares the state
+ * checksums along the way. Replaying the same log on two builds gives
+ * frame-time profiles of identical sessions; the exit code is 2 when the
+ * simulation diverged from the recording.
+ *
+ * usage: game-template-headless [--frames <n>] [--dt <seconds>] [--dump <path>] [--trace <path>] [--no-physics]
+ *                               [--record <path> | --replay <path>]
+ */
+
+namespace {
+    struct phase_timings {
+        const char* name;
+        std::vector<double> samples;
+
+        void print() const {
+            if(samples.empty()) {
+                return;
+            }
+
+            std::vector<double> sorted = samples;
+            std::sort(sorted.begin(), sorted.end());
+            double total = 0.0;
+            for(double sample : sorted) {
+                total += sample;
+            }
+
+            size_t p99 = std::min(sorted.size() - 1, static_cast<size_t>(static_cast<double>(sorted.size()) * 0.99));
+            std::printf("%-10s %8zu %12.4f %12.4f %12.4f %12.4f %12.4f\n", name, sorted.size(), total, total / static_cast<double>(sorted.size()),
+                        sorted.front(), sorted[p99], sorted.back());
+        }
+    };
+
+    template<typename Fn>
+    void time_phase(phase_timings& p_phase, Fn&& p_body) {
+        using clock = std::chrono::steady_clock;
+        auto start = clock::now();
+        p_body();
+        p_phase.samples.push_back(std::chrono::duration<double, std::milli>(clock::now() - start).count());
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t frames = 600;
+    bool frames_given = false;
+    float delta_time = 1.f / 60.f;
+    const char* dump_path = nullptr;
+    const char* trace_path = nullptr;
+    const char* record_path = nullptr;
+    const char* replay_path = nullptr;
+    bool run_physics = true;
+
+    for(int i = 1; i < argc; i++) {
+        if(std::strcmp(argv[i], "--frames") == 0 and i + 1 < argc) {
+            frames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            frames_given = true;
+        }
+        else if(std::strcmp(argv[i], "--dt") == 0 and i + 1 < argc) {
+            delta_time = std::strtof(argv[++i], nullptr);
+        }
+        else if(std::strcmp(argv[i], "--dump") == 0 and i + 1 < argc) {
+            dump_path = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--trace") == 0 and i + 1 < argc) {
+            trace_path = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--no-physics") == 0) {
+            run_physics = false;
+        }
+        else if(std::strcmp(argv[i], "--record") == 0 and i + 1 < argc) {
+            record_path = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--replay") == 0 and i + 1 < argc) {
+            replay_path = argv[++i];
+        }
+        else {
+            std::fprintf(stderr, "usage: %s [--frames <n>] [--dt <seconds>] [--dump <path>] [--trace <path>] [--no-physics] [--record <path> | --replay <path>]\n",
+                         argv[0]);
+            return 1;
+        }
+    }
+
+    if(record_path != nullptr and replay_path != nullptr) {
+        std::fprintf(stderr, "--record and --replay cannot be combined\n");
+        return 1;
+    }
+
+    scripted_input input(delta_time);
+    if(run_physics) {
+        input.press(0, static_cast<int32_t>(key_r));
+    }
+
+    phase_timings start_phase{ "start", {} };
+    phase_timings update_phase{ "update", {} };
+    phase_timings physics_phase{ "physics", {} };
+
+    std::optional<input_replay> replay;
+    std::optional<input_recorder> recorder;
+    frame_input* scene_input = &input;
+    if(replay_path != nullptr) {
+        input_log log;
+        if(!log.load(replay_path)) {
+            return 1;
+        }
+        if(!frames_given) {
+            frames = log.frame_count();
+        }
+        scene_input = &replay.emplace(std::move(log));
+    }
+    else if(record_path != nullptr) {
+        scene_input = &recorder.emplace(input);
+    }
+
+    game_world world("Headless World");
+    main_scene& scene = world.first_scene();
+    scene.use_headless_input(*scene_input);
+    // the culling and batching stats printed below come from the scene's render data
+    scene.enable_render_data();
+    flecs::world registry = scene;
+
+    time_phase(start_phase, [&]() { scene.start_game(); });
+
+    update_phase.samples.reserve(frames);
+    physics_phase.samples.reserve(frames);
+    allocation_counter::frame_meter allocations;
+    uint64_t total_frame_allocations = 0;
+    allocations.frame_mark();
+    for(uint32_t frame = 0; frame < frames; frame++) {
+        input.set_frame(frame);
+        if(replay) {
+            replay->set_frame(frame);
+        }
+        if(recorder) {
+            recorder->begin_frame();
+        }
+
+        time_phase(update_phase, [&]() { scene.on_update(); });
+        time_phase(physics_phase, [&]() { scene.on_physics_update(); });
+        allocations.frame_mark();
+        total_frame_allocations += allocations.last_frame();
+
+        // checksums are outside the timed phases so recording does not skew the profile
+        if(recorder) {
+            recorder->end_frame(registry);
+        }
+        if(replay) {
+            replay->end_frame(registry);
+        }
+    }
+
+    std::printf("%u frames at dt=%.6f\n", frames, static_cast<double>(delta_time));
+    std::printf("%-10s %8s %12s %12s %12s %12s %12s\n", "phase", "calls", "total (ms)", "mean (ms)", "min (ms)", "p99 (ms)", "max (ms)");
+    start_phase.print();
+    update_phase.print();
+    physics_phase.print();
+
+    const visibility_system::frame_stats& visibility = scene.visibility_stats();
+    std::printf("visible last frame: %u of %u renderables, per LOD %u / %u / %u / %u\n", visibility.visible, visibility.renderables,
+                visibility.per_lod[0], visibility.per_lod[1], visibility.per_lod[2], visibility.per_lod[3]);
+    const render_batcher::frame_stats& batches = scene.render_batches().stats();
+    std::printf("instanced draws last frame: %u batches for %u instances\n", batches.batches, batches.instances);
+    if(allocation_counter::enabled() and frames > 0) {
+        std::printf("heap allocations per frame (main thread): mean %.1f, max %llu\n",
+                    static_cast<double>(total_frame_allocations) / static_cast<double>(frames), static_cast<unsigned long long>(allocations.peak()));
+    }
+
+    if(dump_path != nullptr) {
+        scene_document document = capture_scene_document(registry, "LevelScene");
+        if(!write_yaml_scene(dump_path, document)) {
+            std::fprintf(stderr, "could not write %s\n", dump_path);
+            return 1;
+        }
+        std::printf("final state of %zu entities written to %s\n", document.entities.size(), dump_path);
+    }
+
+    if(trace_path != nullptr) {
+#if GAME_TEMPLATE_PROFILER
+        if(!profiler::write_chrome_trace(trace_path, profiler::snapshot())) {
+            std::fprintf(stderr, "could not write %s\n", trace_path);
+            return 1;
+        }
+        std::printf("trace written to %s\n", trace_path);
+#else
+        std::fprintf(stderr, "--trace needs a Debug or RelWithDebInfo build with GAME_TEMPLATE_PROFILER=ON\n");
+#endif
+    }
+
+    if(recorder) {
+        if(!recorder->log().save(record_path)) {
+            std::fprintf(stderr, "could not write %s\n", record_path);
+            return 1;
+        }
+        std::printf("input of %u frames recorded to %s\n", recorder->log().frame_count(), record_path);
+    }
+
+    if(replay) {
+        if(replay->first_divergence()) {
+            std::printf("replay diverged: %u of %u checksums differ, first at frame %u\n", replay->diverged_frames(), replay->checked_frames(),
+                        *replay->first_divergence());
+            return 2;
+        }
+        std::printf("replay matched all %u checksums\n", replay->checked_frames());
+    }
+
+    return 0;
+}
@@ -0,0 +1,39 @@
+#include <mesh_cache.hpp>
+#include <mesh_optimizer.hpp>
+#include <cstdio>
+
+/**
+ * mesh-report imports OBJ models, runs the same optimization a mesh cache
+ * miss runs and prints the level of detail chain of each: triangles, share
+ * of the full mesh, average cache misses per triangle before and after
+ * reordering, and the simplification error relative to the model's size.
+ *
+ * usage: mesh-report <model.obj>...
+ */
+
+int main(int argc, char** argv) {
+    if(argc < 2) {
+        std::fprintf(stderr, "usage: %s <model.obj>...\n", argv[0]);
+        return 1;
+    }
+
+    int result = 0;
+    for(int i = 1; i < argc; i++) {
+        mesh_geometry geometry;
+        if(!mesh_cache::import_obj(argv[i], geometry)) {
+            result = 1;
+            continue;
+        }
+
+        mesh_optimize_report report = optimize_mesh(geometry);
+        std::printf("%s: %u -> %u vertices\n", argv[i], report.vertices_before, report.vertices_after);
+        std::printf("  %-4s %10s %7s %12s %11s %8s\n", "LOD", "triangles", "ratio", "ACMR before", "ACMR after", "error");
+        uint32_t full = report.lods.empty() ? 0 : report.lods.front().triangles;
+        for(size_t level = 0; level < report.lods.size(); level++) {
+            const mesh_lod_report& lod = report.lods[level];
+            double ratio = full == 0 ? 0.0 : static_cast<double>(lod.triangles) / full;
+            std::printf("  %-4zu %10u %7.3f %12.3f %11.3f %8.4f\n", level, lod.triangles, ratio, lod.acmr_before, lod.acmr_after, lod.error);
+        }
+    }
+    return result;
+}
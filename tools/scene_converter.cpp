@@ -0,0 +1,56 @@
+#include <binary_scene.hpp>
+#include <scene_document.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+/**
+ * scene-converter converts scenes between the YAML format written by
+ * atlas::serializer and the binary scene format.
+ *
+ * The direction is picked from the input: binary scenes are detected by their
+ * header magic, anything else is parsed as YAML.
+ *
+ * usage: scene-converter <input> <output>
+ */
+
+static bool is_binary_scene(const char* p_path) {
+    std::ifstream file(p_path, std::ios::binary);
+    uint32_t magic = 0;
+    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    return file and magic == scene_format::magic;
+}
+
+int main(int argc, char** argv) {
+    if(argc != 3) {
+        std::fprintf(stderr, "usage: %s <input> <output>\n", argv[0]);
+        return 1;
+    }
+
+    const char* input = argv[1];
+    const char* output = argv[2];
+
+    if(is_binary_scene(input)) {
+        binary_scene scene(input);
+        if(!scene.is_valid()) {
+            std::fprintf(stderr, "%s: unsupported binary scene version\n", input);
+            return 1;
+        }
+
+        scene_document document = scene.to_document();
+        if(!write_yaml_scene(output, document)) {
+            return 1;
+        }
+
+        std::printf("%s -> %s (binary -> yaml, %zu entities)\n", input, output, document.entities.size());
+        return 0;
+    }
+
+    scene_document document;
+    if(!read_yaml_scene(input, document) or !write_binary_scene(output, document)) {
+        return 1;
+    }
+
+    std::printf("%s -> %s (yaml -> binary, %zu entities)\n", input, output, document.entities.size());
+    return 0;
+}
@@ -0,0 +1,509 @@
+#include "visibility.hpp"
+#include "mesh_cache.hpp"
+#include <core/engine_logger.hpp>
+#include <core/math/utilities.hpp>
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GAME_TEMPLATE_SSE2_CULLING 1
+#endif
+
+namespace {
+    aabb merge(const aabb& p_a, const aabb& p_b) {
+        return { glm::min(p_a.min, p_b.min), glm::max(p_a.max, p_b.max) };
+    }
+
+    bool contains(const aabb& p_outer, const aabb& p_inner) {
+        return p_outer.min.x <= p_inner.min.x and p_outer.min.y <= p_inner.min.y and p_outer.min.z <= p_inner.min.z and
+               p_inner.max.x <= p_outer.max.x and p_inner.max.y <= p_outer.max.y and p_inner.max.z <= p_outer.max.z;
+    }
+
+    float surface_area(const aabb& p_box) {
+        glm::vec3 size = p_box.max - p_box.min;
+        return 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    void set_local_bounds(visibility_proxy& p_proxy, const cached_mesh* p_mesh) {
+        if(p_mesh == nullptr or !p_mesh->mesh or !p_mesh->mesh->is_valid()) {
+            return;
+        }
+        const mesh_bounds& bounds = p_mesh->mesh->bounds();
+        p_proxy.local_center = (bounds.min + bounds.max) * 0.5f;
+        p_proxy.local_extent = (bounds.max - bounds.min) * 0.5f;
+    }
+
+    //! box around the rotated and scaled local box, exact for boxes and tight enough for anything else
+    aabb world_bounds(const atlas::transform& p_transform, const visibility_proxy& p_proxy) {
+        glm::mat3 rotation = glm::mat3_cast(atlas::to_quat(p_transform.quaternion));
+        glm::vec3 center = p_transform.position + rotation * (p_proxy.local_center * p_transform.scale);
+        glm::vec3 extent = p_proxy.local_extent * glm::abs(p_transform.scale);
+        glm::vec3 world_extent = glm::abs(rotation[0]) * extent.x + glm::abs(rotation[1]) * extent.y + glm::abs(rotation[2]) * extent.z;
+        return { center - world_extent, center + world_extent };
+    }
+}
+
+frustum frustum::from_camera(const atlas::transform& p_transform, const atlas::perspective_camera& p_camera, float p_aspect) {
+    glm::mat3 rotation = glm::mat3_cast(atlas::to_quat(p_transform.quaternion));
+    glm::vec3 right = rotation[0];
+    glm::vec3 up = rotation[1];
+    glm::vec3 forward = -rotation[2];
+    const glm::vec3& eye = p_transform.position;
+
+    float half_height = std::tan(glm::radians(p_camera.field_of_view) * 0.5f);
+    float half_width = half_height * p_aspect;
+
+    // side planes pass through the eye, tilted inwards by the half angles
+    const glm::vec3 normals[6] = {
+        forward,
+        -forward,
+        glm::normalize(forward * half_width + right),
+        glm::normalize(forward * half_width - right),
+        glm::normalize(forward * half_height + up),
+        glm::normalize(forward * half_height - up),
+    };
+    const float distances[6] = {
+        -glm::dot(forward, eye + forward * p_camera.plane.x),
+        glm::dot(forward, eye + forward * p_camera.plane.y),
+        -glm::dot(normals[2], eye),
+        -glm::dot(normals[3], eye),
+        -glm::dot(normals[4], eye),
+        -glm::dot(normals[5], eye),
+    };
+
+    frustum planes;
+    for(size_t i = 0; i < 6; i++) {
+        planes.normal_x[i] = normals[i].x;
+        planes.normal_y[i] = normals[i].y;
+        planes.normal_z[i] = normals[i].z;
+        planes.distance[i] = distances[i];
+    }
+    // padding lanes, a zero normal with a huge distance never rejects a box
+    for(size_t i = 6; i < 8; i++) {
+        planes.distance[i] = std::numeric_limits<float>::max();
+    }
+    return planes;
+}
+
+frustum::result frustum::classify(const aabb& p_box) const {
+    glm::vec3 center = (p_box.min + p_box.max) * 0.5f;
+    glm::vec3 extent = (p_box.max - p_box.min) * 0.5f;
+
+#if GAME_TEMPLATE_SSE2_CULLING
+    const __m128 sign_mask = _mm_set1_ps(-0.f);
+    const __m128 center_x = _mm_set1_ps(center.x);
+    const __m128 center_y = _mm_set1_ps(center.y);
+    const __m128 center_z = _mm_set1_ps(center.z);
+    const __m128 extent_x = _mm_set1_ps(extent.x);
+    const __m128 extent_y = _mm_set1_ps(extent.y);
+    const __m128 extent_z = _mm_set1_ps(extent.z);
+
+    int outside = 0;
+    int crossing = 0;
+    for(size_t i = 0; i < 8; i += 4) {
+        __m128 x = _mm_load_ps(&normal_x[i]);
+        __m128 y = _mm_load_ps(&normal_y[i]);
+        __m128 z = _mm_load_ps(&normal_z[i]);
+
+        // signed distance of the center and the box's projected radius, four planes at a time
+        __m128 signed_distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, center_x), _mm_mul_ps(y, center_y)),
+                                            _mm_add_ps(_mm_mul_ps(z, center_z), _mm_load_ps(&distance[i])));
+        __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(sign_mask, x), extent_x), _mm_mul_ps(_mm_andnot_ps(sign_mask, y), extent_y)),
+                                   _mm_mul_ps(_mm_andnot_ps(sign_mask, z), extent_z));
+
+        outside |= _mm_movemask_ps(_mm_cmplt_ps(signed_distance, _mm_sub_ps(_mm_setzero_ps(), radius)));
+        crossing |= _mm_movemask_ps(_mm_cmplt_ps(signed_distance, radius));
+    }
+#else
+    bool outside = false;
+    bool crossing = false;
+    for(size_t i = 0; i < 6; i++) {
+        glm::vec3 normal(normal_x[i], normal_y[i], normal_z[i]);
+        float signed_distance = glm::dot(normal, center) + distance[i];
+        float radius = glm::dot(glm::abs(normal), extent);
+        outside = outside or signed_distance < -radius;
+        crossing = crossing or signed_distance < radius;
+    }
+#endif
+
+    if(outside) {
+        return result::outside;
+    }
+    return crossing ? result::intersecting : result::inside;
+}
+
+bounds_tree::bounds_tree(float p_margin) : m_margin(std::max(p_margin, 0.f)) {}
+
+uint32_t bounds_tree::allocate_node() {
+    if(m_free == null_node) {
+        m_nodes.emplace_back();
+        return static_cast<uint32_t>(m_nodes.size() - 1);
+    }
+
+    uint32_t id = m_free;
+    m_free = m_nodes[id].parent;
+    m_nodes[id] = node{};
+    return id;
+}
+
+void bounds_tree::free_node(uint32_t p_node) {
+    m_nodes[p_node] = node{};
+    m_nodes[p_node].parent = m_free;
+    m_free = p_node;
+}
+
+uint32_t bounds_tree::insert(flecs::entity_t p_entity, const aabb& p_bounds) {
+    uint32_t leaf = allocate_node();
+    node& created = m_nodes[leaf];
+    created.bounds = { p_bounds.min - glm::vec3(m_margin), p_bounds.max + glm::vec3(m_margin) };
+    created.entity = p_entity;
+    created.height = 0;
+
+    insert_leaf(leaf);
+    m_leaf_count++;
+    return leaf;
+}
+
+void bounds_tree::remove(uint32_t p_leaf) {
+    remove_leaf(p_leaf);
+    free_node(p_leaf);
+    m_leaf_count--;
+}
+
+bool bounds_tree::move(uint32_t p_leaf, const aabb& p_bounds) {
+    if(contains(m_nodes[p_leaf].bounds, p_bounds)) {
+        return false;
+    }
+
+    remove_leaf(p_leaf);
+    m_nodes[p_leaf].bounds = { p_bounds.min - glm::vec3(m_margin), p_bounds.max + glm::vec3(m_margin) };
+    insert_leaf(p_leaf);
+    return true;
+}
+
+void bounds_tree::clear() {
+    m_nodes.clear();
+    m_root = null_node;
+    m_free = null_node;
+    m_leaf_count = 0;
+}
+
+float bounds_tree::area() const {
+    float total = 0.f;
+    for(const node& current : m_nodes) {
+        if(current.height > 0) {
+            total += surface_area(current.bounds);
+        }
+    }
+    return total;
+}
+
+void bounds_tree::insert_leaf(uint32_t p_leaf) {
+    if(m_root == null_node) {
+        m_root = p_leaf;
+        m_nodes[p_leaf].parent = null_node;
+        return;
+    }
+
+    // descend towards the sibling whose pairing adds the least surface area,
+    // counting the growth every ancestor on the way inherits
+    aabb leaf_bounds = m_nodes[p_leaf].bounds;
+    uint32_t index = m_root;
+    while(!m_nodes[index].is_leaf()) {
+        const node& current = m_nodes[index];
+        float area = surface_area(current.bounds);
+        float combined = surface_area(merge(current.bounds, leaf_bounds));
+        float cost = 2.f * combined;
+        float inherited = 2.f * (combined - area);
+
+        auto descend_cost = [&](uint32_t p_child) {
+            const node& child = m_nodes[p_child];
+            float grown = surface_area(merge(child.bounds, leaf_bounds));
+            return (child.is_leaf() ? grown : grown - surface_area(child.bounds)) + inherited;
+        };
+        float cost_left = descend_cost(current.left);
+        float cost_right = descend_cost(current.right);
+
+        if(cost < cost_left and cost < cost_right) {
+            break;
+        }
+        index = cost_left < cost_right ? current.left : current.right;
+    }
+
+    uint32_t sibling = index;
+    uint32_t old_parent = m_nodes[sibling].parent;
+    uint32_t new_parent = allocate_node();
+    node& parent = m_nodes[new_parent];
+    parent.parent = old_parent;
+    parent.bounds = merge(leaf_bounds, m_nodes[sibling].bounds);
+    parent.height = m_nodes[sibling].height + 1;
+    parent.left = sibling;
+    parent.right = p_leaf;
+
+    if(old_parent == null_node) {
+        m_root = new_parent;
+    }
+    else if(m_nodes[old_parent].left == sibling) {
+        m_nodes[old_parent].left = new_parent;
+    }
+    else {
+        m_nodes[old_parent].right = new_parent;
+    }
+    m_nodes[sibling].parent = new_parent;
+    m_nodes[p_leaf].parent = new_parent;
+
+    refit_up(old_parent);
+}
+
+void bounds_tree::remove_leaf(uint32_t p_leaf) {
+    if(p_leaf == m_root) {
+        m_root = null_node;
+        return;
+    }
+
+    uint32_t parent = m_nodes[p_leaf].parent;
+    uint32_t grandparent = m_nodes[parent].parent;
+    uint32_t sibling = m_nodes[parent].left == p_leaf ? m_nodes[parent].right : m_nodes[parent].left;
+
+    m_nodes[sibling].parent = grandparent;
+    if(grandparent == null_node) {
+        m_root = sibling;
+    }
+    else if(m_nodes[grandparent].left == parent) {
+        m_nodes[grandparent].left = sibling;
+    }
+    else {
+        m_nodes[grandparent].right = sibling;
+    }
+
+    free_node(parent);
+    m_nodes[p_leaf].parent = null_node;
+    refit_up(grandparent);
+}
+
+void bounds_tree::refit_up(uint32_t p_node) {
+    uint32_t index = p_node;
+    while(index != null_node) {
+        index = balance(index);
+        node& current = m_nodes[index];
+        const node& left = m_nodes[current.left];
+        const node& right = m_nodes[current.right];
+        current.height = 1 + std::max(left.height, right.height);
+        current.bounds = merge(left.bounds, right.bounds);
+        index = current.parent;
+    }
+}
+
+uint32_t bounds_tree::balance(uint32_t p_node) {
+    node& a = m_nodes[p_node];
+    if(a.is_leaf() or a.height < 2) {
+        return p_node;
+    }
+
+    uint32_t b_id = a.left;
+    uint32_t c_id = a.right;
+    node& b = m_nodes[b_id];
+    node& c = m_nodes[c_id];
+    int32_t difference = c.height - b.height;
+
+    // rotates the taller child (up) into p_node's place, p_node takes the
+    // child's shorter grandchild (low) and the taller one (high) stays put
+    auto rotate = [&](uint32_t p_up, node& p_other, bool p_up_was_right) {
+        node& up = m_nodes[p_up];
+        uint32_t f_id = up.left;
+        uint32_t g_id = up.right;
+        node& f = m_nodes[f_id];
+        node& g = m_nodes[g_id];
+
+        up.left = p_node;
+        up.parent = a.parent;
+        a.parent = p_up;
+        if(up.parent == null_node) {
+            m_root = p_up;
+        }
+        else if(m_nodes[up.parent].left == p_node) {
+            m_nodes[up.parent].left = p_up;
+        }
+        else {
+            m_nodes[up.parent].right = p_up;
+        }
+
+        uint32_t high_id = f.height > g.height ? f_id : g_id;
+        uint32_t low_id = high_id == f_id ? g_id : f_id;
+        node& high = m_nodes[high_id];
+        node& low = m_nodes[low_id];
+
+        up.right = high_id;
+        if(p_up_was_right) {
+            a.right = low_id;
+        }
+        else {
+            a.left = low_id;
+        }
+        low.parent = p_node;
+
+        a.bounds = merge(p_other.bounds, low.bounds);
+        a.height = 1 + std::max(p_other.height, low.height);
+        up.bounds = merge(a.bounds, high.bounds);
+        up.height = 1 + std::max(a.height, high.height);
+    };
+
+    if(difference > 1) {
+        rotate(c_id, b, true);
+        return c_id;
+    }
+    if(difference < -1) {
+        rotate(b_id, c, false);
+        return b_id;
+    }
+    return p_node;
+}
+
+visibility_system::visibility_system(float p_margin) : m_tree(p_margin) {}
+
+visibility_system::~visibility_system() {
+    detach();
+}
+
+void visibility_system::attach(flecs::world& p_registry) {
+    detach();
+    m_world = p_registry.c_ptr();
+    m_new_query = p_registry.query_builder<const atlas::transform, const atlas::material>().without<visibility_proxy>().build();
+    m_query = p_registry.query_builder<visibility_proxy, const atlas::transform>().build();
+    m_changed_query = p_registry.query_builder<const visibility_proxy, const atlas::transform>().cached().detect_changes().build();
+    m_stale_query = p_registry.query_builder<const visibility_proxy>().without<atlas::material>().build();
+
+    m_on_remove = p_registry.observer<visibility_proxy>().event(flecs::OnRemove).each([this](flecs::entity, visibility_proxy& p_proxy) {
+        if(p_proxy.leaf != bounds_tree::null_node) {
+            m_tree.remove(p_proxy.leaf);
+            p_proxy.leaf = bounds_tree::null_node;
+        }
+    });
+
+    // hot reload swaps meshes, the next sync moves the leaf if the new box no longer fits
+    m_on_mesh = p_registry.observer<const cached_mesh, visibility_proxy>().event(flecs::OnSet).each(
+      [this](flecs::entity p_entity, const cached_mesh& p_mesh, visibility_proxy& p_proxy) {
+          set_local_bounds(p_proxy, &p_mesh);
+          m_remeshed.push_back(p_entity.id());
+      });
+}
+
+void visibility_system::detach() {
+    if(m_world == nullptr) {
+        return;
+    }
+
+    // entities keep their component, a later attach inserts them again
+    m_query.each([](flecs::entity, visibility_proxy& p_proxy, const atlas::transform&) { p_proxy.leaf = bounds_tree::null_node; });
+    m_on_remove.destruct();
+    m_on_mesh.destruct();
+    m_new_query.destruct();
+    m_query.destruct();
+    m_changed_query.destruct();
+    m_stale_query.destruct();
+    m_world = nullptr;
+    m_remeshed.clear();
+
+    m_tree.clear();
+    m_spheres.clear();
+    m_visible.clear();
+    m_stats = {};
+}
+
+void visibility_system::sync(flecs::world& p_registry) {
+    if(m_world != p_registry.c_ptr()) {
+        console_log_error("visibility_system::sync called on a world it is not attached to");
+        return;
+    }
+
+    // components are only added and removed after a query finished iterating
+    m_pending.clear();
+    m_stale_query.each([this](flecs::entity p_entity, const visibility_proxy&) { m_pending.push_back(p_entity); });
+    for(flecs::entity entity : m_pending) {
+        // the OnRemove observer frees the leaf
+        entity.remove<visibility_proxy>();
+    }
+
+    m_pending.clear();
+    m_new_query.each([this](flecs::entity p_entity, const atlas::transform&, const atlas::material&) { m_pending.push_back(p_entity); });
+    for(flecs::entity entity : m_pending) {
+        visibility_proxy proxy;
+        set_local_bounds(proxy, entity.get<cached_mesh>());
+        proxy.leaf = m_tree.insert(entity.id(), world_bounds(*entity.get<atlas::transform>(), proxy));
+        entity.set<visibility_proxy>(proxy);
+    }
+    m_pending.clear();
+
+    m_stats.refitted = 0;
+    m_stats.reinserted = 0;
+    // static scenery sits in tables nobody writes to, those are skipped without touching a leaf.
+    // New proxies were just set, so their tables count as changed too
+    m_changed_query.run([this](flecs::iter& p_it) {
+        while(p_it.next()) {
+            if(!p_it.changed()) {
+                continue;
+            }
+            auto proxies = p_it.field<const visibility_proxy>(0);
+            auto transforms = p_it.field<const atlas::transform>(1);
+            for(size_t i = 0; i < static_cast<size_t>(p_it.count()); i++) {
+                refit(proxies[i], transforms[i]);
+            }
+        }
+    });
+
+    // a mesh swap changes the local box without writing the transform
+    for(flecs::entity_t id : m_remeshed) {
+        flecs::entity entity = p_registry.entity(id);
+        if(!entity.is_alive()) {
+            continue;
+        }
+        const visibility_proxy* proxy = entity.get<visibility_proxy>();
+        const atlas::transform* transform = entity.get<atlas::transform>();
+        if(proxy != nullptr and transform != nullptr and proxy->leaf != bounds_tree::null_node) {
+            refit(*proxy, *transform);
+        }
+    }
+    m_remeshed.clear();
+    m_stats.renderables = static_cast<uint32_t>(m_tree.size());
+}
+
+void visibility_system::refit(const visibility_proxy& p_proxy, const atlas::transform& p_transform) {
+    aabb bounds = world_bounds(p_transform, p_proxy);
+    m_stats.refitted++;
+    if(m_tree.move(p_proxy.leaf, bounds)) {
+        m_stats.reinserted++;
+    }
+
+    if(p_proxy.leaf >= m_spheres.size()) {
+        m_spheres.resize(p_proxy.leaf + 1);
+    }
+    glm::vec3 center = (bounds.min + bounds.max) * 0.5f;
+    m_spheres[p_proxy.leaf] = { center, glm::length(bounds.max - center) };
+}
+
+std::span<const visible_entity> visibility_system::cull(const atlas::transform& p_camera_transform, const atlas::perspective_camera& p_camera, float p_aspect) {
+    frustum planes = frustum::from_camera(p_camera_transform, p_camera, p_aspect);
+    // a sphere of radius r at distance d covers r / (d * tan(fov / 2)) of the screen height
+    float projection = 1.f / std::tan(glm::radians(p_camera.field_of_view) * 0.5f);
+    float near = std::max(p_camera.plane.x, 0.001f);
+    const glm::vec3& eye = p_camera_transform.position;
+
+    m_visible.clear();
+    m_stats.per_lod = {};
+    m_tree.query(planes, [&](uint32_t p_leaf, bool) {
+        const sphere& bounds = m_spheres[p_leaf];
+        float distance = std::max(glm::length(bounds.center - eye), near);
+        float screen_size = bounds.radius * projection / distance;
+
+        uint32_t lod = 0;
+        while(lod < lod_count - 1 and screen_size < lod_screen_sizes[lod]) {
+            lod++;
+        }
+        m_visible.push_back({ m_tree.entity(p_leaf), lod });
+        m_stats.per_lod[lod]++;
+    });
+
+    m_stats.visible = static_cast<uint32_t>(m_visible.size());
+    return m_visible;
+}
@@ -0,0 +1,284 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+#include <flecs.h>
+#include <glm/glm.hpp>
+#include <core/scene/components.hpp>
+
+//! World-space axis-aligned box
+struct aabb {
+    glm::vec3 min{ 0.f };
+    glm::vec3 max{ 0.f };
+};
+
+/**
+ * @name frustum
+ * @brief The six planes of a perspective camera, laid out for SIMD tests
+ *
+ * Planes face inwards and are stored as structure of arrays in two groups
+ * of four, the last two lanes hold planes that accept everything so a box
+ * is always tested against eight planes in two SSE passes.
+ */
+struct frustum {
+    enum class result : uint8_t { outside, intersecting, inside };
+
+    alignas(16) std::array<float, 8> normal_x{};
+    alignas(16) std::array<float, 8> normal_y{};
+    alignas(16) std::array<float, 8> normal_z{};
+    alignas(16) std::array<float, 8> distance{};
+
+    /**
+     * @brief Planes of p_camera placed at p_transform, looking down its -z axis
+     *
+     * @param p_aspect viewport width over height
+     */
+    static frustum from_camera(const atlas::transform& p_transform, const atlas::perspective_camera& p_camera, float p_aspect);
+
+    [[nodiscard]] result classify(const aabb& p_box) const;
+};
+
+/**
+ * @name bounds_tree
+ * @brief Dynamic AABB tree over entity bounds
+ *
+ * Leaves hold the entity's box grown by a margin, so an object moving less
+ * than the margin costs a containment check and nothing else. Leaves that
+ * leave their fat box are removed and inserted again next to the sibling
+ * that grows the tree's surface area the least, and the path to the root is
+ * rebalanced with AVL-style rotations so the height stays logarithmic
+ * whatever the insertion order.
+ *
+ * Node ids are stable until the node is removed, entities keep their leaf id.
+ */
+class bounds_tree {
+public:
+    static constexpr uint32_t null_node = std::numeric_limits<uint32_t>::max();
+
+    bounds_tree(float p_margin = 0.5f);
+
+    uint32_t insert(flecs::entity_t p_entity, const aabb& p_bounds);
+
+    void remove(uint32_t p_leaf);
+
+    /**
+     * @brief Updates a leaf after its entity moved
+     *
+     * @return true when p_bounds left the fat box and the leaf was reinserted
+     */
+    bool move(uint32_t p_leaf, const aabb& p_bounds);
+
+    void clear();
+
+    //! @brief Calls p_visit(leaf, fully_inside) for every leaf whose box is not outside p_frustum
+    template<typename Fn>
+    void query(const frustum& p_frustum, Fn&& p_visit) const;
+
+    [[nodiscard]] flecs::entity_t entity(uint32_t p_leaf) const { return m_nodes[p_leaf].entity; }
+
+    [[nodiscard]] const aabb& fat_bounds(uint32_t p_node) const { return m_nodes[p_node].bounds; }
+
+    [[nodiscard]] size_t size() const { return m_leaf_count; }
+
+    [[nodiscard]] int32_t height() const { return m_root == null_node ? 0 : m_nodes[m_root].height; }
+
+    //! @brief Total surface area of the inner nodes, lower means cheaper queries
+    [[nodiscard]] float area() const;
+
+private:
+    struct node {
+        aabb bounds;
+        uint32_t parent=null_node;
+        uint32_t left=null_node;
+        uint32_t right=null_node;
+        //! leaves are 0, free nodes -1
+        int32_t height=-1;
+        flecs::entity_t entity=0;
+
+        [[nodiscard]] bool is_leaf() const { return left == null_node; }
+    };
+
+    uint32_t allocate_node();
+
+    void free_node(uint32_t p_node);
+
+    void insert_leaf(uint32_t p_leaf);
+
+    void remove_leaf(uint32_t p_leaf);
+
+    //! @brief Rotates p_node's taller grandchild up if its children differ in height by more than one
+    uint32_t balance(uint32_t p_node);
+
+    //! @brief Refits bounds and heights from p_node to the root, balancing on the way
+    void refit_up(uint32_t p_node);
+
+    template<typename Fn>
+    void visit_leaves(uint32_t p_node, Fn& p_visit) const;
+
+private:
+    float m_margin;
+    std::vector<node> m_nodes;
+    uint32_t m_root=null_node;
+    //! free nodes are chained through node::parent
+    uint32_t m_free=null_node;
+    size_t m_leaf_count=0;
+    mutable std::vector<uint32_t> m_stack;
+};
+
+template<typename Fn>
+void bounds_tree::visit_leaves(uint32_t p_node, Fn& p_visit) const {
+    // a subtree fully inside needs no more plane tests, only its leaves
+    size_t base = m_stack.size();
+    m_stack.push_back(p_node);
+    while(m_stack.size() > base) {
+        const node& current = m_nodes[m_stack.back()];
+        uint32_t id = m_stack.back();
+        m_stack.pop_back();
+        if(current.is_leaf()) {
+            p_visit(id, true);
+            continue;
+        }
+        m_stack.push_back(current.left);
+        m_stack.push_back(current.right);
+    }
+}
+
+template<typename Fn>
+void bounds_tree::query(const frustum& p_frustum, Fn&& p_visit) const {
+    if(m_root == null_node) {
+        return;
+    }
+
+    m_stack.clear();
+    m_stack.push_back(m_root);
+    while(!m_stack.empty()) {
+        uint32_t id = m_stack.back();
+        m_stack.pop_back();
+        const node& current = m_nodes[id];
+
+        frustum::result result = p_frustum.classify(current.bounds);
+        if(result == frustum::result::outside) {
+            continue;
+        }
+        if(current.is_leaf()) {
+            p_visit(id, result == frustum::result::inside);
+        }
+        else if(result == frustum::result::inside) {
+            visit_leaves(id, p_visit);
+        }
+        else {
+            m_stack.push_back(current.left);
+            m_stack.push_back(current.right);
+        }
+    }
+}
+
+//! Links an entity to its leaf in the visibility_system attached to its world, managed by the system
+struct visibility_proxy {
+    uint32_t leaf=bounds_tree::null_node;
+    //! model-space box of the entity's mesh, a unit cube until a cached_mesh is set
+    glm::vec3 local_center{ 0.f };
+    glm::vec3 local_extent{ 1.f };
+};
+
+//! An entity that passed the frustum test this frame, with the level of detail to draw it at
+struct visible_entity {
+    flecs::entity_t entity;
+    uint32_t lod;
+};
+
+/**
+ * @name visibility_system
+ * @brief Frustum culling and LOD selection for every entity with an atlas::material
+ *
+ * attach() to a world, then once per frame sync() after transforms changed
+ * and cull() with the active camera. sync() adds a visibility_proxy to new
+ * renderables and moves the ones whose world box left their fat box in the
+ * tree. Only tables whose transforms were written since the last sync() are
+ * refit, through flecs change detection: queries that write atlas::transform
+ * mark their tables on their own, code writing through get_mut has to call
+ * modified<atlas::transform>(). cull() walks the tree with SIMD plane tests and picks each visible
+ * entity's LOD from the share of the screen height its bounding sphere
+ * covers: LOD 0 from lod_screen_sizes[0] up, LOD 1 from lod_screen_sizes[1]
+ * up and so on, everything smaller is the last LOD.
+ *
+ * World boxes come from the cached_mesh bounds, rotated and scaled by the
+ * transform, entities without a mesh count as a unit cube.
+ *
+ * The observers capture this, so the object must not move while attached.
+ */
+class visibility_system {
+public:
+    static constexpr uint32_t lod_count = 4;
+
+    struct frame_stats {
+        uint32_t renderables=0;
+        uint32_t visible=0;
+        //! leaves whose world box was recomputed during the last sync
+        uint32_t refitted=0;
+        //! leaves that moved out of their fat box during the last sync
+        uint32_t reinserted=0;
+        std::array<uint32_t, lod_count> per_lod{};
+    };
+
+    visibility_system(float p_margin = 0.5f);
+
+    ~visibility_system();
+
+    visibility_system(const visibility_system&) = delete;
+    visibility_system& operator=(const visibility_system&) = delete;
+
+    //! @brief Starts tracking renderables of p_registry, detaching from any previous world
+    void attach(flecs::world& p_registry);
+
+    //! @brief Forgets every entity and removes the observers, call while the world is still alive
+    void detach();
+
+    void sync(flecs::world& p_registry);
+
+    /**
+     * @param p_aspect viewport width over height
+     * @return the entities inside the camera's frustum, valid until the next cull()
+     */
+    std::span<const visible_entity> cull(const atlas::transform& p_camera_transform, const atlas::perspective_camera& p_camera, float p_aspect);
+
+    [[nodiscard]] std::span<const visible_entity> visible() const { return m_visible; }
+
+    [[nodiscard]] const frame_stats& stats() const { return m_stats; }
+
+    [[nodiscard]] const bounds_tree& tree() const { return m_tree; }
+
+    //! screen height fractions where LOD 0, 1 and 2 end
+    std::array<float, lod_count - 1> lod_screen_sizes{ 0.25f, 0.1f, 0.03f };
+
+private:
+    struct sphere {
+        glm::vec3 center;
+        float radius;
+    };
+
+    //! @brief Recomputes the leaf's world box and bounding sphere from p_transform
+    void refit(const visibility_proxy& p_proxy, const atlas::transform& p_transform);
+
+private:
+    bounds_tree m_tree;
+    //! bounding sphere of the tight box per tree node, only leaves are filled in
+    std::vector<sphere> m_spheres;
+    std::vector<visible_entity> m_visible;
+    frame_stats m_stats;
+    // entities picked up by sync, they get their proxy once the query finished iterating
+    std::vector<flecs::entity> m_pending;
+    //! entities whose mesh, and so local box, changed since the last sync
+    std::vector<flecs::entity_t> m_remeshed;
+
+    flecs::world_t* m_world=nullptr;
+    flecs::query<const atlas::transform, const atlas::material> m_new_query;
+    flecs::query<visibility_proxy, const atlas::transform> m_query;
+    //! read only, so iterating it never marks the tables it watches as changed
+    flecs::query<const visibility_proxy, const atlas::transform> m_changed_query;
+    flecs::query<const visibility_proxy> m_stale_query;
+    flecs::observer m_on_remove;
+    flecs::observer m_on_mesh;
+};